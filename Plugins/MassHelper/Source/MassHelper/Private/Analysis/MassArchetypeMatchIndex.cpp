@@ -0,0 +1,182 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+#include "MassHelper/Public/Analysis/MassArchetypeMatchIndex.h"
+#include "MassHelper/Public/Analysis/MassArchetypeMemoryReport.h"
+#include "MassHelper/Private/Analysis/MassPrivateMemberAccess.h"
+
+#include "MassEntity/Public/MassArchetypeData.h"
+#include "MassEntity/Public/MassEntityQuery.h"
+#include "MassEntity/Public/MassProcessor.h"
+
+namespace UE::MassHelper::Private
+{
+	struct FOwnedQueriesTag
+	{
+		using Type = TArray<FMassEntityQuery*> UMassProcessor::*;
+		friend Type GetPrivateMember(FOwnedQueriesTag);
+	};
+	template struct TMassPrivateMemberAccessor<FOwnedQueriesTag, &UMassProcessor::OwnedQueries>;
+
+	template<typename TBitSet>
+	TArray<const UStruct*> ExportMatchTypes(const TBitSet& BitSet)
+	{
+		TArray<const UStruct*> Types;
+		BitSet.ExportTypes(Types);
+		return Types;
+	}
+}
+
+void FMassArchetypeMatchIndex::Build(FMassEntityManager& EntityManager)
+{
+	using namespace UE::MassHelper::Private;
+
+	Archetypes.Reset();
+	TypeIndices.Reset();
+	TypeBits.Reset();
+
+	// creating an archetype for a composition that already has one returns the existing archetype's handle
+	TArray<TSharedPtr<FMassArchetypeData>> ArchetypeDatas;
+	FMassArchetypeMemoryReport::GetArchetypes(EntityManager, ArchetypeDatas);
+	Archetypes.Reserve(ArchetypeDatas.Num());
+	for (const TSharedPtr<FMassArchetypeData>& ArchetypeData : ArchetypeDatas)
+	{
+		const FMassArchetypeHandle Handle = EntityManager.CreateArchetype(ArchetypeData->GetCompositionDescriptor());
+		if (ensure(FMassArchetypeHelper::ArchetypeDataFromHandle(Handle) == ArchetypeData.Get()))
+		{
+			Archetypes.Add(Handle);
+		}
+	}
+
+	WordCount = (Archetypes.Num() + 63) / 64;
+	for (int32 ArchetypeIndex = 0; ArchetypeIndex < Archetypes.Num(); ++ArchetypeIndex)
+	{
+		const FMassArchetypeCompositionDescriptor& Composition = FMassArchetypeHelper::ArchetypeDataFromHandleChecked(Archetypes[ArchetypeIndex]).GetCompositionDescriptor();
+		AddTypeBits(ETypeKind::Fragment, ExportMatchTypes(Composition.Fragments), ArchetypeIndex);
+		AddTypeBits(ETypeKind::Tag, ExportMatchTypes(Composition.Tags), ArchetypeIndex);
+		AddTypeBits(ETypeKind::ChunkFragment, ExportMatchTypes(Composition.ChunkFragments), ArchetypeIndex);
+		AddTypeBits(ETypeKind::SharedFragment, ExportMatchTypes(Composition.SharedFragments), ArchetypeIndex);
+	}
+}
+
+void FMassArchetypeMatchIndex::AddTypeBits(const ETypeKind Kind, TConstArrayView<const UStruct*> Types, const int32 ArchetypeIndex)
+{
+	for (const UStruct* Type : Types)
+	{
+		const int32* ExistingIndex = TypeIndices.Find(MakeTuple(Kind, Type));
+		const int32 TypeIndex = ExistingIndex ? *ExistingIndex : TypeIndices.Add(MakeTuple(Kind, Type), TypeBits.Num());
+		if (ExistingIndex == nullptr)
+		{
+			TypeBits.AddDefaulted_GetRef().SetNumZeroed(WordCount);
+		}
+		TypeBits[TypeIndex][ArchetypeIndex / 64] |= uint64(1) << (ArchetypeIndex % 64);
+	}
+}
+
+bool FMassArchetypeMatchIndex::FilterCandidates(const ETypeKind Kind, TConstArrayView<const UStruct*> Types, const bool bRequired, FWords& InOutCandidates) const
+{
+	for (const UStruct* Type : Types)
+	{
+		const int32* TypeIndex = TypeIndices.Find(MakeTuple(Kind, Type));
+		if (TypeIndex == nullptr)
+		{
+			if (bRequired)
+			{
+				// no archetype has the type at all
+				return false;
+			}
+			continue;
+		}
+
+		// plain word loops, the compiler turns these into SIMD and/andnot
+		const uint64* TypeWords = TypeBits[*TypeIndex].GetData();
+		uint64* CandidateWords = InOutCandidates.GetData();
+		uint64 AnyLeft = 0;
+		if (bRequired)
+		{
+			for (int32 WordIndex = 0; WordIndex < WordCount; ++WordIndex)
+			{
+				CandidateWords[WordIndex] &= TypeWords[WordIndex];
+				AnyLeft |= CandidateWords[WordIndex];
+			}
+		}
+		else
+		{
+			for (int32 WordIndex = 0; WordIndex < WordCount; ++WordIndex)
+			{
+				CandidateWords[WordIndex] &= ~TypeWords[WordIndex];
+				AnyLeft |= CandidateWords[WordIndex];
+			}
+		}
+		if (AnyLeft == 0)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void FMassArchetypeMatchIndex::GetArchetypesMatchingRequirements(const FMassFragmentRequirements& Requirements, TArray<FMassArchetypeHandle>& OutArchetypes) const
+{
+	FWords Matched;
+	Matched.SetNumZeroed(WordCount);
+	AddMatchingArchetypes(Requirements, Matched, OutArchetypes);
+}
+
+void FMassArchetypeMatchIndex::AddMatchingArchetypes(const FMassFragmentRequirements& Requirements, FWords& InOutMatched, TArray<FMassArchetypeHandle>& OutArchetypes) const
+{
+	using namespace UE::MassHelper::Private;
+
+	// FMassEntityQuery::CacheArchetypes matches nothing for these either
+	if (Archetypes.Num() == 0 || Requirements.CheckValidity() == false)
+	{
+		return;
+	}
+
+	FWords Candidates;
+	Candidates.Init(~uint64(0), WordCount);
+	if (Archetypes.Num() % 64)
+	{
+		Candidates.Last() = (uint64(1) << (Archetypes.Num() % 64)) - 1;
+	}
+
+	// only the all/none requirements narrow the candidates, any and optional ones are left to the exact test
+	const bool bAnyCandidates = FilterCandidates(ETypeKind::Fragment, ExportMatchTypes(Requirements.GetRequiredAllFragments()), true, Candidates)
+		&& FilterCandidates(ETypeKind::Tag, ExportMatchTypes(Requirements.GetRequiredAllTags()), true, Candidates)
+		&& FilterCandidates(ETypeKind::ChunkFragment, ExportMatchTypes(Requirements.GetRequiredAllChunkFragments()), true, Candidates)
+		&& FilterCandidates(ETypeKind::SharedFragment, ExportMatchTypes(Requirements.GetRequiredAllSharedFragments()), true, Candidates)
+		&& FilterCandidates(ETypeKind::Fragment, ExportMatchTypes(Requirements.GetRequiredNoneFragments()), false, Candidates)
+		&& FilterCandidates(ETypeKind::Tag, ExportMatchTypes(Requirements.GetRequiredNoneTags()), false, Candidates);
+	if (bAnyCandidates == false)
+	{
+		return;
+	}
+
+	for (int32 WordIndex = 0; WordIndex < WordCount; ++WordIndex)
+	{
+		for (uint64 Word = Candidates[WordIndex] & ~InOutMatched[WordIndex]; Word != 0; Word &= Word - 1)
+		{
+			const int32 Bit = int32(FMath::CountTrailingZeros64(Word));
+			const FMassArchetypeHandle& Handle = Archetypes[WordIndex * 64 + Bit];
+			if (Requirements.DoesArchetypeMatchRequirements(FMassArchetypeHelper::ArchetypeDataFromHandleChecked(Handle).GetCompositionDescriptor()))
+			{
+				OutArchetypes.Add(Handle);
+				InOutMatched[WordIndex] |= uint64(1) << Bit;
+			}
+		}
+	}
+}
+
+void FMassArchetypeMatchIndex::GetArchetypesMatchingOwnedQueries(const UMassProcessor& Processor, TArray<FMassArchetypeHandle>& OutArchetypes) const
+{
+	using namespace UE::MassHelper::Private;
+
+	// queries of one processor often overlap, like the engine each archetype is reported once
+	FWords Matched;
+	Matched.SetNumZeroed(WordCount);
+	for (const FMassEntityQuery* Query : Processor.*GetPrivateMember(FOwnedQueriesTag()))
+	{
+		if (Query)
+		{
+			AddMatchingArchetypes(*Query, Matched, OutArchetypes);
+		}
+	}
+}
@@ -0,0 +1,234 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+#include "MassHelper/Public/Analysis/MassArchetypeMemoryReport.h"
+#include "MassHelper/Public/Processor/MassDependencyJsonWriter.h"
+#include "MassHelper/Private/Analysis/MassPrivateMemberAccess.h"
+
+#include "MassEntity/Public/MassEntityManager.h"
+#include "MassEntity/Public/MassArchetypeData.h"
+
+namespace UE::MassHelper::Private
+{
+	struct FArchetypeMapTag
+	{
+		using Type = TMap<uint32, TArray<TSharedPtr<FMassArchetypeData>>> FMassEntityManager::*;
+		friend Type GetPrivateMember(FArchetypeMapTag);
+	};
+	template struct TMassPrivateMemberAccessor<FArchetypeMapTag, &FMassEntityManager::FragmentHashToArchetypeMap>;
+
+	struct FArchetypeChunksTag
+	{
+		using Type = TArray<FMassArchetypeChunk> FMassArchetypeData::*;
+		friend Type GetPrivateMember(FArchetypeChunksTag);
+	};
+	template struct TMassPrivateMemberAccessor<FArchetypeChunksTag, &FMassArchetypeData::Chunks>;
+
+	template<typename TBitSet>
+	void ExportTypeFNames(const TBitSet& BitSet, TArray<FName>& OutNames)
+	{
+		TArray<const UStruct*> Types;
+		BitSet.ExportTypes(Types);
+		for (const UStruct* Type : Types)
+		{
+			OutNames.Add(Type ? Type->GetFName() : NAME_None);
+		}
+	}
+
+	template<typename TSharedStruct>
+	void CountSharedValues(TConstArrayView<TSharedStruct> Values, const bool bConst, TMap<FName, TSet<const void*>>& InOutDistinctValues
+		, TArray<FMassArchetypeMemoryReport::FSharedFragmentInfo>& InOutSharedFragments)
+	{
+		for (const TSharedStruct& Value : Values)
+		{
+			const FName Type = Value.GetScriptStruct() ? Value.GetScriptStruct()->GetFName() : NAME_None;
+			if (InOutDistinctValues.Contains(Type) == false)
+			{
+				FMassArchetypeMemoryReport::FSharedFragmentInfo& Info = InOutSharedFragments.AddDefaulted_GetRef();
+				Info.Type = Type;
+				Info.bConst = bConst;
+			}
+			InOutDistinctValues.FindOrAdd(Type).Add(Value.GetMemory());
+		}
+	}
+}
+
+void FMassArchetypeMemoryReport::Gather(const FMassEntityManager& EntityManager)
+{
+	Archetypes.Reset();
+
+	TArray<TSharedPtr<FMassArchetypeData>> ArchetypeDatas;
+	GetArchetypes(EntityManager, ArchetypeDatas);
+	for (const TSharedPtr<FMassArchetypeData>& ArchetypeData : ArchetypeDatas)
+	{
+		GatherArchetype(*ArchetypeData, Archetypes.AddDefaulted_GetRef());
+	}
+
+	Archetypes.Sort([](const FArchetypeInfo& A, const FArchetypeInfo& B) { return A.GetWastedBytes() > B.GetWastedBytes(); });
+}
+
+void FMassArchetypeMemoryReport::GetArchetypes(const FMassEntityManager& EntityManager, TArray<TSharedPtr<FMassArchetypeData>>& OutArchetypes)
+{
+	using namespace UE::MassHelper::Private;
+
+	const auto& ArchetypeMap = EntityManager.*GetPrivateMember(FArchetypeMapTag());
+	for (const TPair<uint32, TArray<TSharedPtr<FMassArchetypeData>>>& HashArchetypes : ArchetypeMap)
+	{
+		for (const TSharedPtr<FMassArchetypeData>& ArchetypeData : HashArchetypes.Value)
+		{
+			if (ArchetypeData.IsValid())
+			{
+				OutArchetypes.Add(ArchetypeData);
+			}
+		}
+	}
+}
+
+void FMassArchetypeMemoryReport::GatherArchetype(const FMassArchetypeData& ArchetypeData, FArchetypeInfo& OutInfo)
+{
+	using namespace UE::MassHelper::Private;
+
+	OutInfo = FArchetypeInfo();
+	const FMassArchetypeCompositionDescriptor& Composition = ArchetypeData.GetCompositionDescriptor();
+	OutInfo.CompositionHash = Composition.CalculateHash();
+	OutInfo.EntityCount = ArchetypeData.GetNumEntities();
+	OutInfo.ChunkCount = ArchetypeData.GetChunkCount();
+	OutInfo.EntitiesPerChunk = ArchetypeData.GetNumEntitiesPerChunk();
+	OutInfo.ChunkAllocSize = ArchetypeData.GetChunkAllocSize();
+
+	// every entity also stores its handle in the chunk
+	OutInfo.BytesPerEntity = sizeof(FMassEntityHandle);
+	TArray<const UStruct*> FragmentTypes;
+	Composition.Fragments.ExportTypes(FragmentTypes);
+	for (const UStruct* FragmentType : FragmentTypes)
+	{
+		FFragmentInfo& FragmentInfo = OutInfo.Fragments.AddDefaulted_GetRef();
+		FragmentInfo.Type = FragmentType ? FragmentType->GetFName() : NAME_None;
+		FragmentInfo.BytesPerEntity = FragmentType ? FragmentType->GetStructureSize() : 0;
+		OutInfo.BytesPerEntity += FragmentInfo.BytesPerEntity;
+	}
+	OutInfo.Fragments.Sort([](const FFragmentInfo& A, const FFragmentInfo& B) { return A.BytesPerEntity > B.BytesPerEntity; });
+	ExportTypeFNames(Composition.Tags, OutInfo.Tags);
+	ExportTypeFNames(Composition.ChunkFragments, OutInfo.ChunkFragments);
+
+	const int64 TailBytesPerChunk = FMath::Max(0, OutInfo.ChunkAllocSize - OutInfo.EntitiesPerChunk * OutInfo.BytesPerEntity);
+	TMap<FName, TSet<const void*>> DistinctSharedValues;
+	for (const FMassArchetypeChunk& Chunk : ArchetypeData.*GetPrivateMember(FArchetypeChunksTag()))
+	{
+		const int32 NumInstances = Chunk.GetNumInstances();
+		OutInfo.UnusedSlotBytes += int64(OutInfo.EntitiesPerChunk - NumInstances) * OutInfo.BytesPerEntity;
+		OutInfo.ChunkTailBytes += TailBytesPerChunk;
+		const int32 Bucket = OutInfo.EntitiesPerChunk > 0 ? FMath::Clamp(NumInstances * 10 / OutInfo.EntitiesPerChunk, 0, 10) : 0;
+		++OutInfo.FillHistogram[Bucket];
+
+		if (NumInstances > 0)
+		{
+			++OutInfo.NonEmptyChunkCount;
+			const FMassArchetypeSharedFragmentValues& SharedValues = Chunk.GetSharedFragmentValues();
+			CountSharedValues<FConstSharedStruct>(SharedValues.GetConstSharedFragments(), /*bConst=*/true, DistinctSharedValues, OutInfo.SharedFragments);
+			CountSharedValues<FSharedStruct>(SharedValues.GetSharedFragments(), /*bConst=*/false, DistinctSharedValues, OutInfo.SharedFragments);
+		}
+	}
+	for (FSharedFragmentInfo& SharedInfo : OutInfo.SharedFragments)
+	{
+		SharedInfo.Cardinality = DistinctSharedValues.FindChecked(SharedInfo.Type).Num();
+	}
+}
+
+void FMassArchetypeMemoryReport::Write(FArchive& OutArchive) const
+{
+	FMassDependencyJsonWriter Writer(OutArchive);
+	Writer.BeginObject();
+	Writer.WriteStringField(TEXT("PrintMode"), TEXT("ArchetypeMemory"));
+
+	int64 TotalEntities = 0;
+	int64 TotalChunks = 0;
+	int64 TotalAllocatedBytes = 0;
+	int64 TotalWastedBytes = 0;
+	for (const FArchetypeInfo& Info : Archetypes)
+	{
+		TotalEntities += Info.EntityCount;
+		TotalChunks += Info.ChunkCount;
+		TotalAllocatedBytes += Info.GetAllocatedBytes();
+		TotalWastedBytes += Info.GetWastedBytes();
+	}
+
+	Writer.WriteKey(TEXT("Totals"));
+	Writer.BeginObject();
+	Writer.WriteNumberField(TEXT("ArchetypeCount"), Archetypes.Num());
+	Writer.WriteNumberField(TEXT("EntityCount"), double(TotalEntities));
+	Writer.WriteNumberField(TEXT("ChunkCount"), double(TotalChunks));
+	Writer.WriteNumberField(TEXT("AllocatedBytes"), double(TotalAllocatedBytes));
+	Writer.WriteNumberField(TEXT("WastedBytes"), double(TotalWastedBytes));
+	Writer.WriteNumberField(TEXT("WastedRatio"), TotalAllocatedBytes ? double(TotalWastedBytes) / double(TotalAllocatedBytes) : 0.);
+	Writer.EndObject();
+
+	Writer.WriteKey(TEXT("Archetypes"));
+	Writer.BeginArray();
+	for (const FArchetypeInfo& Info : Archetypes)
+	{
+		Writer.BeginObject();
+		Writer.WriteStringField(TEXT("CompositionHash"), FString::Printf(TEXT("%08x"), Info.CompositionHash));
+		Writer.WriteNumberField(TEXT("EntityCount"), Info.EntityCount);
+		Writer.WriteNumberField(TEXT("ChunkCount"), Info.ChunkCount);
+		Writer.WriteNumberField(TEXT("NonEmptyChunkCount"), Info.NonEmptyChunkCount);
+		Writer.WriteNumberField(TEXT("EntitiesPerChunk"), Info.EntitiesPerChunk);
+		Writer.WriteNumberField(TEXT("ChunkAllocSize"), Info.ChunkAllocSize);
+		Writer.WriteNumberField(TEXT("FillRatio"), Info.GetFillRatio());
+		Writer.WriteNumberField(TEXT("BytesPerEntity"), Info.BytesPerEntity);
+		Writer.WriteNumberField(TEXT("AllocatedBytes"), double(Info.GetAllocatedBytes()));
+		Writer.WriteNumberField(TEXT("UnusedSlotBytes"), double(Info.UnusedSlotBytes));
+		Writer.WriteNumberField(TEXT("ChunkTailBytes"), double(Info.ChunkTailBytes));
+		Writer.WriteNumberField(TEXT("WastedBytes"), double(Info.GetWastedBytes()));
+
+		Writer.WriteKey(TEXT("FillHistogram"));
+		Writer.BeginArray();
+		for (const int32 BucketCount : Info.FillHistogram)
+		{
+			Writer.WriteNumber(BucketCount);
+		}
+		Writer.EndArray();
+
+		Writer.WriteKey(TEXT("Fragments"));
+		Writer.BeginArray();
+		for (const FFragmentInfo& FragmentInfo : Info.Fragments)
+		{
+			Writer.BeginObject();
+			Writer.WriteNameField(TEXT("Type"), FragmentInfo.Type);
+			Writer.WriteNumberField(TEXT("BytesPerEntity"), FragmentInfo.BytesPerEntity);
+			Writer.EndObject();
+		}
+		Writer.EndArray();
+
+		Writer.WriteKey(TEXT("SharedFragments"));
+		Writer.BeginArray();
+		for (const FSharedFragmentInfo& SharedInfo : Info.SharedFragments)
+		{
+			Writer.BeginObject();
+			Writer.WriteNameField(TEXT("Type"), SharedInfo.Type);
+			Writer.WriteBoolField(TEXT("Const"), SharedInfo.bConst);
+			Writer.WriteNumberField(TEXT("Cardinality"), SharedInfo.Cardinality);
+			Writer.EndObject();
+		}
+		Writer.EndArray();
+
+		Writer.WriteKey(TEXT("ChunkFragments"));
+		Writer.BeginArray();
+		for (const FName ChunkFragment : Info.ChunkFragments)
+		{
+			Writer.WriteName(ChunkFragment);
+		}
+		Writer.EndArray();
+
+		Writer.WriteKey(TEXT("Tags"));
+		Writer.BeginArray();
+		for (const FName Tag : Info.Tags)
+		{
+			Writer.WriteName(Tag);
+		}
+		Writer.EndArray();
+
+		Writer.EndObject();
+	}
+	Writer.EndArray();
+
+	Writer.EndObject();
+}
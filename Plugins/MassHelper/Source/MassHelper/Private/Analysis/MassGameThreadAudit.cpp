@@ -0,0 +1,207 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+#include "MassHelper/Public/Analysis/MassGameThreadAudit.h"
+#include "MassHelper/Public/Analysis/MassProcessorGraph.h"
+#include "MassHelper/Public/Analysis/MassProcessorScheduleSimulation.h"
+#include "MassHelper/Public/Processor/MassDependencyJsonWriter.h"
+
+namespace UE::MassHelper::Private
+{
+	/** Processors depending on NodeIndex directly or through groups only. */
+	void GetDependentProcessors(const FMassProcessorGraph& Graph, const int32 NodeIndex, TSet<int32>& OutDependents)
+	{
+		TArray<int32, TInlineAllocator<16>> Stack(Graph.Nodes[NodeIndex].Dependents);
+		TSet<int32> VisitedGroups;
+		while (Stack.Num())
+		{
+			const int32 DependentIndex = Stack.Pop(false);
+			if (Graph.Nodes[DependentIndex].IsProcessor())
+			{
+				OutDependents.Add(DependentIndex);
+			}
+			else if (VisitedGroups.Contains(DependentIndex) == false)
+			{
+				VisitedGroups.Add(DependentIndex);
+				Stack.Append(Graph.Nodes[DependentIndex].Dependents);
+			}
+		}
+	}
+
+	/** Time of [BeginMs, EndMs) not covered by the lane's entries. */
+	double GetLaneIdleMs(const FMassProcessorScheduleSimulation::FLane& Lane, const double BeginMs, const double EndMs)
+	{
+		double BusyMs = 0.;
+		for (const FMassProcessorScheduleSimulation::FLaneEntry& Entry : Lane.Entries)
+		{
+			BusyMs += FMath::Max(0., FMath::Min(EndMs, Entry.EndMs) - FMath::Max(BeginMs, Entry.StartMs));
+		}
+		return FMath::Max(0., (EndMs - BeginMs) - BusyMs);
+	}
+}
+
+void FMassGameThreadAudit::Analyze(const FMassProcessorGraph& Graph, TConstArrayView<FMassProcessorOrderInfo> SortedProcessors, const int32 InCoreCount)
+{
+	using namespace UE::MassHelper::Private;
+	using FSimulation = FMassProcessorScheduleSimulation;
+
+	// without a worker lane nothing could move off the game thread
+	CoreCount = FMath::Max(2, InCoreCount);
+	Processors.Reset();
+	TotalWorkMs = Graph.GetTotalWorkMs();
+	GameThreadWorkMs = Graph.GetGameThreadWorkMs();
+
+	FSimulation::FResult Simulation;
+	FSimulation::Simulate(Graph, CoreCount, Simulation);
+	SimulatedWallTimeMs = Simulation.WallTimeMs;
+	bHasCycle = Simulation.bHasCycle;
+
+	FMassCriticalPathAnalysis CriticalPath;
+	CriticalPath.Analyze(Graph);
+	CriticalPathGameThreadMs = 0.;
+	for (const int32 NodeIndex : CriticalPath.CriticalPath)
+	{
+		CriticalPathGameThreadMs += Graph.Nodes[NodeIndex].bRequiresGameThread ? Graph.Nodes[NodeIndex].CostMs : 0.;
+	}
+
+	TMap<FName, int32> SolvedOrder;
+	for (int32 OrderIndex = 0; OrderIndex < SortedProcessors.Num(); ++OrderIndex)
+	{
+		SolvedOrder.Add(SortedProcessors[OrderIndex].Name, OrderIndex);
+	}
+
+	// groups finish the moment they are ready, so a node is ready when its last dependency ended
+	auto GetEndMs = [&Graph, &Simulation](const int32 NodeIndex) { return Simulation.NodeStartMs[NodeIndex] + Graph.Nodes[NodeIndex].CostMs; };
+	auto GetReadyMs = [&Graph, &GetEndMs](const int32 NodeIndex)
+	{
+		double ReadyMs = 0.;
+		for (const int32 DependencyIndex : Graph.Nodes[NodeIndex].Dependencies)
+		{
+			ReadyMs = FMath::Max(ReadyMs, GetEndMs(DependencyIndex));
+		}
+		return ReadyMs;
+	};
+
+	FMassProcessorGraph MutableGraph = Graph;
+	for (int32 NodeIndex = 0; NodeIndex < Graph.Nodes.Num(); ++NodeIndex)
+	{
+		const FMassProcessorGraph::FNode& Node = Graph.Nodes[NodeIndex];
+		if (Node.IsProcessor() == false || Node.bRequiresGameThread == false || Simulation.NodeLanes[NodeIndex] == INDEX_NONE)
+		{
+			continue;
+		}
+
+		FProcessorInfo& Info = Processors.AddDefaulted_GetRef();
+		Info.NodeIndex = NodeIndex;
+		Info.SolvedOrderIndex = SolvedOrder.FindRef(Node.Name, INDEX_NONE);
+		Info.CostMs = Node.CostMs;
+		Info.ReadyMs = GetReadyMs(NodeIndex);
+		Info.StartMs = Simulation.NodeStartMs[NodeIndex];
+		Info.bOnCriticalPath = CriticalPath.NodeInfos.IsValidIndex(NodeIndex) && CriticalPath.NodeInfos[NodeIndex].bOnCriticalPath;
+
+		const double EndMs = GetEndMs(NodeIndex);
+		TSet<int32> Dependents;
+		GetDependentProcessors(Graph, NodeIndex, Dependents);
+		for (const int32 DependentIndex : Dependents)
+		{
+			Info.WaitingProcessorCount += FMath::IsNearlyEqual(GetReadyMs(DependentIndex), EndMs) ? 1 : 0;
+		}
+
+		for (int32 LaneIndex = 1; LaneIndex < Simulation.Lanes.Num(); ++LaneIndex)
+		{
+			Info.IdleWorkerMs += GetLaneIdleMs(Simulation.Lanes[LaneIndex], Info.StartMs, EndMs);
+		}
+
+		TSet<int32> Downstream;
+		TArray<int32> Stack(Node.Dependents);
+		while (Stack.Num())
+		{
+			const int32 DependentIndex = Stack.Pop(false);
+			if (Downstream.Contains(DependentIndex) == false)
+			{
+				Downstream.Add(DependentIndex);
+				Info.DownstreamWorkMs += Graph.Nodes[DependentIndex].CostMs;
+				Stack.Append(Graph.Nodes[DependentIndex].Dependents);
+			}
+		}
+
+		FSimulation::FResult MovedSimulation;
+		MutableGraph.Nodes[NodeIndex].bRequiresGameThread = false;
+		FSimulation::Simulate(MutableGraph, CoreCount, MovedSimulation);
+		MutableGraph.Nodes[NodeIndex].bRequiresGameThread = true;
+		Info.SimulatedGainMs = SimulatedWallTimeMs - MovedSimulation.WallTimeMs;
+	}
+
+	Processors.Sort([](const FProcessorInfo& A, const FProcessorInfo& B)
+	{
+		return A.SimulatedGainMs != B.SimulatedGainMs ? A.SimulatedGainMs > B.SimulatedGainMs : A.IdleWorkerMs > B.IdleWorkerMs;
+	});
+
+	// sweep the game thread lane for the stretches no worker overlaps
+	GameThreadOnlyMs = 0.;
+	for (const FSimulation::FLaneEntry& Entry : Simulation.Lanes[0].Entries)
+	{
+		TArray<TPair<double, double>> Busy;
+		for (int32 LaneIndex = 1; LaneIndex < Simulation.Lanes.Num(); ++LaneIndex)
+		{
+			for (const FSimulation::FLaneEntry& WorkerEntry : Simulation.Lanes[LaneIndex].Entries)
+			{
+				if (WorkerEntry.EndMs > Entry.StartMs && WorkerEntry.StartMs < Entry.EndMs)
+				{
+					Busy.Add({ FMath::Max(Entry.StartMs, WorkerEntry.StartMs), FMath::Min(Entry.EndMs, WorkerEntry.EndMs) });
+				}
+			}
+		}
+		Busy.Sort([](const TPair<double, double>& A, const TPair<double, double>& B) { return A.Key < B.Key; });
+		double CursorMs = Entry.StartMs;
+		for (const TPair<double, double>& Interval : Busy)
+		{
+			GameThreadOnlyMs += FMath::Max(0., Interval.Key - CursorMs);
+			CursorMs = FMath::Max(CursorMs, Interval.Value);
+		}
+		GameThreadOnlyMs += FMath::Max(0., Entry.EndMs - CursorMs);
+	}
+
+	for (FMassProcessorGraph::FNode& Node : MutableGraph.Nodes)
+	{
+		Node.bRequiresGameThread = false;
+	}
+	FSimulation::FResult AllOffSimulation;
+	FSimulation::Simulate(MutableGraph, CoreCount, AllOffSimulation);
+	AllOffGameThreadWallTimeMs = AllOffSimulation.WallTimeMs;
+}
+
+void FMassGameThreadAudit::WriteJson(FMassDependencyJsonWriter& Writer, const FMassProcessorGraph& Graph) const
+{
+	Writer.BeginObject();
+	Writer.WriteNumberField(TEXT("CoreCount"), CoreCount);
+	Writer.WriteBoolField(TEXT("HasCycle"), bHasCycle);
+	Writer.WriteNumberField(TEXT("TotalWorkMs"), TotalWorkMs);
+	Writer.WriteNumberField(TEXT("GameThreadWorkMs"), GameThreadWorkMs);
+	Writer.WriteNumberField(TEXT("GameThreadWorkShare"), TotalWorkMs > 0. ? GameThreadWorkMs / TotalWorkMs : 0.);
+	Writer.WriteNumberField(TEXT("CriticalPathGameThreadMs"), CriticalPathGameThreadMs);
+	Writer.WriteNumberField(TEXT("SimulatedWallTimeMs"), SimulatedWallTimeMs);
+	Writer.WriteNumberField(TEXT("GameThreadOnlyMs"), GameThreadOnlyMs);
+	Writer.WriteNumberField(TEXT("AllOffGameThreadWallTimeMs"), AllOffGameThreadWallTimeMs);
+
+	Writer.WriteKey(TEXT("Processors"));
+	Writer.BeginArray();
+	for (int32 Rank = 0; Rank < Processors.Num(); ++Rank)
+	{
+		const FProcessorInfo& Info = Processors[Rank];
+		Writer.BeginObject();
+		Writer.WriteNumberField(TEXT("Rank"), Rank + 1);
+		Writer.WriteNameField(TEXT("NodeName"), Graph.Nodes[Info.NodeIndex].Name);
+		Writer.WriteNumberField(TEXT("SolvedOrderIndex"), Info.SolvedOrderIndex);
+		Writer.WriteNumberField(TEXT("CostMs"), Info.CostMs);
+		Writer.WriteNumberField(TEXT("StartMs"), Info.StartMs);
+		Writer.WriteNumberField(TEXT("GameThreadWaitMs"), Info.GetGameThreadWaitMs());
+		Writer.WriteNumberField(TEXT("WaitingProcessorCount"), Info.WaitingProcessorCount);
+		Writer.WriteNumberField(TEXT("IdleWorkerMs"), Info.IdleWorkerMs);
+		Writer.WriteNumberField(TEXT("DownstreamWorkMs"), Info.DownstreamWorkMs);
+		Writer.WriteBoolField(TEXT("OnCriticalPath"), Info.bOnCriticalPath);
+		Writer.WriteNumberField(TEXT("SimulatedGainMs"), Info.SimulatedGainMs);
+		Writer.EndObject();
+	}
+	Writer.EndArray();
+
+	Writer.EndObject();
+}
@@ -0,0 +1,38 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Reads engine members MassEntity doesn't expose, without patching the engine. Explicit template instantiations are
+ * allowed to name private members, so the member pointer is smuggled out through a friend function:
+ *
+ *   struct FChunksTag { using Type = TArray<FMassArchetypeChunk> FMassArchetypeData::*; friend Type GetPrivateMember(FChunksTag); };
+ *   template struct TMassPrivateMemberAccessor<FChunksTag, &FMassArchetypeData::Chunks>;
+ *   const auto& Chunks = ArchetypeData.*GetPrivateMember(FChunksTag());
+ *
+ * Debug tooling only: the tagged members have to be kept in sync with the engine version.
+ */
+namespace UE::MassHelper::Private
+{
+	/** Has to share the tags' namespace, the friend below defines the function the tags declare. */
+	template<typename TTag, typename TTag::Type Member>
+	struct TMassPrivateMemberAccessor
+	{
+		friend typename TTag::Type GetPrivateMember(TTag)
+		{
+			return Member;
+		}
+	};
+
+	/** For members whose type isn't accessible either, e.g. arrays of protected nested types: the tag declares `friend auto GetPrivateMember(TTag);` instead. */
+	template<typename TTag, auto Member>
+	struct TMassPrivateMemberAutoAccessor
+	{
+		friend auto GetPrivateMember(TTag)
+		{
+			return Member;
+		}
+	};
+}
@@ -0,0 +1,330 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+#include "MassHelper/Public/Analysis/MassProcessorConstraintAnalysis.h"
+#include "MassHelper/Public/Analysis/MassProcessorGraph.h"
+#include "MassHelper/Public/Analysis/MassProcessorScheduleSimulation.h"
+#include "MassHelper/Public/Processor/MassDependencyJsonWriter.h"
+
+namespace UE::MassHelper::Private
+{
+	using FNodeDesc = FMassDependencyReasonResolver::FNodeDesc;
+	using FAncestors = TArray<int32, TInlineAllocator<8>>;
+
+	/** Processors and the edges they actually run with, costs included. */
+	void BuildExecutionOrderGraph(const FMassProcessorGraph& Graph, FMassProcessorGraph& OutGraph, TArray<int32>& OutGraphToExecution)
+	{
+		OutGraphToExecution.Init(INDEX_NONE, Graph.Nodes.Num());
+		for (int32 NodeIndex = 0; NodeIndex < Graph.Nodes.Num(); ++NodeIndex)
+		{
+			const FMassProcessorGraph::FNode& Node = Graph.Nodes[NodeIndex];
+			if (Node.IsProcessor())
+			{
+				OutGraphToExecution[NodeIndex] = OutGraph.FindOrAddNode(Node.Name, Node.Processor);
+				OutGraph.Nodes[OutGraphToExecution[NodeIndex]].CostMs = Node.CostMs;
+			}
+		}
+		for (const TPair<TPair<int32, int32>, FMassProcessorGraph::EEdgeSource>& Edge : Graph.Edges)
+		{
+			const int32 FromIndex = OutGraphToExecution[Edge.Key.Key];
+			const int32 ToIndex = OutGraphToExecution[Edge.Key.Value];
+			if (FromIndex != INDEX_NONE && ToIndex != INDEX_NONE && EnumHasAnyFlags(Edge.Value, FMassProcessorGraph::EEdgeSource::ExecutionOrder))
+			{
+				OutGraph.AddEdge(FromIndex, ToIndex, FMassProcessorGraph::EEdgeSource::ExecutionOrder);
+			}
+		}
+	}
+
+	void Measure(const FMassProcessorGraph& Graph, const int32 CoreCount, double& OutCriticalPathMs, double& OutWallTimeMs)
+	{
+		FMassCriticalPathAnalysis CriticalPath;
+		CriticalPath.Analyze(Graph);
+		FMassProcessorScheduleSimulation::FResult Simulation;
+		FMassProcessorScheduleSimulation::Simulate(Graph, CoreCount, Simulation);
+		OutCriticalPathMs = CriticalPath.CriticalPathMs;
+		OutWallTimeMs = Simulation.WallTimeMs;
+	}
+
+	void GetAncestors(TConstArrayView<int32> ParentGroups, const int32 NodeIndex, FAncestors& OutAncestors)
+	{
+		for (int32 Index = NodeIndex; Index != INDEX_NONE; Index = ParentGroups.IsValidIndex(Index) ? ParentGroups[Index] : INDEX_NONE)
+		{
+			OutAncestors.Add(Index);
+		}
+	}
+
+	uint64 GetConstraintKey(const FMassProcessorConstraintAnalysis::FConstraint& Constraint)
+	{
+		return (uint64(uint32(Constraint.OwnerIndex)) << 33) | (uint64(uint32(Constraint.TargetIndex)) << 1) | (Constraint.bExecuteBefore ? 1 : 0);
+	}
+}
+
+const TCHAR* FMassProcessorConstraintAnalysis::KindToString(const EFindingKind InKind)
+{
+	switch (InKind)
+	{
+	case EFindingKind::ExplicitOrderWithoutConflict:
+		return TEXT("ExplicitOrderWithoutConflict");
+	case EFindingKind::GroupOrderWithoutConflict:
+		return TEXT("GroupOrderWithoutConflict");
+	default:
+		return TEXT("Redundant");
+	}
+}
+
+void FMassProcessorConstraintAnalysis::Analyze(const FMassProcessorGraph& Graph, TConstArrayView<FMassDependencyReasonResolver::FNodeDesc> NodeDescs, TConstArrayView<int32> ParentGroups
+	, const int32 InCoreCount)
+{
+	Findings.Reset();
+	CoreCount = FMath::Max(1, InCoreCount);
+
+	FindRelaxableConstraints(Graph, NodeDescs, ParentGroups);
+	FindRedundantConstraints(Graph, NodeDescs);
+
+	Findings.StableSort([](const FFinding& A, const FFinding& B)
+		{
+			if ((A.Kind == EFindingKind::Redundant) != (B.Kind == EFindingKind::Redundant))
+			{
+				return B.Kind == EFindingKind::Redundant;
+			}
+			if (A.SimulatedGainMs != B.SimulatedGainMs)
+			{
+				return A.SimulatedGainMs > B.SimulatedGainMs;
+			}
+			if (A.CriticalPathGainMs != B.CriticalPathGainMs)
+			{
+				return A.CriticalPathGainMs > B.CriticalPathGainMs;
+			}
+			return A.RelaxableEdges.Num() > B.RelaxableEdges.Num();
+		});
+}
+
+void FMassProcessorConstraintAnalysis::FindRelaxableConstraints(const FMassProcessorGraph& Graph, TConstArrayView<FMassDependencyReasonResolver::FNodeDesc> NodeDescs
+	, TConstArrayView<int32> ParentGroups)
+{
+	using namespace UE::MassHelper::Private;
+
+	FMassProcessorGraph ExecutionGraph;
+	TArray<int32> GraphToExecution;
+	BuildExecutionOrderGraph(Graph, ExecutionGraph, GraphToExecution);
+	TotalWorkMs = ExecutionGraph.GetTotalWorkMs();
+	Measure(ExecutionGraph, CoreCount, CriticalPathMs, SimulatedWallTimeMs);
+
+	TMap<uint64, int32> FindingIndexMap;
+	TArray<FConstraint, TInlineAllocator<4>> EdgeConstraints;
+	TArray<FMassDependencyEdgeReason> Reasons;
+	FAncestors FromAncestors;
+	FAncestors ToAncestors;
+	for (const TPair<TPair<int32, int32>, FMassProcessorGraph::EEdgeSource>& Edge : Graph.Edges)
+	{
+		const int32 FromIndex = Edge.Key.Key;
+		const int32 ToIndex = Edge.Key.Value;
+		if (GraphToExecution[FromIndex] == INDEX_NONE || GraphToExecution[ToIndex] == INDEX_NONE
+			|| EnumHasAnyFlags(Edge.Value, FMassProcessorGraph::EEdgeSource::ExecutionOrder) == false
+			|| NodeDescs.IsValidIndex(FromIndex) == false || NodeDescs.IsValidIndex(ToIndex) == false)
+		{
+			continue;
+		}
+
+		// every constraint declared between the two processors or any of their groups implies this edge
+		FromAncestors.Reset();
+		ToAncestors.Reset();
+		GetAncestors(ParentGroups, FromIndex, FromAncestors);
+		GetAncestors(ParentGroups, ToIndex, ToAncestors);
+		EdgeConstraints.Reset();
+		for (const int32 OwnerIndex : ToAncestors)
+		{
+			for (const FName TargetName : NodeDescs[OwnerIndex].ExecuteAfter)
+			{
+				const int32* TargetIndex = Graph.NodeIndexMap.Find(TargetName);
+				if (TargetIndex && FromAncestors.Contains(*TargetIndex))
+				{
+					EdgeConstraints.AddUnique({ OwnerIndex, *TargetIndex, /*bExecuteBefore=*/false });
+				}
+			}
+		}
+		for (const int32 OwnerIndex : FromAncestors)
+		{
+			for (const FName TargetName : NodeDescs[OwnerIndex].ExecuteBefore)
+			{
+				const int32* TargetIndex = Graph.NodeIndexMap.Find(TargetName);
+				if (TargetIndex && ToAncestors.Contains(*TargetIndex))
+				{
+					EdgeConstraints.AddUnique({ OwnerIndex, *TargetIndex, /*bExecuteBefore=*/true });
+				}
+			}
+		}
+		if (EdgeConstraints.Num() == 0)
+		{
+			continue;
+		}
+
+		Reasons.Reset();
+		const bool bHasConflict = FMassDependencyReasonResolver::GetResourceReasons(NodeDescs[FromIndex], NodeDescs[ToIndex], Reasons);
+		for (const FConstraint& Constraint : EdgeConstraints)
+		{
+			int32& FindingIndex = FindingIndexMap.FindOrAdd(GetConstraintKey(Constraint), INDEX_NONE);
+			if (FindingIndex == INDEX_NONE)
+			{
+				FindingIndex = Findings.Num();
+				FFinding& NewFinding = Findings.AddDefaulted_GetRef();
+				NewFinding.Constraint = Constraint;
+				NewFinding.Kind = Graph.Nodes[Constraint.OwnerIndex].IsProcessor() && Graph.Nodes[Constraint.TargetIndex].IsProcessor()
+					? EFindingKind::ExplicitOrderWithoutConflict : EFindingKind::GroupOrderWithoutConflict;
+			}
+
+			FFinding& Finding = Findings[FindingIndex];
+			if (bHasConflict)
+			{
+				++Finding.ConflictingEdgeCount;
+			}
+			else if (EdgeConstraints.Num() > 1)
+			{
+				++Finding.SharedEdgeCount;
+			}
+			else
+			{
+				Finding.RelaxableEdges.Add(Edge.Key);
+			}
+		}
+	}
+
+	// constraints that are either needed or only relaxable together with others aren't reported
+	Findings.RemoveAll([](const FFinding& Finding) { return Finding.RelaxableEdges.Num() == 0; });
+
+	for (FFinding& Finding : Findings)
+	{
+		FMassProcessorGraph RelaxedGraph = ExecutionGraph;
+		for (const TPair<int32, int32>& RelaxableEdge : Finding.RelaxableEdges)
+		{
+			RelaxedGraph.RemoveEdge(GraphToExecution[RelaxableEdge.Key], GraphToExecution[RelaxableEdge.Value]);
+		}
+
+		double RelaxedCriticalPathMs = 0.;
+		double RelaxedWallTimeMs = 0.;
+		Measure(RelaxedGraph, CoreCount, RelaxedCriticalPathMs, RelaxedWallTimeMs);
+		Finding.CriticalPathGainMs = CriticalPathMs - RelaxedCriticalPathMs;
+		Finding.SimulatedGainMs = SimulatedWallTimeMs - RelaxedWallTimeMs;
+		Finding.ParallelismAfter = RelaxedCriticalPathMs > 0. ? TotalWorkMs / RelaxedCriticalPathMs : 0.;
+	}
+}
+
+void FMassProcessorConstraintAnalysis::FindRedundantConstraints(const FMassProcessorGraph& Graph, TConstArrayView<FMassDependencyReasonResolver::FNodeDesc> NodeDescs)
+{
+	TArray<int32> Order;
+	if (Graph.GetTopologicalOrder(Order) == false)
+	{
+		UE_LOG(LogMass, Warning, TEXT("%s dependency cycle detected, skipping the redundant constraint search"), ANSI_TO_TCHAR(__FUNCTION__));
+		return;
+	}
+
+	// Reachable[Node] holds every node reachable from Node through at least one edge
+	TArray<TBitArray<>> Reachable;
+	Reachable.SetNum(Graph.Nodes.Num());
+	for (int32 OrderIndex = Order.Num() - 1; OrderIndex >= 0; --OrderIndex)
+	{
+		const int32 NodeIndex = Order[OrderIndex];
+		TBitArray<>& NodeReachable = Reachable[NodeIndex];
+		NodeReachable.Init(false, Graph.Nodes.Num());
+		for (const int32 DependentIndex : Graph.Nodes[NodeIndex].Dependents)
+		{
+			NodeReachable[DependentIndex] = true;
+			NodeReachable.CombineWithBitwiseOR(Reachable[DependentIndex], EBitwiseOperatorFlags::MaintainSize);
+		}
+	}
+
+	TArray<FMassDependencyEdgeReason> Reasons;
+	for (const TPair<TPair<int32, int32>, FMassProcessorGraph::EEdgeSource>& Edge : Graph.Edges)
+	{
+		const int32 FromIndex = Edge.Key.Key;
+		const int32 ToIndex = Edge.Key.Value;
+		if (EnumHasAnyFlags(Edge.Value, FMassProcessorGraph::EEdgeSource::OriginalDependency) == false
+			|| NodeDescs.IsValidIndex(FromIndex) == false || NodeDescs.IsValidIndex(ToIndex) == false)
+		{
+			continue;
+		}
+
+		Reasons.Reset();
+		FMassDependencyReasonResolver::GetOrderingReasons(NodeDescs[FromIndex], NodeDescs[ToIndex], Reasons);
+		if (Reasons.Num() == 0 || Reasons[0].Kind != FMassDependencyEdgeReason::EKind::ExplicitOrder)
+		{
+			continue;
+		}
+
+		for (const int32 ViaIndex : Graph.Nodes[FromIndex].Dependents)
+		{
+			if (ViaIndex != ToIndex && Reachable[ViaIndex][ToIndex])
+			{
+				FFinding& Finding = Findings.AddDefaulted_GetRef();
+				Finding.Kind = EFindingKind::Redundant;
+				Finding.Constraint = NodeDescs[ToIndex].ExecuteAfter.Contains(NodeDescs[FromIndex].Name)
+					? FConstraint{ ToIndex, FromIndex, /*bExecuteBefore=*/false }
+					: FConstraint{ FromIndex, ToIndex, /*bExecuteBefore=*/true };
+				Finding.ImpliedViaIndex = ViaIndex;
+				break;
+			}
+		}
+	}
+}
+
+void FMassProcessorConstraintAnalysis::WriteJson(FMassDependencyJsonWriter& Writer, const FMassProcessorGraph& Graph) const
+{
+	auto WriteConstraint = [&Writer, &Graph](const FFinding& Finding)
+	{
+		Writer.WriteStringField(TEXT("Kind"), KindToString(Finding.Kind));
+		Writer.WriteNameField(TEXT("Owner"), Graph.Nodes[Finding.Constraint.OwnerIndex].Name);
+		Writer.WriteStringField(TEXT("Relation"), Finding.Constraint.bExecuteBefore ? TEXT("ExecuteBefore") : TEXT("ExecuteAfter"));
+		Writer.WriteNameField(TEXT("Target"), Graph.Nodes[Finding.Constraint.TargetIndex].Name);
+	};
+
+	Writer.BeginObject();
+	Writer.WriteNumberField(TEXT("CoreCount"), CoreCount);
+	Writer.WriteNumberField(TEXT("TotalWorkMs"), TotalWorkMs);
+	Writer.WriteNumberField(TEXT("CriticalPathMs"), CriticalPathMs);
+	Writer.WriteNumberField(TEXT("Parallelism"), CriticalPathMs > 0. ? TotalWorkMs / CriticalPathMs : 0.);
+	Writer.WriteNumberField(TEXT("SimulatedWallTimeMs"), SimulatedWallTimeMs);
+
+	Writer.WriteKey(TEXT("Relaxable"));
+	Writer.BeginArray();
+	for (const FFinding& Finding : Findings)
+	{
+		if (Finding.Kind == EFindingKind::Redundant)
+		{
+			continue;
+		}
+		Writer.BeginObject();
+		WriteConstraint(Finding);
+		Writer.WriteKey(TEXT("RelaxableEdges"));
+		Writer.BeginArray();
+		for (const TPair<int32, int32>& RelaxableEdge : Finding.RelaxableEdges)
+		{
+			Writer.BeginObject();
+			Writer.WriteNameField(TEXT("From"), Graph.Nodes[RelaxableEdge.Key].Name);
+			Writer.WriteNameField(TEXT("To"), Graph.Nodes[RelaxableEdge.Value].Name);
+			Writer.EndObject();
+		}
+		Writer.EndArray();
+		Writer.WriteNumberField(TEXT("ConflictingEdgeCount"), Finding.ConflictingEdgeCount);
+		Writer.WriteNumberField(TEXT("SharedEdgeCount"), Finding.SharedEdgeCount);
+		Writer.WriteNumberField(TEXT("CriticalPathGainMs"), Finding.CriticalPathGainMs);
+		Writer.WriteNumberField(TEXT("SimulatedGainMs"), Finding.SimulatedGainMs);
+		Writer.WriteNumberField(TEXT("ParallelismAfter"), Finding.ParallelismAfter);
+		Writer.EndObject();
+	}
+	Writer.EndArray();
+
+	Writer.WriteKey(TEXT("Redundant"));
+	Writer.BeginArray();
+	for (const FFinding& Finding : Findings)
+	{
+		if (Finding.Kind != EFindingKind::Redundant)
+		{
+			continue;
+		}
+		Writer.BeginObject();
+		WriteConstraint(Finding);
+		Writer.WriteNameField(TEXT("ImpliedVia"), Graph.Nodes[Finding.ImpliedViaIndex].Name);
+		Writer.EndObject();
+	}
+	Writer.EndArray();
+
+	Writer.EndObject();
+}
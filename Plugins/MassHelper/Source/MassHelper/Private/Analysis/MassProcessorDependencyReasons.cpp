@@ -0,0 +1,218 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+#include "MassHelper/Public/Analysis/MassProcessorDependencyReasons.h"
+#include "MassHelper/Public/Processor/MassDependencyJsonWriter.h"
+
+namespace UE::MassHelper::Private
+{
+	template<typename TBitSet>
+	void ExportTypeNames(const TBitSet& BitSet, TArray<FString>& OutNames)
+	{
+		TArray<const UStruct*> Types;
+		BitSet.ExportTypes(Types);
+		for (const UStruct* Type : Types)
+		{
+			OutNames.Add(GetNameSafe(Type));
+		}
+	}
+
+	template<typename TBitSet>
+	bool AddAccessConflicts(const TMassExecutionAccess<TBitSet>& From, const TMassExecutionAccess<TBitSet>& To
+		, const FMassDependencyEdgeReason::EKind Kind, TArray<FMassDependencyEdgeReason>& OutReasons)
+	{
+		using EAccess = FMassDependencyEdgeReason::EAccess;
+		const TPair<EAccess, TBitSet> Overlaps[] = {
+			{ EAccess::WriteWrite, From.Write.GetOverlap(To.Write) },
+			{ EAccess::WriteRead, From.Write.GetOverlap(To.Read) },
+			{ EAccess::ReadWrite, From.Read.GetOverlap(To.Write) },
+		};
+
+		bool bAnyConflict = false;
+		for (const TPair<EAccess, TBitSet>& Overlap : Overlaps)
+		{
+			if (Overlap.Value.IsEmpty() == false)
+			{
+				FMassDependencyEdgeReason& Reason = OutReasons.AddDefaulted_GetRef();
+				Reason.Kind = Kind;
+				Reason.Access = Overlap.Key;
+				ExportTypeNames(Overlap.Value, Reason.Types);
+				bAnyConflict = true;
+			}
+		}
+		return bAnyConflict;
+	}
+
+	bool IsNodeOrGroup(const FMassDependencyReasonResolver::FNodeDesc& Node, TConstArrayView<FMassDependencyReasonResolver::FNodeDesc> Groups, const FName Name)
+	{
+		return Node.Name == Name || Groups.ContainsByPredicate([Name](const FMassDependencyReasonResolver::FNodeDesc& Group) { return Group.Name == Name; });
+	}
+
+	void AddOrderingReason(const FMassDependencyEdgeReason::EKind Kind, const FName Owner, const FName Target, const bool bExecuteBefore, TArray<FMassDependencyEdgeReason>& OutReasons)
+	{
+		FMassDependencyEdgeReason& Reason = OutReasons.AddDefaulted_GetRef();
+		Reason.Kind = Kind;
+		Reason.ConstraintOwner = Owner;
+		Reason.ConstraintTarget = Target;
+		Reason.bConstraintExecuteBefore = bExecuteBefore;
+	}
+}
+
+const TCHAR* FMassDependencyEdgeReason::KindToString(const EKind InKind)
+{
+	switch (InKind)
+	{
+	case EKind::ExplicitOrder:
+		return TEXT("ExplicitOrder");
+	case EKind::GroupOrder:
+		return TEXT("GroupOrder");
+	case EKind::InheritedGroupOrder:
+		return TEXT("InheritedGroupOrder");
+	case EKind::FragmentAccess:
+		return TEXT("FragmentAccess");
+	case EKind::ChunkFragmentAccess:
+		return TEXT("ChunkFragmentAccess");
+	case EKind::SharedFragmentAccess:
+		return TEXT("SharedFragmentAccess");
+	case EKind::SubsystemAccess:
+		return TEXT("SubsystemAccess");
+	case EKind::GameThreadExclusive:
+		return TEXT("GameThreadExclusive");
+	default:
+		return TEXT("Unexplained");
+	}
+}
+
+const TCHAR* FMassDependencyEdgeReason::AccessToString(const EAccess InAccess)
+{
+	switch (InAccess)
+	{
+	case EAccess::WriteRead:
+		return TEXT("WriteRead");
+	case EAccess::ReadWrite:
+		return TEXT("ReadWrite");
+	case EAccess::WriteWrite:
+		return TEXT("WriteWrite");
+	default:
+		return TEXT("None");
+	}
+}
+
+void FMassDependencyEdgeReason::WriteJson(FMassDependencyJsonWriter& Writer) const
+{
+	Writer.BeginObject();
+	Writer.WriteStringField(TEXT("Kind"), KindToString(Kind));
+	if (Access != EAccess::None)
+	{
+		Writer.WriteStringField(TEXT("Access"), AccessToString(Access));
+		Writer.WriteKey(TEXT("Types"));
+		Writer.BeginArray();
+		for (const FString& Type : Types)
+		{
+			Writer.WriteString(Type);
+		}
+		Writer.EndArray();
+	}
+	if (ConstraintOwner.IsNone() == false)
+	{
+		Writer.WriteNameField(TEXT("Owner"), ConstraintOwner);
+		Writer.WriteStringField(TEXT("Relation"), bConstraintExecuteBefore ? TEXT("ExecuteBefore") : TEXT("ExecuteAfter"));
+		Writer.WriteNameField(TEXT("Target"), ConstraintTarget);
+	}
+	Writer.EndObject();
+}
+
+void FMassDependencyReasonResolver::GetOrderingReasons(const FNodeDesc& From, const FNodeDesc& To, TArray<FMassDependencyEdgeReason>& OutReasons)
+{
+	GetOrderingReasons(From, To, {}, {}, OutReasons);
+}
+
+void FMassDependencyReasonResolver::GetOrderingReasons(const FNodeDesc& From, const FNodeDesc& To, TConstArrayView<FNodeDesc> FromGroups
+	, TConstArrayView<FNodeDesc> ToGroups, TArray<FMassDependencyEdgeReason>& OutReasons)
+{
+	using UE::MassHelper::Private::AddOrderingReason;
+	using UE::MassHelper::Private::IsNodeOrGroup;
+	using EKind = FMassDependencyEdgeReason::EKind;
+
+	if (To.ExecuteAfter.Contains(From.Name))
+	{
+		AddOrderingReason(EKind::ExplicitOrder, To.Name, From.Name, /*bExecuteBefore=*/false, OutReasons);
+	}
+	else if (From.ExecuteBefore.Contains(To.Name))
+	{
+		AddOrderingReason(EKind::ExplicitOrder, From.Name, To.Name, /*bExecuteBefore=*/true, OutReasons);
+	}
+	else if (From.bIsGroup || To.bIsGroup)
+	{
+		OutReasons.AddDefaulted_GetRef().Kind = EKind::GroupOrder;
+	}
+	else
+	{
+		// the solver copies group level ExecuteBefore/ExecuteAfter down to the group's members, so look for the
+		// constraint declared by either processor or its groups against the other processor or its groups
+		auto AddInherited = [&OutReasons](const FNodeDesc& Owner, TConstArrayView<FName> Targets, const FNodeDesc& Other
+			, TConstArrayView<FNodeDesc> OtherGroups, const bool bExecuteBefore)
+		{
+			for (const FName Target : Targets)
+			{
+				if (IsNodeOrGroup(Other, OtherGroups, Target))
+				{
+					AddOrderingReason(EKind::InheritedGroupOrder, Owner.Name, Target, bExecuteBefore, OutReasons);
+				}
+			}
+		};
+
+		AddInherited(To, To.ExecuteAfter, From, FromGroups, /*bExecuteBefore=*/false);
+		for (const FNodeDesc& Group : ToGroups)
+		{
+			AddInherited(Group, Group.ExecuteAfter, From, FromGroups, /*bExecuteBefore=*/false);
+		}
+		AddInherited(From, From.ExecuteBefore, To, ToGroups, /*bExecuteBefore=*/true);
+		for (const FNodeDesc& Group : FromGroups)
+		{
+			AddInherited(Group, Group.ExecuteBefore, To, ToGroups, /*bExecuteBefore=*/true);
+		}
+	}
+}
+
+bool FMassDependencyReasonResolver::GetResourceReasons(const FNodeDesc& From, const FNodeDesc& To, TArray<FMassDependencyEdgeReason>& OutReasons)
+{
+	using UE::MassHelper::Private::AddAccessConflicts;
+	using EKind = FMassDependencyEdgeReason::EKind;
+
+	if (From.bIsGroup || To.bIsGroup || From.Requirements == nullptr || To.Requirements == nullptr)
+	{
+		return false;
+	}
+
+	const FMassExecutionRequirements& FromRequirements = *From.Requirements;
+	const FMassExecutionRequirements& ToRequirements = *To.Requirements;
+
+	bool bAnyConflict = false;
+	bAnyConflict |= AddAccessConflicts(FromRequirements.Fragments, ToRequirements.Fragments, EKind::FragmentAccess, OutReasons);
+	bAnyConflict |= AddAccessConflicts(FromRequirements.ChunkFragments, ToRequirements.ChunkFragments, EKind::ChunkFragmentAccess, OutReasons);
+	bAnyConflict |= AddAccessConflicts(FromRequirements.SharedFragments, ToRequirements.SharedFragments, EKind::SharedFragmentAccess, OutReasons);
+	bAnyConflict |= AddAccessConflicts(FromRequirements.RequiredSubsystems, ToRequirements.RequiredSubsystems, EKind::SubsystemAccess, OutReasons);
+
+	if (From.bRequiresGameThread && To.bRequiresGameThread)
+	{
+		OutReasons.AddDefaulted_GetRef().Kind = EKind::GameThreadExclusive;
+		bAnyConflict = true;
+	}
+
+	return bAnyConflict;
+}
+
+void FMassDependencyReasonResolver::GetReasons(const FNodeDesc& From, const FNodeDesc& To, TConstArrayView<FNodeDesc> FromGroups, TConstArrayView<FNodeDesc> ToGroups
+	, const bool bIsOrderingEdge, TArray<FMassDependencyEdgeReason>& OutReasons)
+{
+	const int32 FirstReasonIndex = OutReasons.Num();
+	if (bIsOrderingEdge)
+	{
+		GetOrderingReasons(From, To, FromGroups, ToGroups, OutReasons);
+	}
+	GetResourceReasons(From, To, OutReasons);
+
+	if (OutReasons.Num() == FirstReasonIndex)
+	{
+		OutReasons.AddDefaulted_GetRef().Kind = FMassDependencyEdgeReason::EKind::Unexplained;
+	}
+}
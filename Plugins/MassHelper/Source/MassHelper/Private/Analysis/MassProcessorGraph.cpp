@@ -0,0 +1,363 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+#include "MassHelper/Public/Analysis/MassProcessorGraph.h"
+#include "MassHelper/Public/Processor/MassDependencyJsonWriter.h"
+#include "MassHelper/Public/Profiling/MassProcessorTimingCapture.h"
+
+#include "Json/Public/Dom/JsonObject.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+
+//----------------------------------------------------------------------//
+// FMassProcessorCostTable
+//----------------------------------------------------------------------//
+void FMassProcessorCostTable::AddFromTimingCapture(const FMassProcessorTimingCapture& Capture)
+{
+	TMap<FName, FMassProcessorTimingCapture::FProcessorStats> AllStats;
+	Capture.ComputeStats(AllStats);
+	for (const TPair<FName, FMassProcessorTimingCapture::FProcessorStats>& It : AllStats)
+	{
+		CostsMs.Add(It.Key, It.Value.AvgMs);
+	}
+}
+
+bool FMassProcessorCostTable::LoadFromJsonFile(const FString& FilePath)
+{
+	FString JsonString;
+	if (!FFileHelper::LoadFileToString(JsonString, *FilePath))
+	{
+		UE_LOG(LogMass, Warning, TEXT("%s unable to read %s"), ANSI_TO_TCHAR(__FUNCTION__), *FilePath);
+		return false;
+	}
+
+	TSharedPtr<FJsonObject> RootJson;
+	if (!FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(JsonString), RootJson) || !RootJson.IsValid())
+	{
+		UE_LOG(LogMass, Warning, TEXT("%s %s is not valid json"), ANSI_TO_TCHAR(__FUNCTION__), *FilePath);
+		return false;
+	}
+
+	RootJson->TryGetNumberField(TEXT("DefaultCostMs"), DefaultCostMs);
+
+	const TSharedPtr<FJsonObject>* CostsJson = nullptr;
+	if (RootJson->TryGetObjectField(TEXT("Costs"), CostsJson))
+	{
+		for (const TPair<FString, TSharedPtr<FJsonValue>>& It : (*CostsJson)->Values)
+		{
+			CostsMs.Add(FName(*It.Key), It.Value->AsNumber());
+		}
+		return true;
+	}
+
+	const TArray<TSharedPtr<FJsonValue>>* NodesJson = nullptr;
+	if (RootJson->TryGetArrayField(TEXT("Nodes"), NodesJson))
+	{
+		for (const TSharedPtr<FJsonValue>& NodeValue : *NodesJson)
+		{
+			const TSharedPtr<FJsonObject>& NodeJson = NodeValue->AsObject();
+			const TSharedPtr<FJsonObject>* TimingJson = nullptr;
+			double AvgMs = 0.;
+			if (NodeJson.IsValid() && NodeJson->TryGetObjectField(TEXT("Timing"), TimingJson) && (*TimingJson)->TryGetNumberField(TEXT("AvgMs"), AvgMs))
+			{
+				CostsMs.Add(FName(*NodeJson->GetStringField(TEXT("NodeName"))), AvgMs);
+			}
+		}
+		return true;
+	}
+
+	UE_LOG(LogMass, Warning, TEXT("%s %s has neither a Costs object nor a Nodes array"), ANSI_TO_TCHAR(__FUNCTION__), *FilePath);
+	return false;
+}
+
+//----------------------------------------------------------------------//
+// FMassProcessorGraph
+//----------------------------------------------------------------------//
+int32 FMassProcessorGraph::FindOrAddNode(const FName Name, const UMassProcessor* Processor)
+{
+	if (const int32* NodeIndexPtr = NodeIndexMap.Find(Name))
+	{
+		FNode& ExistingNode = Nodes[*NodeIndexPtr];
+		if (ExistingNode.Processor == nullptr && Processor != nullptr)
+		{
+			ExistingNode.Processor = Processor;
+			ExistingNode.bRequiresGameThread = Processor->DoesRequireGameThreadExecution();
+		}
+		return *NodeIndexPtr;
+	}
+
+	const int32 NodeIndex = Nodes.Num();
+	FNode& Node = Nodes.AddDefaulted_GetRef();
+	Node.Name = Name;
+	Node.Processor = Processor;
+	Node.bRequiresGameThread = Processor && Processor->DoesRequireGameThreadExecution();
+	NodeIndexMap.Add(Name, NodeIndex);
+	return NodeIndex;
+}
+
+void FMassProcessorGraph::AddEdge(const int32 FromIndex, const int32 ToIndex, const EEdgeSource Source)
+{
+	if (FromIndex == ToIndex)
+	{
+		return;
+	}
+
+	EEdgeSource& ExistingSource = Edges.FindOrAdd(TPair<int32, int32>(FromIndex, ToIndex), EEdgeSource::None);
+	if (ExistingSource == EEdgeSource::None)
+	{
+		Nodes[ToIndex].Dependencies.Add(FromIndex);
+		Nodes[FromIndex].Dependents.Add(ToIndex);
+	}
+	ExistingSource |= Source;
+}
+
+FMassProcessorGraph::EEdgeSource FMassProcessorGraph::GetEdgeSource(const int32 FromIndex, const int32 ToIndex) const
+{
+	const EEdgeSource* Source = Edges.Find(TPair<int32, int32>(FromIndex, ToIndex));
+	return Source ? *Source : EEdgeSource::None;
+}
+
+void FMassProcessorGraph::RemoveEdge(const int32 FromIndex, const int32 ToIndex)
+{
+	if (Edges.Remove(TPair<int32, int32>(FromIndex, ToIndex)))
+	{
+		Nodes[ToIndex].Dependencies.Remove(FromIndex);
+		Nodes[FromIndex].Dependents.Remove(ToIndex);
+	}
+}
+
+void FMassProcessorGraph::AddExecutionOrder(TConstArrayView<FMassProcessorOrderInfo> SortedProcessors)
+{
+	for (const FMassProcessorOrderInfo& OrderInfo : SortedProcessors)
+	{
+		if (OrderInfo.NodeType != FMassProcessorOrderInfo::EDependencyNodeType::Processor)
+		{
+			continue;
+		}
+		const int32 NodeIndex = FindOrAddNode(OrderInfo.Name, OrderInfo.Processor);
+		for (const FName DependencyName : OrderInfo.Dependencies)
+		{
+			AddEdge(FindOrAddNode(DependencyName, nullptr), NodeIndex, EEdgeSource::ExecutionOrder);
+		}
+	}
+}
+
+void FMassProcessorGraph::ApplyCosts(const FMassProcessorCostTable& CostTable)
+{
+	for (FNode& Node : Nodes)
+	{
+		Node.CostMs = Node.IsProcessor() ? CostTable.GetCostMs(Node.Name) : 0.;
+	}
+}
+
+bool FMassProcessorGraph::GetTopologicalOrder(TArray<int32>& OutOrder) const
+{
+	OutOrder.Reset(Nodes.Num());
+
+	TArray<int32> PendingDependencies;
+	PendingDependencies.AddUninitialized(Nodes.Num());
+	for (int32 NodeIndex = 0; NodeIndex < Nodes.Num(); ++NodeIndex)
+	{
+		PendingDependencies[NodeIndex] = Nodes[NodeIndex].Dependencies.Num();
+		if (PendingDependencies[NodeIndex] == 0)
+		{
+			OutOrder.Add(NodeIndex);
+		}
+	}
+
+	for (int32 OrderIndex = 0; OrderIndex < OutOrder.Num(); ++OrderIndex)
+	{
+		for (const int32 DependentIndex : Nodes[OutOrder[OrderIndex]].Dependents)
+		{
+			if (--PendingDependencies[DependentIndex] == 0)
+			{
+				OutOrder.Add(DependentIndex);
+			}
+		}
+	}
+
+	return OutOrder.Num() == Nodes.Num();
+}
+
+int32 FMassProcessorGraph::GetProcessorCount() const
+{
+	int32 Count = 0;
+	for (const FNode& Node : Nodes)
+	{
+		Count += Node.IsProcessor() ? 1 : 0;
+	}
+	return Count;
+}
+
+double FMassProcessorGraph::GetTotalWorkMs() const
+{
+	double TotalMs = 0.;
+	for (const FNode& Node : Nodes)
+	{
+		TotalMs += Node.CostMs;
+	}
+	return TotalMs;
+}
+
+double FMassProcessorGraph::GetGameThreadWorkMs() const
+{
+	double TotalMs = 0.;
+	for (const FNode& Node : Nodes)
+	{
+		TotalMs += Node.bRequiresGameThread ? Node.CostMs : 0.;
+	}
+	return TotalMs;
+}
+
+//----------------------------------------------------------------------//
+// FMassCriticalPathAnalysis
+//----------------------------------------------------------------------//
+bool FMassCriticalPathAnalysis::Analyze(const FMassProcessorGraph& Graph)
+{
+	NodeInfos.Reset();
+	NodeInfos.SetNum(Graph.Nodes.Num());
+	CriticalPath.Reset();
+	LevelWidths.Reset();
+
+	TArray<int32> Order;
+	bHasCycle = !Graph.GetTopologicalOrder(Order);
+	if (bHasCycle)
+	{
+		UE_LOG(LogMass, Warning, TEXT("%s dependency cycle detected, only the acyclic part of the graph is analyzed"), ANSI_TO_TCHAR(__FUNCTION__));
+	}
+
+	TotalWorkMs = Graph.GetTotalWorkMs();
+	GameThreadWorkMs = Graph.GetGameThreadWorkMs();
+
+	// forward pass - earliest start times, levels and the longest chain
+	TArray<int32> LongestChainPredecessor;
+	LongestChainPredecessor.Init(INDEX_NONE, Graph.Nodes.Num());
+	TArray<int32> DepthInProcessors;
+	DepthInProcessors.Init(0, Graph.Nodes.Num());
+	int32 CriticalPathEndIndex = INDEX_NONE;
+	CriticalPathMs = 0.;
+
+	for (const int32 NodeIndex : Order)
+	{
+		const FMassProcessorGraph::FNode& Node = Graph.Nodes[NodeIndex];
+		FNodeInfo& Info = NodeInfos[NodeIndex];
+		int32 Depth = 0;
+		for (const int32 DependencyIndex : Node.Dependencies)
+		{
+			const double DependencyFinishMs = NodeInfos[DependencyIndex].EarliestStartMs + Graph.Nodes[DependencyIndex].CostMs;
+			if (DependencyFinishMs > Info.EarliestStartMs || LongestChainPredecessor[NodeIndex] == INDEX_NONE)
+			{
+				Info.EarliestStartMs = FMath::Max(Info.EarliestStartMs, DependencyFinishMs);
+				LongestChainPredecessor[NodeIndex] = DependencyIndex;
+			}
+			Depth = FMath::Max(Depth, DepthInProcessors[DependencyIndex]);
+		}
+
+		if (Node.IsProcessor())
+		{
+			Info.Level = Depth;
+			DepthInProcessors[NodeIndex] = Depth + 1;
+			if (LevelWidths.Num() <= Depth)
+			{
+				LevelWidths.SetNumZeroed(Depth + 1);
+			}
+			++LevelWidths[Depth];
+		}
+		else
+		{
+			DepthInProcessors[NodeIndex] = Depth;
+		}
+
+		const double FinishMs = Info.EarliestStartMs + Node.CostMs;
+		if (CriticalPathEndIndex == INDEX_NONE || FinishMs > CriticalPathMs)
+		{
+			CriticalPathMs = FinishMs;
+			CriticalPathEndIndex = NodeIndex;
+		}
+	}
+
+	// backward pass - latest start times that don't delay the phase
+	for (int32 OrderIndex = Order.Num() - 1; OrderIndex >= 0; --OrderIndex)
+	{
+		const int32 NodeIndex = Order[OrderIndex];
+		const FMassProcessorGraph::FNode& Node = Graph.Nodes[NodeIndex];
+		double LatestFinishMs = CriticalPathMs;
+		for (const int32 DependentIndex : Node.Dependents)
+		{
+			LatestFinishMs = FMath::Min(LatestFinishMs, NodeInfos[DependentIndex].LatestStartMs);
+		}
+		NodeInfos[NodeIndex].LatestStartMs = LatestFinishMs - Node.CostMs;
+	}
+
+	for (int32 NodeIndex = CriticalPathEndIndex; NodeIndex != INDEX_NONE; NodeIndex = LongestChainPredecessor[NodeIndex])
+	{
+		NodeInfos[NodeIndex].bOnCriticalPath = true;
+		if (Graph.Nodes[NodeIndex].IsProcessor())
+		{
+			CriticalPath.Insert(NodeIndex, 0);
+		}
+	}
+
+	return !bHasCycle;
+}
+
+double FMassCriticalPathAnalysis::GetSpeedupLimit(const int32 WorkerCount) const
+{
+	if (TotalWorkMs <= 0. || WorkerCount <= 0)
+	{
+		return 1.;
+	}
+	// lanes are laid out like FMassProcessorScheduleSimulation: with more than one, lane 0 is the game thread and only
+	// takes game thread work, which in turn can't go anywhere else. No schedule beats the longest chain, the game
+	// thread lane, or the rest of the work spread evenly over the other lanes.
+	const double WorkerLanesMs = WorkerCount > 1 ? (TotalWorkMs - GameThreadWorkMs) / (WorkerCount - 1) : TotalWorkMs;
+	const double LowerBoundMs = FMath::Max3(WorkerLanesMs, CriticalPathMs, GameThreadWorkMs);
+	return LowerBoundMs > 0. ? TotalWorkMs / LowerBoundMs : 1.;
+}
+
+void FMassCriticalPathAnalysis::WriteJson(FMassDependencyJsonWriter& Writer, const FMassProcessorGraph& Graph, const int32 MaxWorkerCount) const
+{
+	Writer.BeginObject();
+	Writer.WriteBoolField(TEXT("HasCycle"), bHasCycle);
+	Writer.WriteNumberField(TEXT("ProcessorCount"), Graph.GetProcessorCount());
+	Writer.WriteNumberField(TEXT("TotalWorkMs"), TotalWorkMs);
+	Writer.WriteNumberField(TEXT("CriticalPathMs"), CriticalPathMs);
+	Writer.WriteNumberField(TEXT("GameThreadWorkMs"), GameThreadWorkMs);
+	Writer.WriteNumberField(TEXT("AverageParallelism"), CriticalPathMs > 0. ? TotalWorkMs / CriticalPathMs : 0.);
+
+	Writer.WriteKey(TEXT("CriticalPath"));
+	Writer.BeginArray();
+	for (const int32 NodeIndex : CriticalPath)
+	{
+		Writer.BeginObject();
+		Writer.WriteNameField(TEXT("NodeName"), Graph.Nodes[NodeIndex].Name);
+		Writer.WriteNumberField(TEXT("CostMs"), Graph.Nodes[NodeIndex].CostMs);
+		Writer.WriteNumberField(TEXT("StartMs"), NodeInfos[NodeIndex].EarliestStartMs);
+		Writer.WriteBoolField(TEXT("GameThread"), Graph.Nodes[NodeIndex].bRequiresGameThread);
+		Writer.EndObject();
+	}
+	Writer.EndArray();
+
+	int32 MaxWidth = 0;
+	Writer.WriteKey(TEXT("LevelWidths"));
+	Writer.BeginArray();
+	for (const int32 Width : LevelWidths)
+	{
+		Writer.WriteNumber(Width);
+		MaxWidth = FMath::Max(MaxWidth, Width);
+	}
+	Writer.EndArray();
+	Writer.WriteNumberField(TEXT("MaxLevelWidth"), MaxWidth);
+
+	Writer.WriteKey(TEXT("SpeedupLimits"));
+	Writer.BeginArray();
+	for (int32 WorkerCount = 1; WorkerCount <= MaxWorkerCount; ++WorkerCount)
+	{
+		Writer.BeginObject();
+		Writer.WriteNumberField(TEXT("Workers"), WorkerCount);
+		Writer.WriteNumberField(TEXT("SpeedupLimit"), GetSpeedupLimit(WorkerCount));
+		Writer.EndObject();
+	}
+	Writer.EndArray();
+
+	Writer.EndObject();
+}
@@ -0,0 +1,272 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+#include "MassHelper/Public/Analysis/MassProcessorGraphLayout.h"
+#include "MassHelper/Public/Analysis/MassProcessorGraph.h"
+#include "MassHelper/Public/Processor/MassProcessorDependencyPrinter.h"
+
+namespace UE::MassHelper::Private
+{
+	FString DotQuote(const FName Name)
+	{
+		FString Quoted = Name.ToString();
+		Quoted.ReplaceInline(TEXT("\\"), TEXT("\\\\"));
+		Quoted.ReplaceInline(TEXT("\""), TEXT("\\\""));
+		return FString::Printf(TEXT("\"%s\""), *Quoted);
+	}
+
+	void WriteDotCluster(const FMassProcessorGraph& Graph, const TMultiMap<int32, int32>& Children, const int32 GroupIndex, const int32 Depth, FString& OutDot)
+	{
+		const FString Indent = FString::ChrN(Depth, TEXT('\t'));
+		TArray<int32> ChildIndices;
+		Children.MultiFind(GroupIndex, ChildIndices, /*bMaintainOrder=*/true);
+		for (const int32 ChildIndex : ChildIndices)
+		{
+			const FMassProcessorGraph::FNode& Node = Graph.Nodes[ChildIndex];
+			if (Node.IsProcessor())
+			{
+				OutDot += FString::Printf(TEXT("%s%s [shape=box%s];\n"), *Indent, *DotQuote(Node.Name)
+					, Node.bRequiresGameThread ? TEXT(", style=filled, fillcolor=\"#ffd0d0\"") : TEXT(""));
+				continue;
+			}
+			if (Node.Name.IsNone())
+			{
+				// the solver's unnamed root group is the whole graph, its members go straight in
+				WriteDotCluster(Graph, Children, ChildIndex, Depth, OutDot);
+				continue;
+			}
+
+			OutDot += FString::Printf(TEXT("%ssubgraph \"cluster_%d\" {\n"), *Indent, ChildIndex);
+			OutDot += FString::Printf(TEXT("%s\tlabel=%s; color=blue;\n"), *Indent, *DotQuote(Node.Name));
+			// the group node itself stays in the graph so that edges declared against the group keep their meaning
+			OutDot += FString::Printf(TEXT("%s\t%s [shape=point, color=blue];\n"), *Indent, *DotQuote(Node.Name));
+			WriteDotCluster(Graph, Children, ChildIndex, Depth + 1, OutDot);
+			OutDot += FString::Printf(TEXT("%s}\n"), *Indent);
+		}
+	}
+}
+
+void FMassProcessorGraphLayout::AssignLayers(const FMassProcessorGraph& Graph)
+{
+	TArray<int32> Order;
+	Graph.GetTopologicalOrder(Order);
+
+	NodeLayouts.Reset();
+	NodeLayouts.SetNum(Graph.Nodes.Num());
+	TBitArray<> Placed(false, Graph.Nodes.Num());
+	int32 LayerCount = 0;
+	for (const int32 NodeIndex : Order)
+	{
+		int32 Layer = 0;
+		for (const int32 DependencyIndex : Graph.Nodes[NodeIndex].Dependencies)
+		{
+			Layer = FMath::Max(Layer, NodeLayouts[DependencyIndex].Layer + 1);
+		}
+		NodeLayouts[NodeIndex].Layer = Layer;
+		Placed[NodeIndex] = true;
+		LayerCount = FMath::Max(LayerCount, Layer + 1);
+	}
+
+	// nodes on a cycle have no topological position, park them on an extra last layer
+	const int32 CycleLayer = LayerCount;
+	for (int32 NodeIndex = 0; NodeIndex < Graph.Nodes.Num(); ++NodeIndex)
+	{
+		if (Placed[NodeIndex] == false)
+		{
+			NodeLayouts[NodeIndex].Layer = CycleLayer;
+			LayerCount = CycleLayer + 1;
+		}
+	}
+
+	Layers.Reset();
+	Layers.SetNum(LayerCount);
+	for (const int32 NodeIndex : Order)
+	{
+		Layers[NodeLayouts[NodeIndex].Layer].Add(NodeIndex);
+	}
+	for (int32 NodeIndex = 0; NodeIndex < Graph.Nodes.Num(); ++NodeIndex)
+	{
+		if (Placed[NodeIndex] == false)
+		{
+			Layers[CycleLayer].Add(NodeIndex);
+		}
+	}
+	for (int32 LayerIndex = 0; LayerIndex < Layers.Num(); ++LayerIndex)
+	{
+		UpdateOrders(LayerIndex);
+	}
+}
+
+void FMassProcessorGraphLayout::UpdateOrders(const int32 LayerIndex)
+{
+	for (int32 Order = 0; Order < Layers[LayerIndex].Num(); ++Order)
+	{
+		NodeLayouts[Layers[LayerIndex][Order]].Order = Order;
+	}
+}
+
+void FMassProcessorGraphLayout::SortLayer(const FMassProcessorGraph& Graph, const int32 LayerIndex, const bool bUseDependencies)
+{
+	TArray<int32>& Layer = Layers[LayerIndex];
+	TMap<int32, double> Barycenters;
+	for (const int32 NodeIndex : Layer)
+	{
+		const TArray<int32>& Neighbours = bUseDependencies ? Graph.Nodes[NodeIndex].Dependencies : Graph.Nodes[NodeIndex].Dependents;
+		double Sum = 0.;
+		int32 Count = 0;
+		for (const int32 NeighbourIndex : Neighbours)
+		{
+			// positions are normalized per layer so that long edges from narrow layers weigh the same
+			const int32 NeighbourLayerWidth = Layers[NodeLayouts[NeighbourIndex].Layer].Num();
+			Sum += NeighbourLayerWidth > 1 ? double(NodeLayouts[NeighbourIndex].Order) / (NeighbourLayerWidth - 1) : 0.5;
+			++Count;
+		}
+		const double OwnPosition = Layer.Num() > 1 ? double(NodeLayouts[NodeIndex].Order) / (Layer.Num() - 1) : 0.5;
+		Barycenters.Add(NodeIndex, Count ? Sum / Count : OwnPosition);
+	}
+
+	Layer.StableSort([&Barycenters](const int32 A, const int32 B) { return Barycenters.FindChecked(A) < Barycenters.FindChecked(B); });
+	UpdateOrders(LayerIndex);
+}
+
+int32 FMassProcessorGraphLayout::CountCrossings(const FMassProcessorGraph& Graph) const
+{
+	int32 Crossings = 0;
+	TArray<TPair<int32, int32>> LayerEdges;
+	for (int32 LayerIndex = 0; LayerIndex + 1 < Layers.Num(); ++LayerIndex)
+	{
+		LayerEdges.Reset();
+		for (const int32 NodeIndex : Layers[LayerIndex])
+		{
+			for (const int32 DependentIndex : Graph.Nodes[NodeIndex].Dependents)
+			{
+				if (NodeLayouts[DependentIndex].Layer == LayerIndex + 1)
+				{
+					LayerEdges.Add({ NodeLayouts[NodeIndex].Order, NodeLayouts[DependentIndex].Order });
+				}
+			}
+		}
+		for (int32 EdgeA = 0; EdgeA < LayerEdges.Num(); ++EdgeA)
+		{
+			for (int32 EdgeB = EdgeA + 1; EdgeB < LayerEdges.Num(); ++EdgeB)
+			{
+				const int64 FromDelta = LayerEdges[EdgeA].Key - LayerEdges[EdgeB].Key;
+				const int64 ToDelta = LayerEdges[EdgeA].Value - LayerEdges[EdgeB].Value;
+				Crossings += (FromDelta * ToDelta < 0) ? 1 : 0;
+			}
+		}
+	}
+	return Crossings;
+}
+
+void FMassProcessorGraphLayout::Compute(const FMassProcessorGraph& Graph)
+{
+	AssignLayers(Graph);
+
+	TArray<TArray<int32>> BestLayers = Layers;
+	int32 BestCrossings = CountCrossings(Graph);
+	for (int32 Sweep = 0; Sweep < SweepCount && BestCrossings > 0; ++Sweep)
+	{
+		const bool bDownward = (Sweep % 2) == 0;
+		if (bDownward)
+		{
+			for (int32 LayerIndex = 1; LayerIndex < Layers.Num(); ++LayerIndex)
+			{
+				SortLayer(Graph, LayerIndex, /*bUseDependencies=*/true);
+			}
+		}
+		else
+		{
+			for (int32 LayerIndex = Layers.Num() - 2; LayerIndex >= 0; --LayerIndex)
+			{
+				SortLayer(Graph, LayerIndex, /*bUseDependencies=*/false);
+			}
+		}
+
+		const int32 Crossings = CountCrossings(Graph);
+		if (Crossings < BestCrossings)
+		{
+			BestCrossings = Crossings;
+			BestLayers = Layers;
+		}
+	}
+
+	Layers = MoveTemp(BestLayers);
+	for (int32 LayerIndex = 0; LayerIndex < Layers.Num(); ++LayerIndex)
+	{
+		UpdateOrders(LayerIndex);
+		const double HalfWidth = 0.5 * (Layers[LayerIndex].Num() - 1);
+		for (const int32 NodeIndex : Layers[LayerIndex])
+		{
+			FNodeLayout& NodeLayout = NodeLayouts[NodeIndex];
+			NodeLayout.X = LayerIndex * LayerSpacing;
+			NodeLayout.Y = (NodeLayout.Order - HalfWidth) * NodeSpacing;
+		}
+	}
+}
+
+void FMassProcessorGraphLayout::ExportAnnotations(const FMassProcessorGraph& Graph, FMassPrintAnnotations& InOutAnnotations) const
+{
+	InOutAnnotations.AddNodeWriter([this, &Graph](FMassDependencyJsonWriter& Writer, const FName NodeName)
+		{
+			const int32* NodeIndex = Graph.NodeIndexMap.Find(NodeName);
+			if (NodeIndex == nullptr)
+			{
+				return;
+			}
+			const FNodeLayout& NodeLayout = NodeLayouts[*NodeIndex];
+			Writer.WriteKey(TEXT("Layout"));
+			Writer.BeginObject();
+			Writer.WriteNumberField(TEXT("Layer"), NodeLayout.Layer);
+			Writer.WriteNumberField(TEXT("Order"), NodeLayout.Order);
+			Writer.WriteNumberField(TEXT("X"), NodeLayout.X);
+			Writer.WriteNumberField(TEXT("Y"), NodeLayout.Y);
+			Writer.EndObject();
+		});
+
+	InOutAnnotations.AddRootWriter([this, &Graph](FMassDependencyJsonWriter& Writer)
+		{
+			int32 MaxLayerWidth = 0;
+			for (const TArray<int32>& Layer : Layers)
+			{
+				MaxLayerWidth = FMath::Max(MaxLayerWidth, Layer.Num());
+			}
+
+			Writer.WriteKey(TEXT("Layout"));
+			Writer.BeginObject();
+			Writer.WriteNumberField(TEXT("LayerCount"), Layers.Num());
+			Writer.WriteNumberField(TEXT("MaxLayerWidth"), MaxLayerWidth);
+			Writer.WriteNumberField(TEXT("AdjacentLayerCrossings"), CountCrossings(Graph));
+			Writer.EndObject();
+		});
+}
+
+void FMassProcessorGraphLayout::WriteDot(const FMassProcessorGraph& Graph, TConstArrayView<int32> ParentGroups, FArchive& OutArchive)
+{
+	using namespace UE::MassHelper::Private;
+	using EEdgeSource = FMassProcessorGraph::EEdgeSource;
+
+	// dot ranks by topological level on its own, clusters only group the nodes visually
+	FString Dot = TEXT("digraph MassProcessors {\n\trankdir=LR;\n\tnewrank=true;\n\tnode [fontname=\"Helvetica\"];\n");
+
+	TMultiMap<int32, int32> Children;
+	for (int32 NodeIndex = 0; NodeIndex < Graph.Nodes.Num(); ++NodeIndex)
+	{
+		Children.Add(ParentGroups.IsValidIndex(NodeIndex) ? ParentGroups[NodeIndex] : INDEX_NONE, NodeIndex);
+	}
+	WriteDotCluster(Graph, Children, INDEX_NONE, 1, Dot);
+
+	for (const TPair<TPair<int32, int32>, EEdgeSource>& Edge : Graph.Edges)
+	{
+		if (Graph.Nodes[Edge.Key.Key].Name.IsNone() || Graph.Nodes[Edge.Key.Value].Name.IsNone())
+		{
+			continue;
+		}
+		// execution order edges the solver added on top of the declared ones are drawn dashed
+		const bool bDeclared = EnumHasAnyFlags(Edge.Value, EEdgeSource::OriginalDependency);
+		Dot += FString::Printf(TEXT("\t%s -> %s%s;\n"), *DotQuote(Graph.Nodes[Edge.Key.Key].Name), *DotQuote(Graph.Nodes[Edge.Key.Value].Name)
+			, bDeclared ? TEXT("") : TEXT(" [style=dashed, color=gray40]"));
+	}
+	Dot += TEXT("}\n");
+
+	const FTCHARToUTF8 Utf8Dot(*Dot);
+	OutArchive.Serialize(const_cast<ANSICHAR*>(Utf8Dot.Get()), Utf8Dot.Length());
+}
@@ -0,0 +1,201 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+#include "MassHelper/Public/Analysis/MassProcessorScheduleSimulation.h"
+#include "MassHelper/Public/Analysis/MassProcessorGraph.h"
+#include "MassHelper/Public/Processor/MassDependencyJsonWriter.h"
+
+double FMassProcessorScheduleSimulation::FResult::GetUtilization() const
+{
+	if (WallTimeMs <= 0. || Lanes.Num() == 0)
+	{
+		return 0.;
+	}
+	double BusyMs = 0.;
+	for (const FLane& Lane : Lanes)
+	{
+		BusyMs += Lane.BusyMs;
+	}
+	return BusyMs / (WallTimeMs * Lanes.Num());
+}
+
+void FMassProcessorScheduleSimulation::Simulate(const FMassProcessorGraph& Graph, const int32 InCoreCount, FResult& OutResult)
+{
+	const int32 CoreCount = FMath::Max(1, InCoreCount);
+	const int32 NodeCount = Graph.Nodes.Num();
+
+	OutResult = FResult();
+	OutResult.CoreCount = CoreCount;
+	OutResult.Lanes.SetNum(CoreCount);
+	OutResult.Lanes[0].bIsGameThread = (CoreCount > 1);
+	OutResult.NodeLanes.Init(INDEX_NONE, NodeCount);
+	OutResult.NodeStartMs.Init(0., NodeCount);
+
+	TArray<int32> Order;
+	OutResult.bHasCycle = !Graph.GetTopologicalOrder(Order);
+	TArray<int32> OrderPosition;
+	OrderPosition.Init(MAX_int32, NodeCount);
+	for (int32 OrderIndex = 0; OrderIndex < Order.Num(); ++OrderIndex)
+	{
+		OrderPosition[Order[OrderIndex]] = OrderIndex;
+	}
+
+	TArray<int32> PendingDependencies;
+	PendingDependencies.SetNumUninitialized(NodeCount);
+	TArray<double> ReadyMs;
+	ReadyMs.Init(0., NodeCount);
+	TArray<int32> Ready;
+	for (int32 NodeIndex = 0; NodeIndex < NodeCount; ++NodeIndex)
+	{
+		PendingDependencies[NodeIndex] = Graph.Nodes[NodeIndex].Dependencies.Num();
+		if (PendingDependencies[NodeIndex] == 0)
+		{
+			Ready.Add(NodeIndex);
+		}
+	}
+
+	TArray<double> LaneFreeMs;
+	LaneFreeMs.Init(0., CoreCount);
+
+	auto CompleteNode = [&](const int32 NodeIndex, const double FinishMs)
+	{
+		OutResult.WallTimeMs = FMath::Max(OutResult.WallTimeMs, FinishMs);
+		for (const int32 DependentIndex : Graph.Nodes[NodeIndex].Dependents)
+		{
+			ReadyMs[DependentIndex] = FMath::Max(ReadyMs[DependentIndex], FinishMs);
+			if (--PendingDependencies[DependentIndex] == 0)
+			{
+				Ready.Add(DependentIndex);
+			}
+		}
+	};
+
+	auto FindLane = [&](const FMassProcessorGraph::FNode& Node) -> int32
+	{
+		if (CoreCount == 1 || Node.bRequiresGameThread)
+		{
+			return 0;
+		}
+		int32 BestLane = 1;
+		for (int32 LaneIndex = 2; LaneIndex < CoreCount; ++LaneIndex)
+		{
+			BestLane = LaneFreeMs[LaneIndex] < LaneFreeMs[BestLane] ? LaneIndex : BestLane;
+		}
+		return BestLane;
+	};
+
+	while (Ready.Num())
+	{
+		// groups only pass their dependencies on, they don't occupy any lane
+		const int32 GroupReadyIndex = Ready.IndexOfByPredicate([&Graph](const int32 NodeIndex) { return Graph.Nodes[NodeIndex].IsProcessor() == false; });
+		if (GroupReadyIndex != INDEX_NONE)
+		{
+			const int32 NodeIndex = Ready[GroupReadyIndex];
+			Ready.RemoveAtSwap(GroupReadyIndex, 1, false);
+			OutResult.NodeStartMs[NodeIndex] = ReadyMs[NodeIndex];
+			CompleteNode(NodeIndex, ReadyMs[NodeIndex]);
+			continue;
+		}
+
+		int32 BestReadyIndex = INDEX_NONE;
+		int32 BestLane = INDEX_NONE;
+		double BestStartMs = 0.;
+		for (int32 ReadyIndex = 0; ReadyIndex < Ready.Num(); ++ReadyIndex)
+		{
+			const int32 NodeIndex = Ready[ReadyIndex];
+			const int32 Lane = FindLane(Graph.Nodes[NodeIndex]);
+			const double StartMs = FMath::Max(ReadyMs[NodeIndex], LaneFreeMs[Lane]);
+			const bool bBetter = BestReadyIndex == INDEX_NONE
+				|| StartMs < BestStartMs
+				|| (StartMs == BestStartMs && ReadyMs[NodeIndex] < ReadyMs[Ready[BestReadyIndex]])
+				|| (StartMs == BestStartMs && ReadyMs[NodeIndex] == ReadyMs[Ready[BestReadyIndex]] && OrderPosition[NodeIndex] < OrderPosition[Ready[BestReadyIndex]]);
+			if (bBetter)
+			{
+				BestReadyIndex = ReadyIndex;
+				BestLane = Lane;
+				BestStartMs = StartMs;
+			}
+		}
+
+		const int32 NodeIndex = Ready[BestReadyIndex];
+		Ready.RemoveAtSwap(BestReadyIndex, 1, false);
+
+		const double EndMs = BestStartMs + Graph.Nodes[NodeIndex].CostMs;
+		LaneFreeMs[BestLane] = EndMs;
+		FLane& Lane = OutResult.Lanes[BestLane];
+		Lane.Entries.Add({ NodeIndex, BestStartMs, EndMs });
+		Lane.BusyMs += Graph.Nodes[NodeIndex].CostMs;
+		OutResult.NodeLanes[NodeIndex] = BestLane;
+		OutResult.NodeStartMs[NodeIndex] = BestStartMs;
+
+		CompleteNode(NodeIndex, EndMs);
+	}
+}
+
+void FMassProcessorScheduleSimulation::SimulateCoreCounts(const FMassProcessorGraph& Graph, const int32 MaxCoreCount, FCoreCountSweep& OutSweep)
+{
+	OutSweep.Predictions.Reset();
+	double SingleCoreMs = 0.;
+	for (int32 CoreCount = 1; CoreCount <= FMath::Max(1, MaxCoreCount); ++CoreCount)
+	{
+		FResult& Result = OutSweep.Timeline;
+		Simulate(Graph, CoreCount, Result);
+		SingleCoreMs = (CoreCount == 1) ? Result.WallTimeMs : SingleCoreMs;
+
+		FPrediction& Prediction = OutSweep.Predictions.AddDefaulted_GetRef();
+		Prediction.CoreCount = CoreCount;
+		Prediction.WallTimeMs = Result.WallTimeMs;
+		Prediction.Speedup = Result.WallTimeMs > 0. ? SingleCoreMs / Result.WallTimeMs : 1.;
+		Prediction.Utilization = Result.GetUtilization();
+	}
+}
+
+void FMassProcessorScheduleSimulation::WriteJson(FMassDependencyJsonWriter& Writer, const FMassProcessorGraph& Graph, const FCoreCountSweep& Sweep)
+{
+	const FResult& Result = Sweep.Timeline;
+
+	Writer.BeginObject();
+	Writer.WriteBoolField(TEXT("HasCycle"), Result.bHasCycle);
+	Writer.WriteKey(TEXT("Predictions"));
+	Writer.BeginArray();
+	for (const FPrediction& Prediction : Sweep.Predictions)
+	{
+		Writer.BeginObject();
+		Writer.WriteNumberField(TEXT("Cores"), Prediction.CoreCount);
+		Writer.WriteNumberField(TEXT("WallTimeMs"), Prediction.WallTimeMs);
+		Writer.WriteNumberField(TEXT("Speedup"), Prediction.Speedup);
+		Writer.WriteNumberField(TEXT("Utilization"), Prediction.Utilization);
+		Writer.EndObject();
+	}
+	Writer.EndArray();
+
+	// Gantt-style timeline of the largest configuration
+	Writer.WriteKey(TEXT("Timeline"));
+	Writer.BeginObject();
+	Writer.WriteNumberField(TEXT("Cores"), Result.CoreCount);
+	Writer.WriteNumberField(TEXT("WallTimeMs"), Result.WallTimeMs);
+	Writer.WriteKey(TEXT("Lanes"));
+	Writer.BeginArray();
+	for (int32 LaneIndex = 0; LaneIndex < Result.Lanes.Num(); ++LaneIndex)
+	{
+		const FLane& Lane = Result.Lanes[LaneIndex];
+		Writer.BeginObject();
+		Writer.WriteNumberField(TEXT("Lane"), LaneIndex);
+		Writer.WriteBoolField(TEXT("GameThread"), Lane.bIsGameThread);
+		Writer.WriteNumberField(TEXT("BusyMs"), Lane.BusyMs);
+		Writer.WriteKey(TEXT("Entries"));
+		Writer.BeginArray();
+		for (const FLaneEntry& Entry : Lane.Entries)
+		{
+			Writer.BeginObject();
+			Writer.WriteNameField(TEXT("NodeName"), Graph.Nodes[Entry.NodeIndex].Name);
+			Writer.WriteNumberField(TEXT("StartMs"), Entry.StartMs);
+			Writer.WriteNumberField(TEXT("EndMs"), Entry.EndMs);
+			Writer.EndObject();
+		}
+		Writer.EndArray();
+		Writer.EndObject();
+	}
+	Writer.EndArray();
+	Writer.EndObject();
+
+	Writer.EndObject();
+}
@@ -0,0 +1,300 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+#include "MassHelper/Public/Benchmark/MassBenchmarkReport.h"
+#include "MassHelper/Public/Processor/MassDependencyJsonWriter.h"
+
+#include "MassEntity/Public/MassEntityTypes.h"
+
+#include "Json/Public/Dom/JsonObject.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+
+namespace UE::MassHelper::Private
+{
+	void WriteTimingStats(FMassDependencyJsonWriter& Writer, const FMassBenchmarkReport::FTimingStats& Stats)
+	{
+		Writer.BeginObject();
+		Writer.WriteNumberField(TEXT("Samples"), Stats.SampleCount);
+		Writer.WriteNumberField(TEXT("AvgMs"), Stats.AvgMs);
+		Writer.WriteNumberField(TEXT("P95Ms"), Stats.P95Ms);
+		Writer.WriteNumberField(TEXT("MaxMs"), Stats.MaxMs);
+		Writer.EndObject();
+	}
+
+	/** Hand edited baselines can hold anything, entries that aren't objects are skipped. */
+	bool IsJsonObject(const TSharedPtr<FJsonValue>& Value)
+	{
+		return Value.IsValid() && Value->Type == EJson::Object && Value->AsObject().IsValid();
+	}
+
+	FMassBenchmarkReport::FTimingStats ReadTimingStats(const FJsonObject& Object)
+	{
+		FMassBenchmarkReport::FTimingStats Stats;
+		Object.TryGetNumberField(TEXT("Samples"), Stats.SampleCount);
+		Object.TryGetNumberField(TEXT("AvgMs"), Stats.AvgMs);
+		Object.TryGetNumberField(TEXT("P95Ms"), Stats.P95Ms);
+		Object.TryGetNumberField(TEXT("MaxMs"), Stats.MaxMs);
+		return Stats;
+	}
+
+	void CheckRegression(const FString& Run, const FString& Metric, const FMassBenchmarkReport::FTimingStats* Baseline, const FMassBenchmarkReport::FTimingStats& Current
+		, const double Tolerance, const double MinDeltaMs, TArray<FMassBenchmarkReport::FRegression>& OutRegressions)
+	{
+		if (Baseline == nullptr || Baseline->SampleCount == 0)
+		{
+			return;
+		}
+		if (Current.AvgMs > Baseline->AvgMs * (1. + Tolerance) && Current.AvgMs - Baseline->AvgMs > MinDeltaMs)
+		{
+			OutRegressions.Add({ Run, Metric, Baseline->AvgMs, Current.AvgMs });
+		}
+	}
+}
+
+FMassBenchmarkReport::FTimingStats FMassBenchmarkReport::FTimingStats::FromSamples(TArray<double> SamplesMs)
+{
+	FTimingStats Stats;
+	if (SamplesMs.Num() == 0)
+	{
+		return Stats;
+	}
+
+	SamplesMs.Sort();
+	double TotalMs = 0.;
+	for (const double Ms : SamplesMs)
+	{
+		TotalMs += Ms;
+	}
+	Stats.SampleCount = SamplesMs.Num();
+	Stats.AvgMs = TotalMs / SamplesMs.Num();
+	Stats.P95Ms = SamplesMs[FMath::Clamp(FMath::CeilToInt32(0.95 * SamplesMs.Num()) - 1, 0, SamplesMs.Num() - 1)];
+	Stats.MaxMs = SamplesMs.Last();
+	return Stats;
+}
+
+void FMassBenchmarkReport::Compare(const FMassBenchmarkReport& Baseline, const double Tolerance, const double MinDeltaMs, TArray<FRegression>& OutRegressions) const
+{
+	using namespace UE::MassHelper::Private;
+
+	for (const FRun& Run : Runs)
+	{
+		const FRun* BaselineRun = Baseline.Runs.FindByPredicate([&Run](const FRun& Other) { return Other.Name == Run.Name; });
+		if (BaselineRun == nullptr)
+		{
+			continue;
+		}
+
+		CheckRegression(Run.Name, TEXT("Frame"), &BaselineRun->Frame, Run.Frame, Tolerance, MinDeltaMs, OutRegressions);
+		for (const TPair<FString, FTimingStats>& It : Run.Phases)
+		{
+			CheckRegression(Run.Name, TEXT("Phase.") + It.Key, BaselineRun->Phases.Find(It.Key), It.Value, Tolerance, MinDeltaMs, OutRegressions);
+		}
+		for (const TPair<FName, FTimingStats>& It : Run.Processors)
+		{
+			CheckRegression(Run.Name, TEXT("Processor.") + It.Key.ToString(), BaselineRun->Processors.Find(It.Key), It.Value, Tolerance, MinDeltaMs, OutRegressions);
+		}
+	}
+}
+
+void FMassBenchmarkReport::Write(FArchive& OutArchive, TConstArrayView<FRegression> Regressions) const
+{
+	using namespace UE::MassHelper::Private;
+
+	FMassDependencyJsonWriter Writer(OutArchive);
+	Writer.BeginObject();
+	Writer.WriteStringField(TEXT("Benchmark"), Benchmark);
+
+	Writer.WriteKey(TEXT("Settings"));
+	Writer.BeginObject();
+	for (const TPair<FString, FString>& It : Settings)
+	{
+		Writer.WriteStringField(It.Key, It.Value);
+	}
+	Writer.EndObject();
+
+	Writer.WriteKey(TEXT("Runs"));
+	Writer.BeginArray();
+	for (const FRun& Run : Runs)
+	{
+		Writer.BeginObject();
+		Writer.WriteStringField(TEXT("Name"), Run.Name);
+		Writer.WriteNumberField(TEXT("EntityCount"), Run.EntityCount);
+		Writer.WriteKey(TEXT("Frame"));
+		WriteTimingStats(Writer, Run.Frame);
+
+		Writer.WriteKey(TEXT("Phases"));
+		Writer.BeginObject();
+		for (const TPair<FString, FTimingStats>& It : Run.Phases)
+		{
+			Writer.WriteKey(It.Key);
+			WriteTimingStats(Writer, It.Value);
+		}
+		Writer.EndObject();
+
+		Writer.WriteKey(TEXT("Processors"));
+		Writer.BeginObject();
+		for (const TPair<FName, FTimingStats>& It : Run.Processors)
+		{
+			Writer.WriteKey(It.Key.ToString());
+			WriteTimingStats(Writer, It.Value);
+		}
+		Writer.EndObject();
+
+		if (Run.Extra.Num())
+		{
+			Writer.WriteKey(TEXT("Extra"));
+			Writer.BeginObject();
+			for (const TPair<FString, double>& It : Run.Extra)
+			{
+				Writer.WriteNumberField(It.Key, It.Value);
+			}
+			Writer.EndObject();
+		}
+		Writer.EndObject();
+	}
+	Writer.EndArray();
+
+	Writer.WriteKey(TEXT("Regressions"));
+	Writer.BeginArray();
+	for (const FRegression& Regression : Regressions)
+	{
+		Writer.BeginObject();
+		Writer.WriteStringField(TEXT("Run"), Regression.Run);
+		Writer.WriteStringField(TEXT("Metric"), Regression.Metric);
+		Writer.WriteNumberField(TEXT("BaselineMs"), Regression.BaselineMs);
+		Writer.WriteNumberField(TEXT("CurrentMs"), Regression.CurrentMs);
+		Writer.EndObject();
+	}
+	Writer.EndArray();
+	Writer.EndObject();
+}
+
+bool FMassBenchmarkReport::LoadFromFile(const FString& FileName)
+{
+	using namespace UE::MassHelper::Private;
+
+	FString JsonString;
+	if (FFileHelper::LoadFileToString(JsonString, *FileName) == false)
+	{
+		UE_LOG(LogMass, Error, TEXT("%s unable to read %s"), ANSI_TO_TCHAR(__FUNCTION__), *FileName);
+		return false;
+	}
+
+	TSharedPtr<FJsonObject> RootJson;
+	if (FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(JsonString), RootJson) == false || RootJson.IsValid() == false)
+	{
+		UE_LOG(LogMass, Error, TEXT("%s %s is not valid json"), ANSI_TO_TCHAR(__FUNCTION__), *FileName);
+		return false;
+	}
+
+	RootJson->TryGetStringField(TEXT("Benchmark"), Benchmark);
+	const TSharedPtr<FJsonObject>* SettingsJson = nullptr;
+	if (RootJson->TryGetObjectField(TEXT("Settings"), SettingsJson))
+	{
+		for (const TPair<FString, TSharedPtr<FJsonValue>>& It : (*SettingsJson)->Values)
+		{
+			Settings.Add(It.Key, It.Value->AsString());
+		}
+	}
+
+	const TArray<TSharedPtr<FJsonValue>>* RunsJson = nullptr;
+	if (RootJson->TryGetArrayField(TEXT("Runs"), RunsJson))
+	{
+		for (const TSharedPtr<FJsonValue>& RunValue : *RunsJson)
+		{
+			if (IsJsonObject(RunValue) == false)
+			{
+				continue;
+			}
+			const TSharedPtr<FJsonObject>& RunJson = RunValue->AsObject();
+
+			FRun& Run = Runs.AddDefaulted_GetRef();
+			RunJson->TryGetStringField(TEXT("Name"), Run.Name);
+			RunJson->TryGetNumberField(TEXT("EntityCount"), Run.EntityCount);
+			const TSharedPtr<FJsonObject>* ObjectJson = nullptr;
+			if (RunJson->TryGetObjectField(TEXT("Frame"), ObjectJson))
+			{
+				Run.Frame = ReadTimingStats(**ObjectJson);
+			}
+			if (RunJson->TryGetObjectField(TEXT("Phases"), ObjectJson))
+			{
+				for (const TPair<FString, TSharedPtr<FJsonValue>>& It : (*ObjectJson)->Values)
+				{
+					if (IsJsonObject(It.Value))
+					{
+						Run.Phases.Add(It.Key, ReadTimingStats(*It.Value->AsObject()));
+					}
+				}
+			}
+			if (RunJson->TryGetObjectField(TEXT("Processors"), ObjectJson))
+			{
+				for (const TPair<FString, TSharedPtr<FJsonValue>>& It : (*ObjectJson)->Values)
+				{
+					if (IsJsonObject(It.Value))
+					{
+						Run.Processors.Add(FName(*It.Key), ReadTimingStats(*It.Value->AsObject()));
+					}
+				}
+			}
+			if (RunJson->TryGetObjectField(TEXT("Extra"), ObjectJson))
+			{
+				for (const TPair<FString, TSharedPtr<FJsonValue>>& It : (*ObjectJson)->Values)
+				{
+					Run.Extra.Add(It.Key, It.Value->AsNumber());
+				}
+			}
+		}
+	}
+	return true;
+}
+
+int32 FMassBenchmarkReport::SaveAndCompare(const TCHAR* Params, const FString& DefaultFileName) const
+{
+	TArray<FRegression> Regressions;
+	FString BaselineFileName;
+	if (FParse::Value(Params, TEXT("Baseline="), BaselineFileName))
+	{
+		double Tolerance = 0.1;
+		double MinDeltaMs = 0.05;
+		FParse::Value(Params, TEXT("Tolerance="), Tolerance);
+		FParse::Value(Params, TEXT("MinDeltaMs="), MinDeltaMs);
+
+		FMassBenchmarkReport Baseline;
+		if (Baseline.LoadFromFile(BaselineFileName) == false)
+		{
+			return 1;
+		}
+		if (Baseline.Benchmark != Benchmark)
+		{
+			UE_LOG(LogMass, Warning, TEXT("%s baseline %s was recorded by benchmark '%s', not '%s'")
+				, ANSI_TO_TCHAR(__FUNCTION__), *BaselineFileName, *Baseline.Benchmark, *Benchmark);
+		}
+		Compare(Baseline, Tolerance, MinDeltaMs, Regressions);
+		for (const FRegression& Regression : Regressions)
+		{
+			UE_LOG(LogMass, Warning, TEXT("Regression [%s] %s: %.3fms -> %.3fms (%+.1f%%)"), *Regression.Run, *Regression.Metric
+				, Regression.BaselineMs, Regression.CurrentMs, 100. * (Regression.CurrentMs / Regression.BaselineMs - 1.));
+		}
+		UE_LOG(LogMass, Display, TEXT("%d regression(s) against %s"), Regressions.Num(), *BaselineFileName);
+	}
+
+	FString OutFileName;
+	if (FParse::Value(Params, TEXT("Out="), OutFileName) == false)
+	{
+		OutFileName = FPaths::ProjectSavedDir() / TEXT("MassBenchmark") / DefaultFileName;
+	}
+
+	TArray<uint8> ReportBytes;
+	FMemoryWriter ReportWriter(ReportBytes);
+	Write(ReportWriter, Regressions);
+	if (FFileHelper::SaveArrayToFile(ReportBytes, *OutFileName) == false)
+	{
+		UE_LOG(LogMass, Error, TEXT("%s unable to write %s"), ANSI_TO_TCHAR(__FUNCTION__), *OutFileName);
+		return 1;
+	}
+	UE_LOG(LogMass, Display, TEXT("Benchmark report written to %s"), *FPaths::ConvertRelativePathToFull(OutFileName));
+
+	return Regressions.Num() ? 2 : 0;
+}
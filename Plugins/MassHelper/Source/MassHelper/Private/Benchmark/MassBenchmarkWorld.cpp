@@ -0,0 +1,186 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+#include "MassHelper/Public/Benchmark/MassBenchmarkWorld.h"
+
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "Containers/Ticker.h"
+#include "HAL/IConsoleManager.h"
+#include "MassEntity/Public/MassEntitySubsystem.h"
+#include "MassEntity/Public/MassEntityManager.h"
+#include "MassEntityConfigAsset.h"
+#include "MassSpawnerSubsystem.h"
+#include "MassSpawnerTypes.h"
+#include "MassSpawnLocationProcessor.h"
+#include "UObject/Package.h"
+
+FMassBenchmarkWorld::~FMassBenchmarkWorld()
+{
+	Destroy();
+}
+
+bool FMassBenchmarkWorld::Create(const FString& MapPath)
+{
+	check(World == nullptr);
+
+	// the benchmarks time the phases through FMassProcessorProfiler, which only hears from profiled phases
+	if (IConsoleVariable* ProfiledPhasesCVar = IConsoleManager::Get().FindConsoleVariable(TEXT("mass.helper.ProfiledPhases")))
+	{
+		ProfiledPhasesCVar->Set(true, ECVF_SetByCode);
+	}
+
+	if (MapPath.IsEmpty())
+	{
+		World = UWorld::CreateWorld(EWorldType::Game, /*bInformEngineOfWorld=*/false);
+	}
+	else
+	{
+		UPackage* MapPackage = LoadPackage(nullptr, *MapPath, LOAD_None);
+		World = MapPackage ? UWorld::FindWorldInPackage(MapPackage) : nullptr;
+		if (World == nullptr)
+		{
+			UE_LOG(LogMass, Error, TEXT("%s unable to load map %s"), ANSI_TO_TCHAR(__FUNCTION__), *MapPath);
+			return false;
+		}
+		World->WorldType = EWorldType::Game;
+		World->InitWorld();
+	}
+	World->AddToRoot();
+
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+
+	World->UpdateWorldComponents(/*bRerunConstructionScripts=*/true, /*bCurrentLevelOnly=*/false);
+	World->InitializeActorsForPlay(FURL());
+	// the Mass simulation subsystem starts ticking the processing phases on world begin play
+	World->BeginPlay();
+	return true;
+}
+
+void FMassBenchmarkWorld::Destroy()
+{
+	EntityConfigs.Reset();
+	if (World == nullptr)
+	{
+		return;
+	}
+
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(/*bInformEngineOfWorld=*/false);
+	World->RemoveFromRoot();
+	World = nullptr;
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+}
+
+bool FMassBenchmarkWorld::LoadEntityConfigs(const FString& ConfigPaths)
+{
+	TArray<FString> Paths;
+	ConfigPaths.ParseIntoArray(Paths, TEXT(","));
+	for (const FString& Path : Paths)
+	{
+		UMassEntityConfigAsset* Config = LoadObject<UMassEntityConfigAsset>(nullptr, *Path.TrimStartAndEnd());
+		if (Config == nullptr)
+		{
+			UE_LOG(LogMass, Error, TEXT("%s unable to load entity config %s"), ANSI_TO_TCHAR(__FUNCTION__), *Path);
+			return false;
+		}
+		EntityConfigs.Emplace(Config);
+	}
+	return EntityConfigs.Num() > 0;
+}
+
+void FMassBenchmarkWorld::SpawnEntities(const int32 Count, const float SpawnRadius, TArray<FMassEntityHandle>& OutEntities)
+{
+	UMassSpawnerSubsystem* SpawnerSubsystem = UWorld::GetSubsystem<UMassSpawnerSubsystem>(World);
+	if (SpawnerSubsystem == nullptr || EntityConfigs.Num() == 0 || Count <= 0)
+	{
+		return;
+	}
+
+	for (int32 ConfigIndex = 0; ConfigIndex < EntityConfigs.Num(); ++ConfigIndex)
+	{
+		// spread the remainder over the first configs
+		const int32 ConfigCount = Count / EntityConfigs.Num() + (ConfigIndex < Count % EntityConfigs.Num() ? 1 : 0);
+		if (ConfigCount == 0)
+		{
+			continue;
+		}
+
+		const FMassEntityTemplate& EntityTemplate = EntityConfigs[ConfigIndex]->GetConfig().GetOrCreateEntityTemplate(*World);
+		if (EntityTemplate.IsValid() == false)
+		{
+			continue;
+		}
+
+		FInstancedStruct SpawnData;
+		SpawnData.InitializeAs<FMassTransformsSpawnData>();
+		FMassTransformsSpawnData& Transforms = SpawnData.GetMutable<FMassTransformsSpawnData>();
+		Transforms.Transforms.Reserve(ConfigCount);
+		for (int32 Index = 0; Index < ConfigCount; ++Index)
+		{
+			const FVector2D Offset = FVector2D(RandomStream.VRand()) * SpawnRadius;
+			Transforms.Transforms.Add(FTransform(FRotator(0., RandomStream.FRandRange(0., 360.), 0.), FVector(Offset.X, Offset.Y, 0.)));
+		}
+
+		TArray<FMassEntityHandle> SpawnedEntities;
+		SpawnerSubsystem->SpawnEntities(EntityTemplate.GetTemplateID(), ConfigCount, SpawnData, UMassSpawnLocationProcessor::StaticClass(), SpawnedEntities);
+		OutEntities.Append(SpawnedEntities);
+	}
+}
+
+void FMassBenchmarkWorld::DestroyEntities(TArray<FMassEntityHandle>& InOutEntities)
+{
+	if (UMassSpawnerSubsystem* SpawnerSubsystem = UWorld::GetSubsystem<UMassSpawnerSubsystem>(World))
+	{
+		SpawnerSubsystem->DestroyEntities(InOutEntities);
+	}
+	InOutEntities.Reset();
+}
+
+void FMassBenchmarkWorld::BatchCreateEntities(const int32 Count, TArray<FMassEntityHandle>& OutEntities)
+{
+	FMassEntityManager* EntityManager = GetEntityManager();
+	if (EntityManager == nullptr || EntityConfigs.Num() == 0 || Count <= 0)
+	{
+		return;
+	}
+
+	for (int32 ConfigIndex = 0; ConfigIndex < EntityConfigs.Num(); ++ConfigIndex)
+	{
+		const int32 ConfigCount = Count / EntityConfigs.Num() + (ConfigIndex < Count % EntityConfigs.Num() ? 1 : 0);
+		const FMassEntityTemplate& EntityTemplate = EntityConfigs[ConfigIndex]->GetConfig().GetOrCreateEntityTemplate(*World);
+		if (ConfigCount == 0 || EntityTemplate.IsValid() == false)
+		{
+			continue;
+		}
+		// the creation context notifies the observers when it goes out of scope
+		EntityManager->BatchCreateEntities(EntityTemplate.GetArchetype(), EntityTemplate.GetSharedFragmentValues(), ConfigCount, OutEntities);
+	}
+}
+
+void FMassBenchmarkWorld::BatchDestroyEntities(TArray<FMassEntityHandle>& InOutEntities)
+{
+	if (FMassEntityManager* EntityManager = GetEntityManager())
+	{
+		EntityManager->BatchDestroyEntities(InOutEntities);
+	}
+	InOutEntities.Reset();
+}
+
+double FMassBenchmarkWorld::Tick(const float DeltaSeconds)
+{
+	const uint64 BeginCycles = FPlatformTime::Cycles64();
+	World->Tick(LEVELTICK_All, DeltaSeconds);
+	// game thread tasks queued by the phases, e.g. the capture completions
+	FTaskGraphInterface::Get().ProcessThreadUntilIdle(ENamedThreads::GameThread);
+	FTSTicker::GetCoreTicker().Tick(DeltaSeconds);
+	const uint64 EndCycles = FPlatformTime::Cycles64();
+
+	++GFrameCounter;
+	return FPlatformTime::ToMilliseconds64(EndCycles - BeginCycles);
+}
+
+FMassEntityManager* FMassBenchmarkWorld::GetEntityManager() const
+{
+	UMassEntitySubsystem* EntitySubsystem = World ? UWorld::GetSubsystem<UMassEntitySubsystem>(World) : nullptr;
+	return EntitySubsystem ? &EntitySubsystem->GetMutableEntityManager() : nullptr;
+}
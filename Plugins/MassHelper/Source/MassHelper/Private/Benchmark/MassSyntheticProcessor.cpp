@@ -0,0 +1,139 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+#include "MassHelper/Public/Benchmark/MassSyntheticProcessor.h"
+
+#include "MassEntity/Public/MassEntityTypes.h"
+#include "UObject/UObjectIterator.h"
+
+namespace UE::MassHelper::Private
+{
+	void GatherStructsDerivedFrom(const UScriptStruct& BaseStruct, TArray<const UScriptStruct*>& OutStructs)
+	{
+		for (TObjectIterator<UScriptStruct> It; It; ++It)
+		{
+			if (*It != &BaseStruct && It->IsChildOf(&BaseStruct))
+			{
+				OutStructs.Add(*It);
+			}
+		}
+		// object iteration order depends on load order, the seed alone should decide the generated set
+		OutStructs.Sort([](const UScriptStruct& A, const UScriptStruct& B) { return A.GetFName().LexicalLess(B.GetFName()); });
+	}
+
+	void PickDistinct(const FRandomStream& Random, TConstArrayView<const UScriptStruct*> Pool, const int32 Count, TArray<const UScriptStruct*>& OutPicked)
+	{
+		for (int32 Attempt = 0; Pool.Num() && OutPicked.Num() < Count && Attempt < Count * 4; ++Attempt)
+		{
+			OutPicked.AddUnique(Pool[Random.RandHelper(Pool.Num())]);
+		}
+	}
+}
+
+UMassSyntheticProcessor::UMassSyntheticProcessor()
+	: EntityQuery(*this)
+{
+	bAutoRegisterWithProcessingPhases = false;
+	bAllowMultipleInstances = true;
+	ExecutionFlags = int32(EProcessorExecutionFlags::All);
+}
+
+void UMassSyntheticProcessor::Configure(const FMassProcessorExecutionOrder& InExecutionOrder, TConstArrayView<const UScriptStruct*> ReadOnlyFragments
+	, TConstArrayView<const UScriptStruct*> ReadWriteFragments, TConstArrayView<const UScriptStruct*> RequiredTags, TConstArrayView<const UScriptStruct*> ExcludedTags)
+{
+	ExecutionOrder = InExecutionOrder;
+	for (const UScriptStruct* FragmentType : ReadOnlyFragments)
+	{
+		EntityQuery.AddRequirement(FragmentType, EMassFragmentAccess::ReadOnly);
+	}
+	for (const UScriptStruct* FragmentType : ReadWriteFragments)
+	{
+		EntityQuery.AddRequirement(FragmentType, EMassFragmentAccess::ReadWrite);
+	}
+	for (const UScriptStruct* TagType : RequiredTags)
+	{
+		EntityQuery.AddTagRequirement(*TagType, EMassFragmentPresence::All);
+	}
+	for (const UScriptStruct* TagType : ExcludedTags)
+	{
+		EntityQuery.AddTagRequirement(*TagType, EMassFragmentPresence::None);
+	}
+}
+
+FName FMassSyntheticProcessorGenerator::GetNodeName(TConstArrayView<UMassProcessor*> Processors, const int32 Index)
+{
+	return Index == 0 ? Processors[Index]->GetClass()->GetFName() : Processors[Index]->GetFName();
+}
+
+void FMassSyntheticProcessorGenerator::Generate(UObject& Outer, const int32 Count, TArray<UMassProcessor*>& OutProcessors) const
+{
+	using namespace UE::MassHelper::Private;
+
+	TArray<const UScriptStruct*> FragmentTypes;
+	TArray<const UScriptStruct*> TagTypes;
+	GatherStructsDerivedFrom(*FMassFragment::StaticStruct(), FragmentTypes);
+	GatherStructsDerivedFrom(*FMassTag::StaticStruct(), TagTypes);
+	checkf(FragmentTypes.Num() > 0, TEXT("No fragment types loaded, synthetic processors need at least one requirement."));
+
+	// all processors exist before any is configured, edges can name processors generated later
+	const int32 FirstIndex = OutProcessors.Num();
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		OutProcessors.Add(NewObject<UMassSyntheticProcessor>(&Outer, MakeUniqueObjectName(&Outer, UMassSyntheticProcessor::StaticClass())));
+	}
+	const TConstArrayView<UMassProcessor*> Generated = MakeArrayView(OutProcessors).Slice(FirstIndex, Count);
+
+	const FRandomStream Random(Seed);
+	TArray<const UScriptStruct*> ReadOnlyFragments;
+	TArray<const UScriptStruct*> ReadWriteFragments;
+	TArray<const UScriptStruct*> RequiredTags;
+	TArray<const UScriptStruct*> ExcludedTags;
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		FMassProcessorExecutionOrder ExecutionOrder;
+
+		const int32 GroupDepth = Random.RandRange(0, MaxGroupDepth);
+		FString GroupPath;
+		for (int32 Level = 0; Level < GroupDepth; ++Level)
+		{
+			GroupPath += FString::Printf(TEXT("%sGroup%d_%d"), Level ? TEXT(".") : TEXT(""), Level, Random.RandHelper(FMath::Max(1, GroupFanout)));
+		}
+		ExecutionOrder.ExecuteInGroup = GroupPath.IsEmpty() ? NAME_None : FName(*GroupPath);
+
+		for (int32 Edge = 0; Edge < EdgesPerProcessor && Count > 1; ++Edge)
+		{
+			const int32 OtherIndex = Random.RandHelper(Count);
+			if (OtherIndex < Index)
+			{
+				ExecutionOrder.ExecuteAfter.AddUnique(GetNodeName(Generated, OtherIndex));
+			}
+			else if (OtherIndex > Index)
+			{
+				ExecutionOrder.ExecuteBefore.AddUnique(GetNodeName(Generated, OtherIndex));
+			}
+		}
+
+		ReadOnlyFragments.Reset();
+		ReadWriteFragments.Reset();
+		RequiredTags.Reset();
+		ExcludedTags.Reset();
+		PickDistinct(Random, FragmentTypes, FMath::Max(1, FragmentsPerProcessor), ReadOnlyFragments);
+		for (int32 FragmentIndex = ReadOnlyFragments.Num() - 1; FragmentIndex >= 0; --FragmentIndex)
+		{
+			if (Random.FRand() < 0.4f)
+			{
+				ReadWriteFragments.Add(ReadOnlyFragments[FragmentIndex]);
+				ReadOnlyFragments.RemoveAtSwap(FragmentIndex);
+			}
+		}
+		PickDistinct(Random, TagTypes, TagsPerProcessor, RequiredTags);
+		for (int32 TagIndex = RequiredTags.Num() - 1; TagIndex >= 0; --TagIndex)
+		{
+			if (Random.FRand() < 0.3f)
+			{
+				ExcludedTags.Add(RequiredTags[TagIndex]);
+				RequiredTags.RemoveAtSwap(TagIndex);
+			}
+		}
+
+		CastChecked<UMassSyntheticProcessor>(Generated[Index])->Configure(ExecutionOrder, ReadOnlyFragments, ReadWriteFragments, RequiredTags, ExcludedTags);
+	}
+}
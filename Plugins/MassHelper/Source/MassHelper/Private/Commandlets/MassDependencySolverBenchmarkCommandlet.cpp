@@ -0,0 +1,149 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+#include "MassHelper/Public/Commandlets/MassDependencySolverBenchmarkCommandlet.h"
+#include "MassHelper/Public/Benchmark/MassBenchmarkReport.h"
+#include "MassHelper/Public/Benchmark/MassSyntheticProcessor.h"
+#include "MassHelper/Public/Processor/MassProcessorDependencyPrinter.h"
+
+#include "Serialization/MemoryWriter.h"
+#include "UObject/Package.h"
+
+UMassDependencySolverBenchmarkCommandlet::UMassDependencySolverBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UMassDependencySolverBenchmarkCommandlet::Main(const FString& Params)
+{
+	FString CountsString = TEXT("250,500,1000,2000,4000,8000");
+	int32 RepeatCount = 5;
+	FMassSyntheticProcessorGenerator Generator;
+	FParse::Value(*Params, TEXT("Counts="), CountsString, /*bShouldStopOnSeparator=*/false);
+	FParse::Value(*Params, TEXT("Repeat="), RepeatCount);
+	FParse::Value(*Params, TEXT("Seed="), Generator.Seed);
+	FParse::Value(*Params, TEXT("MaxGroupDepth="), Generator.MaxGroupDepth);
+	FParse::Value(*Params, TEXT("GroupFanout="), Generator.GroupFanout);
+	FParse::Value(*Params, TEXT("EdgesPerProcessor="), Generator.EdgesPerProcessor);
+	FParse::Value(*Params, TEXT("FragmentsPerProcessor="), Generator.FragmentsPerProcessor);
+	FParse::Value(*Params, TEXT("TagsPerProcessor="), Generator.TagsPerProcessor);
+	RepeatCount = FMath::Max(1, RepeatCount);
+
+	TArray<FString> CountStrings;
+	CountsString.ParseIntoArray(CountStrings, TEXT(","));
+
+	FMassBenchmarkReport Report;
+	Report.Benchmark = TEXT("DependencySolver");
+	Report.Settings.Add(TEXT("Repeat"), FString::FromInt(RepeatCount));
+	Report.Settings.Add(TEXT("Seed"), FString::FromInt(Generator.Seed));
+	Report.Settings.Add(TEXT("MaxGroupDepth"), FString::FromInt(Generator.MaxGroupDepth));
+	Report.Settings.Add(TEXT("GroupFanout"), FString::FromInt(Generator.GroupFanout));
+	Report.Settings.Add(TEXT("EdgesPerProcessor"), FString::FromInt(Generator.EdgesPerProcessor));
+	Report.Settings.Add(TEXT("FragmentsPerProcessor"), FString::FromInt(Generator.FragmentsPerProcessor));
+	Report.Settings.Add(TEXT("TagsPerProcessor"), FString::FromInt(Generator.TagsPerProcessor));
+
+	for (const FString& CountString : CountStrings)
+	{
+		const int32 ProcessorCount = FCString::Atoi(*CountString);
+		if (ProcessorCount <= 0)
+		{
+			continue;
+		}
+
+		TArray<UMassProcessor*> Processors;
+		Generator.Generate(*GetTransientPackage(), ProcessorCount, Processors);
+
+		TMap<FString, TArray<double>> StepSamplesMs;
+		SIZE_T GroupTreeBytes = 0;
+		SIZE_T SolverBytes = 0;
+		int64 GroupTreeJsonBytes = 0;
+		int64 DependencyJsonBytes = 0;
+		int32 SortedProcessorCount = 0;
+		const FPlatformMemoryStats StatsBefore = FPlatformMemory::GetStats();
+		// sampled after each step while its solver is still alive, allocations freed within a step are missed
+		uint64 UsedPhysicalMax = StatsBefore.UsedPhysical;
+
+		for (int32 Repeat = 0; Repeat < RepeatCount; ++Repeat)
+		{
+			TArray<uint8> JsonBytes;
+			{
+				FMassProcessorDependencySolverPrinterImpl Solver(Processors, /*bIsGameRuntime=*/false);
+				uint64 BeginCycles = FPlatformTime::Cycles64();
+				Solver.ResolveExecutesGroupTree(nullptr, nullptr);
+				StepSamplesMs.FindOrAdd(TEXT("ResolveExecutesGroupTree")).Add(FMassBenchmarkReport::MillisecondsSince(BeginCycles));
+
+				FMemoryWriter JsonWriter(JsonBytes);
+				BeginCycles = FPlatformTime::Cycles64();
+				Solver.PrintExecutesGroupTree(JsonWriter);
+				StepSamplesMs.FindOrAdd(TEXT("PrintExecutesGroupTree")).Add(FMassBenchmarkReport::MillisecondsSince(BeginCycles));
+
+				GroupTreeBytes = Solver.GetAllocatedSize();
+				GroupTreeJsonBytes = JsonBytes.Num();
+				UsedPhysicalMax = FMath::Max<uint64>(UsedPhysicalMax, FPlatformMemory::GetStats().UsedPhysical);
+			}
+
+			JsonBytes.Reset();
+			{
+				TArray<FMassProcessorOrderInfo> SortedProcessors;
+				FMassProcessorDependencySolverPrinterImpl Solver(Processors, /*bIsGameRuntime=*/false);
+				uint64 BeginCycles = FPlatformTime::Cycles64();
+				Solver.ResolveDependencies(SortedProcessors, nullptr, nullptr);
+				StepSamplesMs.FindOrAdd(TEXT("ResolveDependencies")).Add(FMassBenchmarkReport::MillisecondsSince(BeginCycles));
+
+				FMemoryWriter JsonWriter(JsonBytes);
+				BeginCycles = FPlatformTime::Cycles64();
+				Solver.PrintCompletelyDependency(JsonWriter);
+				StepSamplesMs.FindOrAdd(TEXT("PrintCompletelyDependency")).Add(FMassBenchmarkReport::MillisecondsSince(BeginCycles));
+
+				SolverBytes = Solver.GetAllocatedSize();
+				DependencyJsonBytes = JsonBytes.Num();
+				SortedProcessorCount = SortedProcessors.Num();
+				UsedPhysicalMax = FMath::Max<uint64>(UsedPhysicalMax, FPlatformMemory::GetStats().UsedPhysical);
+			}
+		}
+
+		FMassBenchmarkReport::FRun& Run = Report.Runs.AddDefaulted_GetRef();
+		Run.Name = FString::FromInt(ProcessorCount);
+		// the timed steps take the place of the processing phases
+		for (TPair<FString, TArray<double>>& It : StepSamplesMs)
+		{
+			Run.Phases.Add(It.Key, FMassBenchmarkReport::FTimingStats::FromSamples(MoveTemp(It.Value)));
+		}
+		Run.Extra.Add(TEXT("ProcessorCount"), ProcessorCount);
+		Run.Extra.Add(TEXT("SortedProcessorCount"), SortedProcessorCount);
+		Run.Extra.Add(TEXT("GroupTreeNodeBytes"), double(GroupTreeBytes));
+		Run.Extra.Add(TEXT("SolverNodeBytes"), double(SolverBytes));
+		Run.Extra.Add(TEXT("GroupTreeJsonBytes"), double(GroupTreeJsonBytes));
+		Run.Extra.Add(TEXT("DependencyJsonBytes"), double(DependencyJsonBytes));
+		Run.Extra.Add(TEXT("MaxStepUsedPhysicalDeltaBytes"), double(UsedPhysicalMax - StatsBefore.UsedPhysical));
+		// the process high water mark only moves when this run went above every earlier one
+		Run.Extra.Add(TEXT("PeakUsedPhysicalGrowthBytes"), double(FPlatformMemory::GetStats().PeakUsedPhysical - StatsBefore.PeakUsedPhysical));
+
+		// empirical exponent k of time ~ N^k between this and the previous count
+		if (Report.Runs.Num() > 1)
+		{
+			const FMassBenchmarkReport::FRun& PreviousRun = Report.Runs[Report.Runs.Num() - 2];
+			const double CountRatio = double(ProcessorCount) / PreviousRun.Extra.FindChecked(TEXT("ProcessorCount"));
+			for (const TPair<FString, FMassBenchmarkReport::FTimingStats>& It : Run.Phases)
+			{
+				const FMassBenchmarkReport::FTimingStats* Previous = PreviousRun.Phases.Find(It.Key);
+				if (Previous && Previous->AvgMs > 0. && It.Value.AvgMs > 0. && CountRatio > 1.)
+				{
+					Run.Extra.Add(It.Key + TEXT(".ScalingExponent"), FMath::Loge(It.Value.AvgMs / Previous->AvgMs) / FMath::Loge(CountRatio));
+				}
+			}
+		}
+
+		UE_LOG(LogMass, Display, TEXT("%d processors: group tree %.2fms, dependencies %.2fms, solver nodes %.1fKB"), ProcessorCount
+			, Run.Phases.FindRef(TEXT("ResolveExecutesGroupTree")).AvgMs, Run.Phases.FindRef(TEXT("ResolveDependencies")).AvgMs, SolverBytes / 1024.);
+
+		for (UMassProcessor* Processor : Processors)
+		{
+			Processor->MarkAsGarbage();
+		}
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+	}
+
+	return Report.SaveAndCompare(*Params, TEXT("DependencySolver.json"));
+}
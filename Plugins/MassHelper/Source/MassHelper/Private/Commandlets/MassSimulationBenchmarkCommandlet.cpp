@@ -0,0 +1,138 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+#include "MassHelper/Public/Commandlets/MassSimulationBenchmarkCommandlet.h"
+#include "MassHelper/Public/Benchmark/MassBenchmarkReport.h"
+#include "MassHelper/Public/Benchmark/MassBenchmarkWorld.h"
+#include "MassHelper/Public/Processor/MassProfiledCompositeProcessor.h"
+#include "MassHelper/Public/Profiling/MassProcessorTimingCapture.h"
+
+#include "MassSimulation/Public/MassSimulationSubsystem.h"
+
+UMassSimulationBenchmarkCommandlet::UMassSimulationBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UMassSimulationBenchmarkCommandlet::Main(const FString& Params)
+{
+	FString MapPath;
+	FString EntityConfigPaths;
+	FString CountsString = TEXT("10000,50000,200000");
+	int32 WarmupFrames = 60;
+	int32 Frames = 300;
+	float DeltaSeconds = 1.f / 30.f;
+	float SpawnRadius = 20000.f;
+	FParse::Value(*Params, TEXT("Map="), MapPath);
+	FParse::Value(*Params, TEXT("EntityConfigs="), EntityConfigPaths, /*bShouldStopOnSeparator=*/false);
+	FParse::Value(*Params, TEXT("Counts="), CountsString, /*bShouldStopOnSeparator=*/false);
+	FParse::Value(*Params, TEXT("Warmup="), WarmupFrames);
+	FParse::Value(*Params, TEXT("Frames="), Frames);
+	FParse::Value(*Params, TEXT("DeltaTime="), DeltaSeconds);
+	FParse::Value(*Params, TEXT("SpawnRadius="), SpawnRadius);
+	Frames = FMath::Max(1, Frames);
+
+	TArray<FString> CountStrings;
+	CountsString.ParseIntoArray(CountStrings, TEXT(","));
+	if (EntityConfigPaths.IsEmpty() || CountStrings.Num() == 0)
+	{
+		UE_LOG(LogMass, Error, TEXT("%s usage: -EntityConfigs=<asset>[,<asset>...] [-Counts=10000,50000,200000] [-Map=<map>]"), ANSI_TO_TCHAR(__FUNCTION__));
+		return 1;
+	}
+
+	FMassBenchmarkWorld BenchmarkWorld;
+	if (BenchmarkWorld.Create(MapPath) == false || BenchmarkWorld.LoadEntityConfigs(EntityConfigPaths) == false)
+	{
+		return 1;
+	}
+
+	UMassSimulationSubsystem* SimulationSubsystem = UWorld::GetSubsystem<UMassSimulationSubsystem>(BenchmarkWorld.GetWorld());
+	if (SimulationSubsystem == nullptr)
+	{
+		UE_LOG(LogMass, Error, TEXT("%s the benchmark world has no Mass simulation"), ANSI_TO_TCHAR(__FUNCTION__));
+		return 1;
+	}
+
+	FMassBenchmarkReport Report;
+	Report.Benchmark = TEXT("SteadyState");
+	Report.Settings.Add(TEXT("Map"), MapPath);
+	Report.Settings.Add(TEXT("EntityConfigs"), EntityConfigPaths);
+	Report.Settings.Add(TEXT("Warmup"), FString::FromInt(WarmupFrames));
+	Report.Settings.Add(TEXT("Frames"), FString::FromInt(Frames));
+	Report.Settings.Add(TEXT("DeltaTime"), FString::SanitizeFloat(DeltaSeconds));
+
+	for (const FString& CountString : CountStrings)
+	{
+		const int32 EntityCount = FCString::Atoi(*CountString);
+		if (EntityCount <= 0)
+		{
+			continue;
+		}
+
+		TArray<FMassEntityHandle> Entities;
+		BenchmarkWorld.SpawnEntities(EntityCount, SpawnRadius, Entities);
+		UE_LOG(LogMass, Display, TEXT("Benchmarking %d entities (%d spawned)"), EntityCount, Entities.Num());
+
+		for (int32 Frame = 0; Frame < WarmupFrames; ++Frame)
+		{
+			BenchmarkWorld.Tick(DeltaSeconds);
+		}
+
+		TArray<TSharedPtr<FMassProcessorTimingCapture>> PhaseCaptures;
+		for (int32 PhaseIndex = 0; PhaseIndex < int32(EMassProcessingPhase::MAX); ++PhaseIndex)
+		{
+			const EMassProcessingPhase Phase = EMassProcessingPhase(PhaseIndex);
+			UMassProfiledCompositeProcessor::WarnIfNoProfiledPhase(*SimulationSubsystem, TEXT("only frame times are recorded for it"), PhaseIndex);
+			TSharedPtr<FMassProcessorTimingCapture> Capture = MakeShared<FMassProcessorTimingCapture>(Phase, Frames);
+			Capture->Start();
+			PhaseCaptures.Add(Capture);
+		}
+
+		TArray<double> FrameSamplesMs;
+		FrameSamplesMs.Reserve(Frames);
+		for (int32 Frame = 0; Frame < Frames; ++Frame)
+		{
+			FrameSamplesMs.Add(BenchmarkWorld.Tick(DeltaSeconds));
+		}
+
+		FMassBenchmarkReport::FRun& Run = Report.Runs.AddDefaulted_GetRef();
+		Run.Name = FString::FromInt(EntityCount);
+		Run.EntityCount = Entities.Num();
+		Run.Frame = FMassBenchmarkReport::FTimingStats::FromSamples(MoveTemp(FrameSamplesMs));
+		for (const TSharedPtr<FMassProcessorTimingCapture>& Capture : PhaseCaptures)
+		{
+			Capture->Stop();
+
+			TArray<double> PhaseSamplesMs;
+			Capture->GetPhaseSamples(PhaseSamplesMs);
+			if (PhaseSamplesMs.Num() == 0)
+			{
+				continue;
+			}
+			const FString PhaseName = UEnum::GetDisplayValueAsText(Capture->GetPhase()).ToString();
+			Run.Phases.Add(PhaseName, FMassBenchmarkReport::FTimingStats::FromSamples(MoveTemp(PhaseSamplesMs)));
+
+			// the same processor class can run in several phases, keep them apart
+			TMap<FName, FMassProcessorTimingCapture::FProcessorStats> ProcessorStats;
+			Capture->ComputeStats(ProcessorStats);
+			for (const TPair<FName, FMassProcessorTimingCapture::FProcessorStats>& It : ProcessorStats)
+			{
+				FMassBenchmarkReport::FTimingStats& Stats = Run.Processors.Add(FName(PhaseName + TEXT(".") + It.Key.ToString()));
+				Stats.SampleCount = It.Value.SampleCount;
+				Stats.AvgMs = It.Value.AvgMs;
+				Stats.P95Ms = It.Value.P95Ms;
+				Stats.MaxMs = It.Value.MaxMs;
+			}
+		}
+
+		UE_LOG(LogMass, Display, TEXT("%d entities: frame avg %.3fms, p95 %.3fms, max %.3fms"), Run.EntityCount, Run.Frame.AvgMs, Run.Frame.P95Ms, Run.Frame.MaxMs);
+
+		BenchmarkWorld.DestroyEntities(Entities);
+		// let the destruction settle before the next count is spawned
+		BenchmarkWorld.Tick(DeltaSeconds);
+	}
+
+	BenchmarkWorld.Destroy();
+	return Report.SaveAndCompare(*Params, TEXT("SteadyState.json"));
+}
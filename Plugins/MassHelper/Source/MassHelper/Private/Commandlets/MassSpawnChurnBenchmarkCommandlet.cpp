@@ -0,0 +1,266 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+#include "MassHelper/Public/Commandlets/MassSpawnChurnBenchmarkCommandlet.h"
+#include "MassHelper/Public/Analysis/MassArchetypeMemoryReport.h"
+#include "MassHelper/Public/Benchmark/MassBenchmarkReport.h"
+#include "MassHelper/Public/Benchmark/MassBenchmarkWorld.h"
+#include "MassHelper/Public/Processor/MassProfiledCompositeProcessor.h"
+#include "MassHelper/Public/Profiling/MassProcessorProfiler.h"
+
+#include "MassEntity/Public/MassArchetypeData.h"
+#include "MassSimulation/Public/MassSimulationSubsystem.h"
+#include "MassRepresentationProcessor.h"
+
+namespace UE::MassHelper::Private
+{
+	/** Phase and representation processor time of the frame being ticked. */
+	class FChurnFrameListener : public IMassProcessorProfilerListener
+	{
+	public:
+		virtual void OnPhaseBegin(const EMassProcessingPhase Phase, const uint64 Cycles) override
+		{
+			FScopeLock Lock(&CS);
+			PhaseBeginCycles[int(Phase)] = Cycles;
+		}
+
+		virtual void OnPhaseEnd(const EMassProcessingPhase Phase, const uint64 Cycles) override
+		{
+			FScopeLock Lock(&CS);
+			PhasesMs[int(Phase)] += FPlatformTime::ToMilliseconds64(Cycles - PhaseBeginCycles[int(Phase)]);
+		}
+
+		virtual void OnProcessorExecuted(const FMassProcessorExecutionRecord& Record) override
+		{
+			if (Record.Processor && Record.Processor->IsA<UMassRepresentationProcessor>())
+			{
+				FScopeLock Lock(&CS);
+				RepresentationMs += Record.GetDurationMs();
+			}
+		}
+
+		void Reset()
+		{
+			FScopeLock Lock(&CS);
+			FMemory::Memzero(PhasesMs);
+			RepresentationMs = 0.;
+		}
+
+		FCriticalSection CS;
+		uint64 PhaseBeginCycles[int(EMassProcessingPhase::MAX)] = {};
+		double PhasesMs[int(EMassProcessingPhase::MAX)] = {};
+		double RepresentationMs = 0.;
+	};
+
+	struct FArchetypeCounts
+	{
+		int32 ArchetypeCount = 0;
+		int32 ChunkCount = 0;
+
+		static FArchetypeCounts Gather(const FMassEntityManager& EntityManager)
+		{
+			TArray<TSharedPtr<FMassArchetypeData>> Archetypes;
+			FMassArchetypeMemoryReport::GetArchetypes(EntityManager, Archetypes);
+			FArchetypeCounts Counts;
+			Counts.ArchetypeCount = Archetypes.Num();
+			for (const TSharedPtr<FMassArchetypeData>& ArchetypeData : Archetypes)
+			{
+				Counts.ChunkCount += ArchetypeData->GetChunkCount();
+			}
+			return Counts;
+		}
+	};
+}
+
+UMassSpawnChurnBenchmarkCommandlet::UMassSpawnChurnBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UMassSpawnChurnBenchmarkCommandlet::Main(const FString& Params)
+{
+	using namespace UE::MassHelper::Private;
+
+	FString MapPath;
+	FString EntityConfigPaths;
+	FString BatchSizesString = TEXT("1000,5000,10000");
+	int32 Population = 10000;
+	int32 Waves = 10;
+	int32 SettleFrames = 10;
+	int32 WarmupFrames = 60;
+	float DeltaSeconds = 1.f / 30.f;
+	float SpawnRadius = 20000.f;
+	FParse::Value(*Params, TEXT("Map="), MapPath);
+	FParse::Value(*Params, TEXT("EntityConfigs="), EntityConfigPaths, /*bShouldStopOnSeparator=*/false);
+	FParse::Value(*Params, TEXT("BatchSizes="), BatchSizesString, /*bShouldStopOnSeparator=*/false);
+	FParse::Value(*Params, TEXT("Population="), Population);
+	FParse::Value(*Params, TEXT("Waves="), Waves);
+	FParse::Value(*Params, TEXT("SettleFrames="), SettleFrames);
+	FParse::Value(*Params, TEXT("Warmup="), WarmupFrames);
+	FParse::Value(*Params, TEXT("DeltaTime="), DeltaSeconds);
+	FParse::Value(*Params, TEXT("SpawnRadius="), SpawnRadius);
+	Waves = FMath::Max(1, Waves);
+	SettleFrames = FMath::Max(1, SettleFrames);
+
+	TArray<FString> BatchSizeStrings;
+	BatchSizesString.ParseIntoArray(BatchSizeStrings, TEXT(","));
+	if (EntityConfigPaths.IsEmpty() || BatchSizeStrings.Num() == 0)
+	{
+		UE_LOG(LogMass, Error, TEXT("%s usage: -EntityConfigs=<asset>[,<asset>...] [-BatchSizes=1000,5000,10000] [-Population=10000] [-Map=<map>]"), ANSI_TO_TCHAR(__FUNCTION__));
+		return 1;
+	}
+
+	FMassBenchmarkWorld BenchmarkWorld;
+	if (BenchmarkWorld.Create(MapPath) == false || BenchmarkWorld.LoadEntityConfigs(EntityConfigPaths) == false)
+	{
+		return 1;
+	}
+
+	UMassSimulationSubsystem* SimulationSubsystem = UWorld::GetSubsystem<UMassSimulationSubsystem>(BenchmarkWorld.GetWorld());
+	FMassEntityManager* EntityManager = BenchmarkWorld.GetEntityManager();
+	if (SimulationSubsystem == nullptr || EntityManager == nullptr)
+	{
+		UE_LOG(LogMass, Error, TEXT("%s the benchmark world has no Mass simulation"), ANSI_TO_TCHAR(__FUNCTION__));
+		return 1;
+	}
+	for (int32 PhaseIndex = 0; PhaseIndex < int32(EMassProcessingPhase::MAX); ++PhaseIndex)
+	{
+		UMassProfiledCompositeProcessor::WarnIfNoProfiledPhase(*SimulationSubsystem, TEXT("its time counts as outside the phases"), PhaseIndex);
+	}
+
+	FMassBenchmarkReport Report;
+	Report.Benchmark = TEXT("SpawnChurn");
+	Report.Settings.Add(TEXT("Map"), MapPath);
+	Report.Settings.Add(TEXT("EntityConfigs"), EntityConfigPaths);
+	Report.Settings.Add(TEXT("Population"), FString::FromInt(Population));
+	Report.Settings.Add(TEXT("Waves"), FString::FromInt(Waves));
+	Report.Settings.Add(TEXT("SettleFrames"), FString::FromInt(SettleFrames));
+	Report.Settings.Add(TEXT("Warmup"), FString::FromInt(WarmupFrames));
+	Report.Settings.Add(TEXT("DeltaTime"), FString::SanitizeFloat(DeltaSeconds));
+
+	TSharedRef<FChurnFrameListener> Listener = MakeShared<FChurnFrameListener>();
+	FMassProcessorProfiler::Get().AddListener(Listener);
+
+	TArray<FMassEntityHandle> PopulationEntities;
+	BenchmarkWorld.SpawnEntities(Population, SpawnRadius, PopulationEntities);
+	TArray<double> SteadyFramesMs;
+	for (int32 Frame = 0; Frame < WarmupFrames; ++Frame)
+	{
+		const double FrameMs = BenchmarkWorld.Tick(DeltaSeconds);
+		// the second half only, the first frames still carry the population's spawn
+		if (Frame >= WarmupFrames / 2)
+		{
+			SteadyFramesMs.Add(FrameMs);
+		}
+	}
+	const FMassBenchmarkReport::FTimingStats SteadyFrame = FMassBenchmarkReport::FTimingStats::FromSamples(MoveTemp(SteadyFramesMs));
+	UE_LOG(LogMass, Display, TEXT("Steady population of %d entities: frame avg %.3fms"), PopulationEntities.Num(), SteadyFrame.AvgMs);
+
+	for (const FString& BatchSizeString : BatchSizeStrings)
+	{
+		const int32 BatchSize = FCString::Atoi(*BatchSizeString);
+		if (BatchSize <= 0)
+		{
+			continue;
+		}
+
+		// the timed steps are reported next to the processing phases
+		TMap<FString, TArray<double>> StepSamplesMs;
+		TArray<double> FrameSamplesMs;
+		int32 SpawnedCount = 0;
+		int32 NewArchetypeCount = 0;
+		int32 NewChunkCount = 0;
+		int32 RawNewChunkCount = 0;
+
+		auto TickFrames = [&](const TCHAR* FirstFrameStep)
+		{
+			for (int32 Frame = 0; Frame < SettleFrames; ++Frame)
+			{
+				Listener->Reset();
+				const double FrameMs = BenchmarkWorld.Tick(DeltaSeconds);
+				FrameSamplesMs.Add(FrameMs);
+				if (Frame == 0)
+				{
+					StepSamplesMs.FindOrAdd(FirstFrameStep).Add(FrameMs);
+				}
+
+				FScopeLock Lock(&Listener->CS);
+				double PhasesMs = 0.;
+				for (int32 PhaseIndex = 0; PhaseIndex < int32(EMassProcessingPhase::MAX); ++PhaseIndex)
+				{
+					PhasesMs += Listener->PhasesMs[PhaseIndex];
+					StepSamplesMs.FindOrAdd(UEnum::GetDisplayValueAsText(EMassProcessingPhase(PhaseIndex)).ToString()).Add(Listener->PhasesMs[PhaseIndex]);
+				}
+				StepSamplesMs.FindOrAdd(TEXT("Representation")).Add(Listener->RepresentationMs);
+				StepSamplesMs.FindOrAdd(TEXT("OutsidePhases")).Add(FMath::Max(0., FrameMs - PhasesMs));
+			}
+		};
+
+		for (int32 Wave = 0; Wave < Waves; ++Wave)
+		{
+			TArray<FMassEntityHandle> Entities;
+
+			FArchetypeCounts CountsBefore = FArchetypeCounts::Gather(*EntityManager);
+			uint64 BeginCycles = FPlatformTime::Cycles64();
+			BenchmarkWorld.BatchCreateEntities(BatchSize, Entities);
+			StepSamplesMs.FindOrAdd(TEXT("RawBatchCreate")).Add(FMassBenchmarkReport::MillisecondsSince(BeginCycles));
+			RawNewChunkCount += FArchetypeCounts::Gather(*EntityManager).ChunkCount - CountsBefore.ChunkCount;
+
+			BeginCycles = FPlatformTime::Cycles64();
+			BenchmarkWorld.BatchDestroyEntities(Entities);
+			StepSamplesMs.FindOrAdd(TEXT("RawBatchDestroy")).Add(FMassBenchmarkReport::MillisecondsSince(BeginCycles));
+
+			CountsBefore = FArchetypeCounts::Gather(*EntityManager);
+			BeginCycles = FPlatformTime::Cycles64();
+			BenchmarkWorld.SpawnEntities(BatchSize, SpawnRadius, Entities);
+			StepSamplesMs.FindOrAdd(TEXT("Spawn")).Add(FMassBenchmarkReport::MillisecondsSince(BeginCycles));
+			const FArchetypeCounts CountsAfter = FArchetypeCounts::Gather(*EntityManager);
+			NewArchetypeCount += CountsAfter.ArchetypeCount - CountsBefore.ArchetypeCount;
+			NewChunkCount += CountsAfter.ChunkCount - CountsBefore.ChunkCount;
+			SpawnedCount += Entities.Num();
+
+			TickFrames(TEXT("FirstFrameAfterSpawn"));
+
+			BeginCycles = FPlatformTime::Cycles64();
+			BenchmarkWorld.DestroyEntities(Entities);
+			StepSamplesMs.FindOrAdd(TEXT("Despawn")).Add(FMassBenchmarkReport::MillisecondsSince(BeginCycles));
+
+			TickFrames(TEXT("FirstFrameAfterDespawn"));
+		}
+
+		FMassBenchmarkReport::FRun& Run = Report.Runs.AddDefaulted_GetRef();
+		Run.Name = FString::FromInt(BatchSize);
+		Run.EntityCount = BatchSize;
+		Run.Frame = FMassBenchmarkReport::FTimingStats::FromSamples(MoveTemp(FrameSamplesMs));
+		for (TPair<FString, TArray<double>>& It : StepSamplesMs)
+		{
+			Run.Phases.Add(It.Key, FMassBenchmarkReport::FTimingStats::FromSamples(MoveTemp(It.Value)));
+		}
+
+		auto GetEntitiesPerSecond = [&Run, BatchSize](const TCHAR* Step)
+		{
+			const FMassBenchmarkReport::FTimingStats* Stats = Run.Phases.Find(Step);
+			return (Stats && Stats->AvgMs > 0.) ? BatchSize * 1000. / Stats->AvgMs : 0.;
+		};
+		Run.Extra.Add(TEXT("SpawnedPerWave"), double(SpawnedCount) / Waves);
+		Run.Extra.Add(TEXT("SpawnEntitiesPerSecond"), GetEntitiesPerSecond(TEXT("Spawn")));
+		Run.Extra.Add(TEXT("DespawnEntitiesPerSecond"), GetEntitiesPerSecond(TEXT("Despawn")));
+		Run.Extra.Add(TEXT("RawCreateEntitiesPerSecond"), GetEntitiesPerSecond(TEXT("RawBatchCreate")));
+		Run.Extra.Add(TEXT("RawDestroyEntitiesPerSecond"), GetEntitiesPerSecond(TEXT("RawBatchDestroy")));
+		Run.Extra.Add(TEXT("NewArchetypes"), NewArchetypeCount);
+		Run.Extra.Add(TEXT("NewChunksPerWave"), double(NewChunkCount) / Waves);
+		Run.Extra.Add(TEXT("RawNewChunksPerWave"), double(RawNewChunkCount) / Waves);
+		Run.Extra.Add(TEXT("SteadyFrameAvgMs"), SteadyFrame.AvgMs);
+		Run.Extra.Add(TEXT("FrameSpikeMs"), Run.Frame.MaxMs - SteadyFrame.AvgMs);
+
+		UE_LOG(LogMass, Display, TEXT("Batch %d: spawn %.3fms (%.0f/s), despawn %.3fms, frame max %.3fms (+%.3fms over steady), %.1f new chunks per wave")
+			, BatchSize, Run.Phases.FindRef(TEXT("Spawn")).AvgMs, Run.Extra[TEXT("SpawnEntitiesPerSecond")], Run.Phases.FindRef(TEXT("Despawn")).AvgMs
+			, Run.Frame.MaxMs, Run.Extra[TEXT("FrameSpikeMs")], Run.Extra[TEXT("NewChunksPerWave")]);
+	}
+
+	FMassProcessorProfiler::Get().RemoveListener(Listener);
+	BenchmarkWorld.DestroyEntities(PopulationEntities);
+	BenchmarkWorld.Destroy();
+	return Report.SaveAndCompare(*Params, TEXT("SpawnChurn.json"));
+}
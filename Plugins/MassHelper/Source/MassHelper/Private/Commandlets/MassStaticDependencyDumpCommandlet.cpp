@@ -0,0 +1,235 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+#include "MassHelper/Public/Commandlets/MassStaticDependencyDumpCommandlet.h"
+#include "MassHelper/Public/Processor/MassAllPhasesDependencyPrinter.h"
+#include "MassHelper/Public/Analysis/MassProcessorGraph.h"
+
+#include "MassEntitySettings.h"
+#include "Json/Public/Dom/JsonObject.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/MemoryWriter.h"
+#include "UObject/Package.h"
+
+namespace UE::MassHelper::Private
+{
+	bool ParseDumpPrintMode(const FString& ModeName, EPrintMode& OutPrintMode)
+	{
+		static const TPair<const TCHAR*, EPrintMode> Modes[] = {
+			{ TEXT("ExecutesGroupTree"), EPrintMode::ExecutesGroupTree },
+			{ TEXT("CompletelyDependency"), EPrintMode::CompletelyDependency },
+			{ TEXT("CriticalPathAnalysis"), EPrintMode::CriticalPathAnalysis },
+			{ TEXT("ScheduleSimulation"), EPrintMode::ScheduleSimulation },
+			{ TEXT("ConstraintAnalysis"), EPrintMode::ConstraintAnalysis },
+			{ TEXT("GameThreadAudit"), EPrintMode::GameThreadAudit },
+		};
+		for (const TPair<const TCHAR*, EPrintMode>& Mode : Modes)
+		{
+			if (ModeName.Equals(Mode.Key))
+			{
+				OutPrintMode = Mode.Value;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/** What the baseline comparison looks at for one phase of an all phases dump. */
+	struct FDumpPhaseSummary
+	{
+		/** Per node, the nodes it is ordered after. */
+		TMap<FString, TSet<FString>> Dependencies;
+		TSharedPtr<FJsonObject> CriticalPathAnalysis;
+	};
+
+	bool LoadDumpSummary(const FString& JsonString, TMap<FString, FDumpPhaseSummary>& OutPhases)
+	{
+		TSharedPtr<FJsonObject> RootJson;
+		const TArray<TSharedPtr<FJsonValue>>* PhasesJson = nullptr;
+		if (FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(JsonString), RootJson) == false || RootJson.IsValid() == false
+			|| RootJson->TryGetArrayField(TEXT("Phases"), PhasesJson) == false)
+		{
+			return false;
+		}
+
+		for (const TSharedPtr<FJsonValue>& PhaseValue : *PhasesJson)
+		{
+			const TSharedPtr<FJsonObject>& PhaseJson = PhaseValue->AsObject();
+			const TSharedPtr<FJsonObject>* DependencyJson = nullptr;
+			if (PhaseJson.IsValid() == false || PhaseJson->TryGetObjectField(TEXT("Dependency"), DependencyJson) == false)
+			{
+				continue;
+			}
+
+			FDumpPhaseSummary& Summary = OutPhases.Add(PhaseJson->GetStringField(TEXT("Phase")));
+			const TArray<TSharedPtr<FJsonValue>>* NodesJson = nullptr;
+			if ((*DependencyJson)->TryGetArrayField(TEXT("Nodes"), NodesJson))
+			{
+				for (const TSharedPtr<FJsonValue>& NodeValue : *NodesJson)
+				{
+					const TSharedPtr<FJsonObject>& NodeJson = NodeValue->AsObject();
+					TSet<FString>& NodeDependencies = Summary.Dependencies.Add(NodeJson->GetStringField(TEXT("NodeName")));
+					const TArray<TSharedPtr<FJsonValue>>* DependenciesJson = nullptr;
+					if (NodeJson->TryGetArrayField(TEXT("OriginalDependencies"), DependenciesJson))
+					{
+						for (const TSharedPtr<FJsonValue>& DependencyValue : *DependenciesJson)
+						{
+							NodeDependencies.Add(DependencyValue->AsString());
+						}
+					}
+				}
+			}
+			const TSharedPtr<FJsonObject>* AnalysisJson = nullptr;
+			if ((*DependencyJson)->TryGetObjectField(TEXT("CriticalPathAnalysis"), AnalysisJson))
+			{
+				Summary.CriticalPathAnalysis = *AnalysisJson;
+			}
+		}
+		return true;
+	}
+
+	/** Logs the differences to the baseline, returns the number of failures among them. */
+	int32 CompareDumpSummaries(const TMap<FString, FDumpPhaseSummary>& Current, const TMap<FString, FDumpPhaseSummary>& Baseline, const double Tolerance)
+	{
+		int32 FailureCount = 0;
+		for (const TPair<FString, FDumpPhaseSummary>& Phase : Current)
+		{
+			const FDumpPhaseSummary* BaselinePhase = Baseline.Find(Phase.Key);
+			if (BaselinePhase == nullptr)
+			{
+				UE_LOG(LogMass, Display, TEXT("%s: new phase"), *Phase.Key);
+				continue;
+			}
+
+			for (const TPair<FString, TSet<FString>>& Node : Phase.Value.Dependencies)
+			{
+				const TSet<FString>* BaselineDependencies = BaselinePhase->Dependencies.Find(Node.Key);
+				if (BaselineDependencies == nullptr)
+				{
+					UE_LOG(LogMass, Display, TEXT("%s: added %s"), *Phase.Key, *Node.Key);
+					continue;
+				}
+				for (const FString& Dependency : Node.Value.Difference(*BaselineDependencies))
+				{
+					UE_LOG(LogMass, Display, TEXT("%s: %s now runs after %s"), *Phase.Key, *Node.Key, *Dependency);
+				}
+			}
+			for (const TPair<FString, TSet<FString>>& Node : BaselinePhase->Dependencies)
+			{
+				if (Phase.Value.Dependencies.Contains(Node.Key) == false)
+				{
+					UE_LOG(LogMass, Display, TEXT("%s: removed %s"), *Phase.Key, *Node.Key);
+				}
+			}
+
+			const TSharedPtr<FJsonObject>& Analysis = Phase.Value.CriticalPathAnalysis;
+			const TSharedPtr<FJsonObject>& BaselineAnalysis = BaselinePhase->CriticalPathAnalysis;
+			if (Analysis.IsValid() == false || BaselineAnalysis.IsValid() == false)
+			{
+				continue;
+			}
+			if (Analysis->GetBoolField(TEXT("HasCycle")) && BaselineAnalysis->GetBoolField(TEXT("HasCycle")) == false)
+			{
+				UE_LOG(LogMass, Error, TEXT("%s: the processor dependencies form a cycle"), *Phase.Key);
+				++FailureCount;
+			}
+			const double CriticalPathMs = Analysis->GetNumberField(TEXT("CriticalPathMs"));
+			const double BaselineCriticalPathMs = BaselineAnalysis->GetNumberField(TEXT("CriticalPathMs"));
+			if (CriticalPathMs > BaselineCriticalPathMs * (1. + Tolerance))
+			{
+				UE_LOG(LogMass, Error, TEXT("%s: critical path grew from %.3f to %.3f"), *Phase.Key, BaselineCriticalPathMs, CriticalPathMs);
+				++FailureCount;
+			}
+			const double Parallelism = Analysis->GetNumberField(TEXT("AverageParallelism"));
+			const double BaselineParallelism = BaselineAnalysis->GetNumberField(TEXT("AverageParallelism"));
+			if (Parallelism < BaselineParallelism * (1. - Tolerance))
+			{
+				UE_LOG(LogMass, Error, TEXT("%s: average parallelism dropped from %.2f to %.2f"), *Phase.Key, BaselineParallelism, Parallelism);
+				++FailureCount;
+			}
+		}
+		return FailureCount;
+	}
+}
+
+UMassStaticDependencyDumpCommandlet::UMassStaticDependencyDumpCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UMassStaticDependencyDumpCommandlet::Main(const FString& Params)
+{
+	using namespace UE::MassHelper::Private;
+
+	FString ModeName = TEXT("CriticalPathAnalysis");
+	FString CostFile;
+	FString OutFileName = FPaths::ProjectSavedDir() / TEXT("Mass_ProcessorDependency_AllPhases_Static.json");
+	FString BaselineFileName;
+	int32 WorkerCount = 0;
+	double Tolerance = 0.05;
+	FParse::Value(*Params, TEXT("Mode="), ModeName);
+	FParse::Value(*Params, TEXT("CostFile="), CostFile);
+	FParse::Value(*Params, TEXT("Out="), OutFileName);
+	FParse::Value(*Params, TEXT("Baseline="), BaselineFileName);
+	FParse::Value(*Params, TEXT("Workers="), WorkerCount);
+	FParse::Value(*Params, TEXT("Tolerance="), Tolerance);
+
+	EPrintMode PrintMode = EPrintMode::CriticalPathAnalysis;
+	if (ParseDumpPrintMode(ModeName, PrintMode) == false)
+	{
+		UE_LOG(LogMass, Error, TEXT("%s unknown -Mode=%s"), ANSI_TO_TCHAR(__FUNCTION__), *ModeName);
+		return 1;
+	}
+
+	FMassProcessorCostTable CostTable;
+	if (CostFile.IsEmpty() == false && CostTable.LoadFromJsonFile(CostFile) == false)
+	{
+		return 1;
+	}
+
+	const uint64 BeginCycles = FPlatformTime::Cycles64();
+	// the settings build the phase processor CDO lists on engine init, nothing else gets loaded
+	TConstArrayView<FMassProcessingPhaseConfig> PhasesConfig = GET_MASS_CONFIG_VALUE(GetProcessingPhasesConfig());
+	FMassAllPhasesDependencyPrinter Printer(*GetTransientPackage(), PhasesConfig);
+	Printer.CostTable = &CostTable;
+	Printer.WorkerCount = WorkerCount;
+
+	TArray<uint8> DumpBytes;
+	FMemoryWriter DumpWriter(DumpBytes);
+	Printer.Print(PrintMode, DumpWriter);
+	UE_LOG(LogMass, Display, TEXT("Solved %d phases in %.1fms"), PhasesConfig.Num(), FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - BeginCycles));
+
+	if (FFileHelper::SaveArrayToFile(DumpBytes, *OutFileName) == false)
+	{
+		UE_LOG(LogMass, Error, TEXT("%s unable to write %s"), ANSI_TO_TCHAR(__FUNCTION__), *OutFileName);
+		return 1;
+	}
+	UE_LOG(LogMass, Display, TEXT("Wrote %s"), *OutFileName);
+
+	if (BaselineFileName.IsEmpty())
+	{
+		return 0;
+	}
+
+	FString BaselineString;
+	TMap<FString, FDumpPhaseSummary> BaselinePhases;
+	if (FFileHelper::LoadFileToString(BaselineString, *BaselineFileName) == false || LoadDumpSummary(BaselineString, BaselinePhases) == false)
+	{
+		UE_LOG(LogMass, Error, TEXT("%s %s is not an all phases dump"), ANSI_TO_TCHAR(__FUNCTION__), *BaselineFileName);
+		return 1;
+	}
+	TMap<FString, FDumpPhaseSummary> CurrentPhases;
+	LoadDumpSummary(FString(FUTF8ToTCHAR(reinterpret_cast<const ANSICHAR*>(DumpBytes.GetData()), DumpBytes.Num())), CurrentPhases);
+
+	const int32 FailureCount = CompareDumpSummaries(CurrentPhases, BaselinePhases, Tolerance);
+	if (FailureCount > 0)
+	{
+		UE_LOG(LogMass, Error, TEXT("%d dependency regressions against %s"), FailureCount, *BaselineFileName);
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,264 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+#include "MassHelper/Public/Commandlets/MassTelemetryQueryCommandlet.h"
+#include "MassHelper/Public/Profiling/MassTelemetryRing.h"
+
+#include "Misc/FileHelper.h"
+
+namespace UE::MassHelper::Private
+{
+	int32 FindTelemetryPhase(const FString& PhaseName)
+	{
+		for (int32 PhaseIndex = 0; PhaseIndex < int32(EMassProcessingPhase::MAX); ++PhaseIndex)
+		{
+			if (PhaseName.Equals(UEnum::GetDisplayValueAsText(EMassProcessingPhase(PhaseIndex)).ToString()))
+			{
+				return PhaseIndex;
+			}
+		}
+		return PhaseName.IsNumeric() ? FCString::Atoi(*PhaseName) : INDEX_NONE;
+	}
+
+	float GetTelemetryPhaseMs(const FMassTelemetryFrame& Frame, const int32 PhaseIndex)
+	{
+		for (const FMassTelemetryFrame::FPhase& Phase : Frame.Phases)
+		{
+			if (Phase.Phase == PhaseIndex)
+			{
+				return Phase.Ms;
+			}
+		}
+		return 0.f;
+	}
+
+	/** Time of the processor in the frame, summed over its phases unless PhaseIndex picks one. */
+	float GetTelemetryProcessorMs(const FMassTelemetryFrame& Frame, const uint32 NameId, const int32 PhaseIndex)
+	{
+		float Ms = 0.f;
+		for (const FMassTelemetryFrame::FProcessor& Processor : Frame.Processors)
+		{
+			if (Processor.NameId == NameId && (PhaseIndex == INDEX_NONE || Processor.Phase == PhaseIndex))
+			{
+				Ms += Processor.Ms;
+			}
+		}
+		return Ms;
+	}
+}
+
+UMassTelemetryQueryCommandlet::UMassTelemetryQueryCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UMassTelemetryQueryCommandlet::Main(const FString& Params)
+{
+	using namespace UE::MassHelper::Private;
+
+	FString FilePath = FMassTelemetryRingWriter::GetDefaultFilePath();
+	FString Query = TEXT("Summary");
+	FString ProcessorName;
+	FString PhaseName;
+	FString ArchetypeFilter;
+	FString OutPath;
+	int32 Count = 10;
+	FParse::Value(*Params, TEXT("File="), FilePath);
+	FParse::Value(*Params, TEXT("Query="), Query);
+	FParse::Value(*Params, TEXT("Processor="), ProcessorName);
+	FParse::Value(*Params, TEXT("Phase="), PhaseName);
+	FParse::Value(*Params, TEXT("Archetype="), ArchetypeFilter);
+	FParse::Value(*Params, TEXT("Out="), OutPath);
+	FParse::Value(*Params, TEXT("Count="), Count);
+	Count = FMath::Max(1, Count);
+
+	FMassTelemetryRingReader Reader;
+	if (Reader.Load(FilePath) == false)
+	{
+		return 1;
+	}
+	if (Reader.Frames.Num() == 0)
+	{
+		UE_LOG(LogMass, Warning, TEXT("%s %s holds no frames"), ANSI_TO_TCHAR(__FUNCTION__), *FilePath);
+		return 0;
+	}
+	if (Reader.TornSlotCount > 0)
+	{
+		UE_LOG(LogMass, Warning, TEXT("%s skipped %d torn slots"), ANSI_TO_TCHAR(__FUNCTION__), Reader.TornSlotCount);
+	}
+
+	TArray<FString> CsvLines;
+	if (Query.Equals(TEXT("Summary")))
+	{
+		const FMassTelemetryFrame& First = Reader.Frames[0];
+		const FMassTelemetryFrame& Last = Reader.Frames.Last();
+		int32 TruncatedCount = 0;
+		TMap<uint32, TPair<double, float>> ProcessorTotals; // sum and max ms
+		TMap<uint32, int32> ArchetypeMaxCounts;
+		for (const FMassTelemetryFrame& Frame : Reader.Frames)
+		{
+			TruncatedCount += Frame.bTruncated ? 1 : 0;
+			for (const FMassTelemetryFrame::FProcessor& Processor : Frame.Processors)
+			{
+				TPair<double, float>& Totals = ProcessorTotals.FindOrAdd(Processor.NameId);
+				Totals.Key += Processor.Ms;
+				Totals.Value = FMath::Max(Totals.Value, Processor.Ms);
+			}
+			for (const FMassTelemetryFrame::FArchetype& Archetype : Frame.Archetypes)
+			{
+				int32& MaxCount = ArchetypeMaxCounts.FindOrAdd(Archetype.NameId);
+				MaxCount = FMath::Max(MaxCount, Archetype.EntityCount);
+			}
+		}
+		ProcessorTotals.ValueSort([](const TPair<double, float>& A, const TPair<double, float>& B) { return A.Key > B.Key; });
+		ArchetypeMaxCounts.ValueSort(TGreater<int32>());
+
+		UE_LOG(LogMass, Display, TEXT("%d frames, sequence %llu..%llu, engine frame %llu..%llu, %.1f s, %d truncated, %d names")
+			, Reader.Frames.Num(), First.Sequence, Last.Sequence, First.EngineFrame, Last.EngineFrame, Last.TimeSeconds - First.TimeSeconds
+			, TruncatedCount, Reader.Names.Num());
+		CsvLines.Add(TEXT("Kind,Name,AvgMs,MaxMs,MaxEntities"));
+		int32 Rank = 0;
+		for (const TPair<uint32, TPair<double, float>>& It : ProcessorTotals)
+		{
+			if (Rank++ >= Count)
+			{
+				break;
+			}
+			const double AvgMs = It.Value.Key / Reader.Frames.Num();
+			UE_LOG(LogMass, Display, TEXT("  processor %s avg %.3f ms max %.3f ms"), *Reader.GetName(It.Key), AvgMs, It.Value.Value);
+			CsvLines.Add(FString::Printf(TEXT("Processor,%s,%f,%f,"), *Reader.GetName(It.Key), AvgMs, It.Value.Value));
+		}
+		Rank = 0;
+		for (const TPair<uint32, int32>& It : ArchetypeMaxCounts)
+		{
+			if (Rank++ >= Count)
+			{
+				break;
+			}
+			UE_LOG(LogMass, Display, TEXT("  archetype %s max %d entities"), *Reader.GetName(It.Key), It.Value);
+			CsvLines.Add(FString::Printf(TEXT("Archetype,\"%s\",,,%d"), *Reader.GetName(It.Key), It.Value));
+		}
+	}
+	else if (Query.Equals(TEXT("WorstFrames")))
+	{
+		const int32 PhaseIndex = PhaseName.IsEmpty() ? INDEX_NONE : FindTelemetryPhase(PhaseName);
+		if (PhaseName.IsEmpty() == false && PhaseIndex == INDEX_NONE)
+		{
+			UE_LOG(LogMass, Error, TEXT("%s unknown phase %s"), ANSI_TO_TCHAR(__FUNCTION__), *PhaseName);
+			return 1;
+		}
+		const int32 NameId = ProcessorName.IsEmpty() ? INDEX_NONE : Reader.Names.IndexOfByKey(ProcessorName);
+		if (ProcessorName.IsEmpty() == false && NameId == INDEX_NONE)
+		{
+			UE_LOG(LogMass, Error, TEXT("%s processor '%s' never got recorded"), ANSI_TO_TCHAR(__FUNCTION__), *ProcessorName);
+			return 1;
+		}
+		auto GetFrameMs = [PhaseIndex, NameId](const FMassTelemetryFrame& Frame)
+		{
+			return NameId != INDEX_NONE ? GetTelemetryProcessorMs(Frame, uint32(NameId), PhaseIndex)
+				: PhaseIndex == INDEX_NONE ? Frame.FrameMs : GetTelemetryPhaseMs(Frame, PhaseIndex);
+		};
+
+		TArray<const FMassTelemetryFrame*> SortedFrames;
+		for (const FMassTelemetryFrame& Frame : Reader.Frames)
+		{
+			SortedFrames.Add(&Frame);
+		}
+		SortedFrames.Sort([&GetFrameMs](const FMassTelemetryFrame& A, const FMassTelemetryFrame& B) { return GetFrameMs(A) > GetFrameMs(B); });
+		SortedFrames.SetNum(FMath::Min(Count, SortedFrames.Num()));
+
+		CsvLines.Add(TEXT("EngineFrame,Ms,Entities,TopProcessor,TopProcessorMs"));
+		for (const FMassTelemetryFrame* Frame : SortedFrames)
+		{
+			// processors are stored most expensive first
+			const FMassTelemetryFrame::FProcessor* TopProcessor = Frame->Processors.FindByPredicate([PhaseIndex](const FMassTelemetryFrame::FProcessor& Processor)
+			{
+				return PhaseIndex == INDEX_NONE || Processor.Phase == PhaseIndex;
+			});
+			const FString TopProcessorName = TopProcessor ? Reader.GetName(TopProcessor->NameId) : FString();
+			const float TopProcessorMs = TopProcessor ? TopProcessor->Ms : 0.f;
+			UE_LOG(LogMass, Display, TEXT("  frame %llu %.3f ms, %d entities, top %s %.3f ms"), Frame->EngineFrame, GetFrameMs(*Frame), Frame->EntityCount
+				, *TopProcessorName, TopProcessorMs);
+			CsvLines.Add(FString::Printf(TEXT("%llu,%f,%d,%s,%f"), Frame->EngineFrame, GetFrameMs(*Frame), Frame->EntityCount, *TopProcessorName, TopProcessorMs));
+		}
+	}
+	else if (Query.Equals(TEXT("ProcessorSeries")))
+	{
+		const int32 NameId = Reader.Names.IndexOfByKey(ProcessorName);
+		if (NameId == INDEX_NONE)
+		{
+			UE_LOG(LogMass, Error, TEXT("%s processor '%s' never got recorded"), ANSI_TO_TCHAR(__FUNCTION__), *ProcessorName);
+			return 1;
+		}
+
+		const int32 PhaseIndex = PhaseName.IsEmpty() ? INDEX_NONE : FindTelemetryPhase(PhaseName);
+		if (PhaseName.IsEmpty() == false && PhaseIndex == INDEX_NONE)
+		{
+			UE_LOG(LogMass, Error, TEXT("%s unknown phase %s"), ANSI_TO_TCHAR(__FUNCTION__), *PhaseName);
+			return 1;
+		}
+
+		TArray<TPair<uint64, float>> Series;
+		double TotalMs = 0.;
+		for (const FMassTelemetryFrame& Frame : Reader.Frames)
+		{
+			const float Ms = GetTelemetryProcessorMs(Frame, uint32(NameId), PhaseIndex);
+			Series.Emplace(Frame.EngineFrame, Ms);
+			TotalMs += Ms;
+		}
+		Series.Sort([](const TPair<uint64, float>& A, const TPair<uint64, float>& B) { return A.Key < B.Key; });
+
+		float MaxMs = 0.f;
+		CsvLines.Add(TEXT("EngineFrame,Ms"));
+		for (const TPair<uint64, float>& It : Series)
+		{
+			MaxMs = FMath::Max(MaxMs, It.Value);
+			CsvLines.Add(FString::Printf(TEXT("%llu,%f"), It.Key, It.Value));
+		}
+		UE_LOG(LogMass, Display, TEXT("  %s avg %.3f ms max %.3f ms over %d frames"), *ProcessorName, TotalMs / Reader.Frames.Num(), MaxMs, Reader.Frames.Num());
+	}
+	else if (Query.Equals(TEXT("ArchetypeCount")))
+	{
+		TSet<uint32> NameIds;
+		for (int32 NameId = 0; NameId < Reader.Names.Num(); ++NameId)
+		{
+			if (Reader.Names[NameId].Contains(ArchetypeFilter))
+			{
+				NameIds.Add(uint32(NameId));
+			}
+		}
+
+		int32 MinCount = MAX_int32;
+		int32 MaxCount = 0;
+		int32 LastCount = 0;
+		CsvLines.Add(TEXT("EngineFrame,Entities"));
+		for (const FMassTelemetryFrame& Frame : Reader.Frames)
+		{
+			// small archetypes may have been left out of a truncated frame
+			int32 EntityCount = 0;
+			for (const FMassTelemetryFrame::FArchetype& Archetype : Frame.Archetypes)
+			{
+				EntityCount += NameIds.Contains(Archetype.NameId) ? Archetype.EntityCount : 0;
+			}
+			MinCount = FMath::Min(MinCount, EntityCount);
+			MaxCount = FMath::Max(MaxCount, EntityCount);
+			LastCount = EntityCount;
+			CsvLines.Add(FString::Printf(TEXT("%llu,%d"), Frame.EngineFrame, EntityCount));
+		}
+		UE_LOG(LogMass, Display, TEXT("  %d archetypes matching '%s', %d..%d entities, %d now"), NameIds.Num(), *ArchetypeFilter, MinCount, MaxCount
+			, LastCount);
+	}
+	else
+	{
+		UE_LOG(LogMass, Error, TEXT("%s unknown query %s, expected Summary, WorstFrames, ProcessorSeries or ArchetypeCount"), ANSI_TO_TCHAR(__FUNCTION__), *Query);
+		return 1;
+	}
+
+	if (OutPath.IsEmpty() == false && FFileHelper::SaveStringArrayToFile(CsvLines, *OutPath) == false)
+	{
+		UE_LOG(LogMass, Error, TEXT("%s could not write %s"), ANSI_TO_TCHAR(__FUNCTION__), *OutPath);
+		return 1;
+	}
+	return 0;
+}
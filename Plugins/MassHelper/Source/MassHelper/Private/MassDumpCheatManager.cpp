@@ -1,6 +1,16 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "MassHelper/Public/MassDumpCheatManager.h"
+#include "MassHelper/Public/Processor/MassProfiledCompositeProcessor.h"
+#include "MassHelper/Public/Profiling/MassProcessorTimingCapture.h"
+#include "MassHelper/Public/Profiling/MassProcessorTraceCapture.h"
+#include "MassHelper/Public/Profiling/MassProcessorLiveStats.h"
+#include "MassHelper/Public/Profiling/MassCommandProfileCapture.h"
+#include "MassHelper/Public/Profiling/MassLODTickCapture.h"
+#include "MassHelper/Public/Profiling/MassSignalCapture.h"
+#include "MassHelper/Public/Profiling/MassTelemetryRing.h"
+#include "MassHelper/Public/Analysis/MassArchetypeMemoryReport.h"
+#include "MassHelper/Public/Processor/MassAllPhasesDependencyPrinter.h"
 
 #include "EngineUtils.h"
 #include "GameFramework/PlayerController.h"
@@ -12,35 +22,466 @@
 #include "MassSimulation/Public/MassSimulationSubsystem.h"
 #include "MassEntity/Public/MassEntitySubsystem.h"
 #include <Misc/FileHelper.h>
+#include "Async/Async.h"
+#include "Serialization/MemoryWriter.h"
 
 UMassDumpCheatManager::UMassDumpCheatManager()
 {
 
 }
 
+void UMassDumpCheatManager::BeginDestroy()
+{
+	// the profiler keeps its listeners alive, which would keep every phase on the instrumented path
+	if (LiveStats.IsValid())
+	{
+		LiveStats->Stop();
+		LiveStats.Reset();
+	}
+	if (ActiveTraceCapture.IsValid())
+	{
+		ActiveTraceCapture->Stop();
+		ActiveTraceCapture.Reset();
+	}
+	if (ActiveTimingCapture.IsValid())
+	{
+		ActiveTimingCapture->Stop();
+		ActiveTimingCapture.Reset();
+	}
+	if (ActiveCommandCapture.IsValid())
+	{
+		ActiveCommandCapture->Stop();
+		ActiveCommandCapture.Reset();
+	}
+	if (ActiveLODCapture.IsValid())
+	{
+		ActiveLODCapture->Stop();
+		ActiveLODCapture.Reset();
+	}
+	if (ActiveSignalCapture.IsValid())
+	{
+		ActiveSignalCapture->Stop();
+		ActiveSignalCapture.Reset();
+	}
+	if (TelemetryRing.IsValid())
+	{
+		TelemetryRing->Stop();
+		TelemetryRing.Reset();
+	}
+
+	Super::BeginDestroy();
+}
+
+template<typename TCapture>
+void UMassDumpCheatManager::StartCapture(TSharedPtr<TCapture>& ActiveCapture, const TSharedRef<TCapture>& NewCapture, void (UMassDumpCheatManager::*OnCompleted)(TCapture&))
+{
+	if (ActiveCapture.IsValid())
+	{
+		ActiveCapture->Stop();
+	}
+
+	ActiveCapture = NewCapture;
+	NewCapture->OnCompleted = [WeakThis = TWeakObjectPtr<UMassDumpCheatManager>(this), OnCompleted](TCapture& Capture)
+	{
+		if (WeakThis.IsValid())
+		{
+			(WeakThis.Get()->*OnCompleted)(Capture);
+		}
+	};
+	NewCapture->Start();
+}
+
+template<typename TCapture>
+void UMassDumpCheatManager::SaveCapture(TSharedPtr<TCapture>& ActiveCapture, TCapture& Capture, const FString& ToSaveFileName)
+{
+	TArray<uint8> ReportBytes;
+	FMemoryWriter ReportWriter(ReportBytes);
+	Capture.Write(ReportWriter);
+	SaveDumpAsync(MoveTemp(ReportBytes), ToSaveFileName);
+
+	if (ActiveCapture.Get() == &Capture)
+	{
+		ActiveCapture.Reset();
+	}
+}
+
+bool UMassDumpCheatManager::WarnIfNoProfiledPhase(const TCHAR* Consequence, const int PhaseID) const
+{
+	UMassSimulationSubsystem* MassSimulationSubsystem = UWorld::GetSubsystem<UMassSimulationSubsystem>(this->GetWorld());
+	return MassSimulationSubsystem && UMassProfiledCompositeProcessor::WarnIfNoProfiledPhase(*MassSimulationSubsystem, Consequence, PhaseID);
+}
+
 void UMassDumpCheatManager::DumpStaticProcessorExecutesGroupTreeByPhaseID(int PhaseID)
 {
-	bool bRuntime = false;
-	FString ToSaveFileName = FString::Printf(TEXT("Mass_ProcessorExecutesGroupTree_Phase%d_"), PhaseID) + ((bRuntime) ? ("Runtime.json") : ("Static.json"));
-	DoPrint(PhaseID, ToSaveFileName, EPrintMode::ExecutesGroupTree);
+	FMassPhaseDumpOptions Options;
+	Options.PrintMode = EPrintMode::ExecutesGroupTree;
+	FString ToSaveFileName = FString::Printf(TEXT("Mass_ProcessorExecutesGroupTree_Phase%d_"), PhaseID) + ((Options.bRuntime) ? ("Runtime.json") : ("Static.json"));
+	DoPrint(PhaseID, ToSaveFileName, Options);
 }
 
 void UMassDumpCheatManager::DumpStaticProcessorDependencyByPhaseID(int PhaseID)
 { 
-	bool bRuntime = false;
-	FString ToSaveFileName = FString::Printf(TEXT("Mass_ProcessorDependency_Phase%d_"), PhaseID) + ((bRuntime) ? ("Runtime.json") : ("Static.json"));
-	DoPrint(PhaseID, ToSaveFileName, EPrintMode::CompletelyDependency);
+	FMassPhaseDumpOptions Options;
+	FString ToSaveFileName = FString::Printf(TEXT("Mass_ProcessorDependency_Phase%d_"), PhaseID) + ((Options.bRuntime) ? ("Runtime.json") : ("Static.json"));
+	DoPrint(PhaseID, ToSaveFileName, Options);
 }
 
 void UMassDumpCheatManager::DumpRuntimeProcessorDependencyByPhaseID(int PhaseID)
 {
-	bool bRuntime = true;
-	FString ToSaveFileName = FString::Printf(TEXT("Mass_ProcessorDependency_Phase%d_"), PhaseID) + ((bRuntime) ? ("Runtime.json") : ("Static.json"));
-	DoPrint(PhaseID, ToSaveFileName, EPrintMode::CompletelyDependency);
+	FMassPhaseDumpOptions Options;
+	Options.bRuntime = true;
+	FString ToSaveFileName = FString::Printf(TEXT("Mass_ProcessorDependency_Phase%d_"), PhaseID) + ((Options.bRuntime) ? ("Runtime.json") : ("Static.json"));
+	DoPrint(PhaseID, ToSaveFileName, Options);
+}
+
+void UMassDumpCheatManager::DumpAllPhasesProcessorDependency(bool bRuntime)
+{
+	UMassSimulationSubsystem* MassSimulationSubsystem = UWorld::GetSubsystem<UMassSimulationSubsystem>(this->GetWorld());
+	check(MassSimulationSubsystem);
+	if (MassSimulationSubsystem == nullptr)
+	{
+		return;
+	}
+
+	TConstArrayView<FMassProcessingPhaseConfig> MainPhasesConfig = GET_MASS_CONFIG_VALUE(GetProcessingPhasesConfig());
+	FMassAllPhasesDependencyPrinter Printer(*MassSimulationSubsystem, MainPhasesConfig);
+	if (bRuntime)
+	{
+		FMassProcessingPhaseManager& PhaseMannager = (FMassProcessingPhaseManager&)(MassSimulationSubsystem->GetPhaseManager());
+		Printer.bIsGameRuntime = true;
+		Printer.EntityManager = PhaseMannager.GetEntityManagerRef().AsShared();
+		for (int32 PhaseID = 0; PhaseID < MainPhasesConfig.Num(); ++PhaseID)
+		{
+			GatherDynamicProcessors(*MassSimulationSubsystem, EMassProcessingPhase(PhaseID), MainPhasesConfig[PhaseID], Printer.DynamicProcessors);
+		}
+	}
+
+	TArray<uint8> DependencyBytes;
+	FMemoryWriter DependencyWriter(DependencyBytes);
+	Printer.Print(EPrintMode::CompletelyDependency, DependencyWriter);
+	SaveDumpAsync(MoveTemp(DependencyBytes), FString(TEXT("Mass_ProcessorDependency_AllPhases_")) + (bRuntime ? TEXT("Runtime.json") : TEXT("Static.json")));
+}
+
+void UMassDumpCheatManager::CaptureProcessorTimingByPhaseID(int PhaseID, int FrameCount)
+{
+	UMassSimulationSubsystem* MassSimulationSubsystem = UWorld::GetSubsystem<UMassSimulationSubsystem>(this->GetWorld());
+	check(MassSimulationSubsystem);
+	if (MassSimulationSubsystem == nullptr || PhaseID < 0 || PhaseID >= int(EMassProcessingPhase::MAX))
+	{
+		return;
+	}
+
+	if (WarnIfNoProfiledPhase(TEXT("no timings will be captured"), PhaseID))
+	{
+		return;
+	}
+
+	StartCapture(ActiveTimingCapture, MakeShared<FMassProcessorTimingCapture>(EMassProcessingPhase(PhaseID), FrameCount), &UMassDumpCheatManager::OnTimingCaptureCompleted);
+
+	UE_LOG(LogMass, Log, TEXT("Capturing processor timings of phase %d over %d frames"), PhaseID, FrameCount);
+}
+
+void UMassDumpCheatManager::StartProcessorTrace(int FrameCount)
+{
+	WarnIfNoProfiledPhase(TEXT("the trace will stay empty"));
+	StartCapture(ActiveTraceCapture, MakeShared<FMassProcessorTraceCapture>(FrameCount), &UMassDumpCheatManager::OnTraceCaptureCompleted);
+
+	UE_LOG(LogMass, Log, TEXT("Tracing Mass phases over %d frames"), FrameCount);
+}
+
+void UMassDumpCheatManager::StopProcessorTrace()
+{
+	// a completed capture is already on its way to OnTraceCaptureCompleted
+	if (ActiveTraceCapture.IsValid() == false || ActiveTraceCapture->IsCompleted())
+	{
+		return;
+	}
+	ActiveTraceCapture->Stop();
+	OnTraceCaptureCompleted(*ActiveTraceCapture);
+}
+
+void UMassDumpCheatManager::ToggleMassStats(int TopCount)
+{
+	if (LiveStats.IsValid())
+	{
+		LiveStats->Stop();
+		LiveStats.Reset();
+		return;
+	}
+
+	UWorld* World = GetWorld();
+	if (UWorld::GetSubsystem<UMassSimulationSubsystem>(World) == nullptr)
+	{
+		return;
+	}
+
+	WarnIfNoProfiledPhase(TEXT("the stats will stay empty"));
+	LiveStats = MakeShareable(new FMassProcessorLiveStats(*World, TopCount));
+	LiveStats->Start();
+}
+
+void UMassDumpCheatManager::CaptureDeferredCommands(int FrameCount)
+{
+	WarnIfNoProfiledPhase(TEXT("no commands will be attributed"));
+	StartCapture(ActiveCommandCapture, MakeShared<FMassCommandProfileCapture>(FrameCount), &UMassDumpCheatManager::OnCommandCaptureCompleted);
+
+	UE_LOG(LogMass, Log, TEXT("Capturing deferred commands of all phases over %d frames"), FrameCount);
+}
+
+void UMassDumpCheatManager::OnCommandCaptureCompleted(FMassCommandProfileCapture& Capture)
+{
+	SaveCapture(ActiveCommandCapture, Capture, TEXT("Mass_CommandProfile.json"));
+}
+
+void UMassDumpCheatManager::CaptureLODEffectiveness(int FrameCount)
+{
+	UWorld* World = GetWorld();
+	if (World == nullptr)
+	{
+		return;
+	}
+
+	WarnIfNoProfiledPhase(TEXT("processor ticks and times will stay empty"));
+	StartCapture(ActiveLODCapture, MakeShared<FMassLODTickCapture>(*World, FrameCount), &UMassDumpCheatManager::OnLODCaptureCompleted);
+
+	UE_LOG(LogMass, Log, TEXT("Sampling MassLOD over %d frames"), FrameCount);
+}
+
+void UMassDumpCheatManager::OnLODCaptureCompleted(FMassLODTickCapture& Capture)
+{
+	SaveCapture(ActiveLODCapture, Capture, TEXT("Mass_LODTick.json"));
+}
+
+void UMassDumpCheatManager::CaptureSignals(int FrameCount)
+{
+	UWorld* World = GetWorld();
+	if (World == nullptr)
+	{
+		return;
+	}
+
+	WarnIfNoProfiledPhase(TEXT("signal processor times will stay empty"));
+	StartCapture(ActiveSignalCapture, MakeShared<FMassSignalCapture>(*World, FrameCount), &UMassDumpCheatManager::OnSignalCaptureCompleted);
+
+	UE_LOG(LogMass, Log, TEXT("Capturing Mass signals over %d frames"), FrameCount);
+}
+
+void UMassDumpCheatManager::OnSignalCaptureCompleted(FMassSignalCapture& Capture)
+{
+	SaveCapture(ActiveSignalCapture, Capture, TEXT("Mass_Signals.json"));
+}
+
+void UMassDumpCheatManager::StartTelemetryRing(int SizeMB)
+{
+	if (TelemetryRing.IsValid())
+	{
+		TelemetryRing->Stop();
+		TelemetryRing.Reset();
+	}
+
+	UWorld* World = GetWorld();
+	if (UWorld::GetSubsystem<UMassSimulationSubsystem>(World) == nullptr)
+	{
+		return;
+	}
+
+	WarnIfNoProfiledPhase(TEXT("only archetype counts will be recorded"));
+	TelemetryRing = MakeShareable(new FMassTelemetryRingWriter(*World, FMassTelemetryRingWriter::GetDefaultFilePath(), int64(FMath::Max(1, SizeMB)) * 1024 * 1024));
+	if (TelemetryRing->Start() == false)
+	{
+		TelemetryRing.Reset();
+		return;
+	}
+
+	UE_LOG(LogMass, Log, TEXT("Writing Mass telemetry to %s, keeping the last %d frames"), *TelemetryRing->GetFilePath(), TelemetryRing->GetSlotCount());
+}
+
+void UMassDumpCheatManager::StopTelemetryRing()
+{
+	if (TelemetryRing.IsValid() == false)
+	{
+		return;
+	}
+	TelemetryRing->Stop();
+	UE_LOG(LogMass, Log, TEXT("Mass telemetry written to %s"), *TelemetryRing->GetFilePath());
+	TelemetryRing.Reset();
+}
+
+void UMassDumpCheatManager::OnTraceCaptureCompleted(FMassProcessorTraceCapture& Capture)
+{
+	SaveCapture(ActiveTraceCapture, Capture, FString::Printf(TEXT("Mass_Trace_%s.json"), *FDateTime::Now().ToString()));
+}
+
+void UMassDumpCheatManager::OnTimingCaptureCompleted(FMassProcessorTimingCapture& Capture)
+{
+	FMassPrintAnnotations Annotations;
+	Capture.ExportAnnotations(Annotations);
+
+	const int PhaseID = int(Capture.GetPhase());
+	FMassProcessorCostTable& CostTable = CapturedCostTables.FindOrAdd(PhaseID);
+	CostTable.CostsMs.Reset();
+	CostTable.AddFromTimingCapture(Capture);
+
+	FMassPhaseDumpOptions Options;
+	Options.Annotations = &Annotations;
+	DoPrint(PhaseID, FString::Printf(TEXT("Mass_ProcessorDependency_Phase%d_Timing.json"), PhaseID), Options);
+}
+
+void UMassDumpCheatManager::AnalyzeCriticalPathByPhaseID(int PhaseID, int WorkerCount, const FString& CostFile)
+{
+	FMassProcessorCostTable CostTable;
+	GetPhaseCostTable(PhaseID, CostFile, CostTable);
+
+	FMassPhaseDumpOptions Options;
+	Options.PrintMode = EPrintMode::CriticalPathAnalysis;
+	Options.CostTable = &CostTable;
+	Options.WorkerCount = WorkerCount;
+	DoPrint(PhaseID, FString::Printf(TEXT("Mass_ProcessorCriticalPath_Phase%d.json"), PhaseID), Options);
+}
+
+void UMassDumpCheatManager::SimulateScheduleByPhaseID(int PhaseID, int MaxCores, const FString& CostFile)
+{
+	FMassProcessorCostTable CostTable;
+	GetPhaseCostTable(PhaseID, CostFile, CostTable);
+
+	FMassPhaseDumpOptions Options;
+	Options.PrintMode = EPrintMode::ScheduleSimulation;
+	Options.CostTable = &CostTable;
+	Options.WorkerCount = MaxCores;
+	DoPrint(PhaseID, FString::Printf(TEXT("Mass_ProcessorSchedule_Phase%d.json"), PhaseID), Options);
+}
+
+void UMassDumpCheatManager::DumpProcessorGraphLayoutByPhaseID(int PhaseID, bool bRuntime)
+{
+	FMassPhaseDumpOptions Options;
+	Options.PrintMode = EPrintMode::LayeredLayout;
+	Options.bRuntime = bRuntime;
+	DoPrint(PhaseID, FString::Printf(TEXT("Mass_ProcessorLayout_Phase%d.json"), PhaseID), Options);
+
+	Options.PrintMode = EPrintMode::GraphvizDot;
+	DoPrint(PhaseID, FString::Printf(TEXT("Mass_ProcessorLayout_Phase%d.dot"), PhaseID), Options);
+}
+
+void UMassDumpCheatManager::AnalyzeProcessorConstraintsByPhaseID(int PhaseID, int CoreCount, const FString& CostFile)
+{
+	FMassProcessorCostTable CostTable;
+	GetPhaseCostTable(PhaseID, CostFile, CostTable);
+
+	FMassPhaseDumpOptions Options;
+	Options.PrintMode = EPrintMode::ConstraintAnalysis;
+	Options.CostTable = &CostTable;
+	Options.WorkerCount = CoreCount;
+	DoPrint(PhaseID, FString::Printf(TEXT("Mass_ProcessorConstraints_Phase%d.json"), PhaseID), Options);
+}
+
+void UMassDumpCheatManager::AuditGameThreadAffinity(int CoreCount, bool bRuntime, const FString& CostFile)
+{
+	UMassSimulationSubsystem* MassSimulationSubsystem = UWorld::GetSubsystem<UMassSimulationSubsystem>(this->GetWorld());
+	if (MassSimulationSubsystem == nullptr)
+	{
+		return;
+	}
+
+	// the phases are printed with a single table, a processor class in several phases gets its last captured cost
+	FMassProcessorCostTable CostTable;
+	if (CostFile.IsEmpty() == false)
+	{
+		GetPhaseCostTable(INDEX_NONE, CostFile, CostTable);
+	}
+	else
+	{
+		for (const TPair<int32, FMassProcessorCostTable>& It : CapturedCostTables)
+		{
+			CostTable.CostsMs.Append(It.Value.CostsMs);
+		}
+		if (CostTable.CostsMs.Num() == 0)
+		{
+			UE_LOG(LogMass, Log, TEXT("No processor costs captured, assuming uniform cost. Run CaptureProcessorTimingByPhaseID first for measured costs."));
+		}
+	}
+
+	TConstArrayView<FMassProcessingPhaseConfig> MainPhasesConfig = GET_MASS_CONFIG_VALUE(GetProcessingPhasesConfig());
+	FMassAllPhasesDependencyPrinter Printer(*MassSimulationSubsystem, MainPhasesConfig);
+	Printer.CostTable = &CostTable;
+	Printer.WorkerCount = CoreCount;
+	if (bRuntime)
+	{
+		FMassProcessingPhaseManager& PhaseMannager = (FMassProcessingPhaseManager&)(MassSimulationSubsystem->GetPhaseManager());
+		Printer.bIsGameRuntime = true;
+		Printer.EntityManager = PhaseMannager.GetEntityManagerRef().AsShared();
+		for (int32 PhaseID = 0; PhaseID < MainPhasesConfig.Num(); ++PhaseID)
+		{
+			GatherDynamicProcessors(*MassSimulationSubsystem, EMassProcessingPhase(PhaseID), MainPhasesConfig[PhaseID], Printer.DynamicProcessors);
+		}
+	}
+
+	TArray<uint8> AuditBytes;
+	FMemoryWriter AuditWriter(AuditBytes);
+	Printer.Print(EPrintMode::GameThreadAudit, AuditWriter);
+	SaveDumpAsync(MoveTemp(AuditBytes), FString(TEXT("Mass_GameThreadAudit_AllPhases_")) + (bRuntime ? TEXT("Runtime.json") : TEXT("Static.json")));
+}
+
+void UMassDumpCheatManager::GetPhaseCostTable(int PhaseID, const FString& CostFile, FMassProcessorCostTable& OutCostTable) const
+{
+	if (CostFile.IsEmpty() == false)
+	{
+		const FString CostFilePath = FPaths::IsRelative(CostFile) ? FPaths::ProjectSavedDir() / CostFile : CostFile;
+		if (OutCostTable.LoadFromJsonFile(CostFilePath))
+		{
+			return;
+		}
+	}
+
+	if (const FMassProcessorCostTable* CapturedCostTable = CapturedCostTables.Find(PhaseID))
+	{
+		OutCostTable = *CapturedCostTable;
+		return;
+	}
+
+	UE_LOG(LogMass, Log, TEXT("No processor costs available for phase %d, assuming uniform cost. Run CaptureProcessorTimingByPhaseID first for measured costs."), PhaseID);
 }
 
-void UMassDumpCheatManager::DoPrint(int PhaseID, FString& ToSaveFileName, EPrintMode PrintMode)
+void UMassDumpCheatManager::GatherDynamicProcessors(UMassSimulationSubsystem& MassSimulationSubsystem, const EMassProcessingPhase Phase, const FMassProcessingPhaseConfig& PhaseConfig
+	, TArray<UMassProcessor*>& OutDynamicProcessors) const
 {
+	UMassCompositeProcessor* PhaseProcessor = UMassProfiledCompositeProcessor::FindPhaseProcessor(MassSimulationSubsystem, Phase);
+	if (PhaseProcessor == nullptr)
+	{
+		return;
+	}
+
+	// whatever the live phase runs on top of the configured processors was registered dynamically
+	TMap<const UClass*, int32> ConfiguredCounts;
+	for (const UMassProcessor* ProcessorCDO : PhaseConfig.ProcessorCDOs)
+	{
+		if (ProcessorCDO)
+		{
+			++ConfiguredCounts.FindOrAdd(ProcessorCDO->GetClass());
+		}
+	}
+	for (UMassProcessor* Processor : PhaseProcessor->GetChildProcessorsView())
+	{
+		int32* ConfiguredCount = Processor ? ConfiguredCounts.Find(Processor->GetClass()) : nullptr;
+		if (ConfiguredCount && *ConfiguredCount > 0)
+		{
+			--(*ConfiguredCount);
+		}
+		else if (Processor)
+		{
+			OutDynamicProcessors.Add(Processor);
+		}
+	}
+}
+
+void UMassDumpCheatManager::DoPrint(int PhaseID, const FString& ToSaveFileName, const FMassPhaseDumpOptions& Options)
+{
+	// every ByPhaseID exec ends up here with whatever the console passed
+	if (PhaseID < 0 || PhaseID >= int(EMassProcessingPhase::MAX))
+	{
+		UE_LOG(LogMass, Warning, TEXT("%s phase %d doesn't exist, expected 0..%d"), ANSI_TO_TCHAR(__FUNCTION__), PhaseID, int(EMassProcessingPhase::MAX) - 1);
+		return;
+	}
+
 	UMassSimulationSubsystem* MassSimulationSubsystem = UWorld::GetSubsystem<UMassSimulationSubsystem>(this->GetWorld());
 	check(MassSimulationSubsystem);
 	if (MassSimulationSubsystem)
@@ -59,15 +500,58 @@ void UMassDumpCheatManager::DoPrint(int PhaseID, FString& ToSaveFileName, EPrint
 			, *FString::Printf(TEXT("GMTmp_ProcessingPhase_%s"), *UEnum::GetDisplayValueAsText(Phase).ToString()));
 
 
+		// runtime mode solves like the phase manager does: live archetypes prune processors with nothing to do
+		TSharedPtr<FMassEntityManager> RuntimeEntityManager;
+		TArray<UMassProcessor*> DynamicProcessors;
+		if (Options.bRuntime)
+		{
+			RuntimeEntityManager = EntityManager.AsShared();
+			GatherDynamicProcessors(*MassSimulationSubsystem, Phase, TargetPhaseConfig, DynamicProcessors);
+		}
+
 		FMassProcessorDependencySolverPrinterImpl::FResult Result;
 		FMassPhaseProcessorDependencyPrinter Configurator(*PhaseProcessor, TargetPhaseConfig, *MassSimulationSubsystem, EMassProcessingPhase(PhaseID));
-		Configurator.bIsGameRuntime = false;
+		Configurator.bIsGameRuntime = Options.bRuntime;
+		Configurator.Annotations = Options.Annotations;
+		Configurator.CostTable = Options.CostTable;
+		Configurator.WorkerCount = Options.WorkerCount;
 
-		FString DependencyString;
-		Configurator.Print(PrintMode, DependencyString, {}, /*EntityManager=*/nullptr, &Result);
+		TArray<uint8> DependencyBytes;
+		FMemoryWriter DependencyWriter(DependencyBytes);
+		Configurator.Print(Options.PrintMode, DependencyWriter, DynamicProcessors, RuntimeEntityManager, &Result);
 
-		UE_LOG(LogMass, Log, TEXT("%s"), *DependencyString);
-		FString SavePath = FPaths::ProjectSavedDir() / ToSaveFileName;
-		FFileHelper::SaveStringToFile(DependencyString, *SavePath);
+		SaveDumpAsync(MoveTemp(DependencyBytes), ToSaveFileName);
 	}
 }
+
+void UMassDumpCheatManager::DumpArchetypeMemory()
+{
+	UMassEntitySubsystem* EntitySubsystem = UWorld::GetSubsystem<UMassEntitySubsystem>(this->GetWorld());
+	if (EntitySubsystem == nullptr)
+	{
+		return;
+	}
+
+	FMassArchetypeMemoryReport Report;
+	Report.Gather(EntitySubsystem->GetEntityManager());
+
+	TArray<uint8> ReportBytes;
+	FMemoryWriter ReportWriter(ReportBytes);
+	Report.Write(ReportWriter);
+	SaveDumpAsync(MoveTemp(ReportBytes), TEXT("Mass_ArchetypeMemory.json"));
+}
+
+void UMassDumpCheatManager::SaveDumpAsync(TArray<uint8>&& Bytes, const FString& ToSaveFileName)
+{
+	FString SavePath = FPaths::ProjectSavedDir() / ToSaveFileName;
+	UE_LOG(LogMass, Log, TEXT("%s writing %d bytes to %s"), ANSI_TO_TCHAR(__FUNCTION__), Bytes.Num(), *SavePath);
+
+	// dumps can be several MB for big phases, keep the disk write off the game thread
+	Async(EAsyncExecution::ThreadPool, [Bytes = MoveTemp(Bytes), SavePath]()
+	{
+		if (FFileHelper::SaveArrayToFile(Bytes, *SavePath) == false)
+		{
+			UE_LOG(LogMass, Warning, TEXT("Failed to save %s"), *SavePath);
+		}
+	});
+}
@@ -1,14 +1,63 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "MassHelper.h"
+#include "HAL/IConsoleManager.h"
 #include "Interfaces/IPluginManager.h"
+#include "MassEntitySettings.h"
+#include "MassHelper/Public/Processor/MassProfiledCompositeProcessor.h"
 
 IMPLEMENT_MODULE(FMassHelper, MassHelper);
 
+namespace UE::MassHelper::Private
+{
+	bool bProfiledPhases = false;
+	FAutoConsoleVariableRef CVarProfiledPhases(TEXT("mass.helper.ProfiledPhases"), bProfiledPhases,
+		TEXT("Runs the phases of worlds initialized from now on through UMassProfiledCompositeProcessor, which the MassHelper captures need. ")
+		TEXT("Set it in the ConsoleVariables ini section or with -dpcvars to cover the first world."));
+}
+
 void FMassHelper::StartupModule()
 {
+#if !UE_BUILD_SHIPPING
+	PreWorldInitializationHandle = FWorldDelegates::OnPreWorldInitialization.AddRaw(this, &FMassHelper::OnPreWorldInitialization);
+	PostWorldInitializationHandle = FWorldDelegates::OnPostWorldInitialization.AddRaw(this, &FMassHelper::OnPostWorldInitialization);
+#endif // !UE_BUILD_SHIPPING
 }
 
 void FMassHelper::ShutdownModule()
 {
-}
\ No newline at end of file
+	FWorldDelegates::OnPreWorldInitialization.Remove(PreWorldInitializationHandle);
+	FWorldDelegates::OnPostWorldInitialization.Remove(PostWorldInitializationHandle);
+}
+
+void FMassHelper::OnPreWorldInitialization(UWorld* World, const UWorld::InitializationValues IVS)
+{
+	if (UE::MassHelper::Private::bProfiledPhases == false)
+	{
+		return;
+	}
+
+	// the simulation subsystem copies the phase config while the world's subsystems initialize. The settings only
+	// hold the profiled class for that long, so neither other worlds nor a config save ever see it. Phases configured
+	// with a custom group class are left alone, those just won't report to FMassProcessorProfiler.
+	UMassEntitySettings* Settings = GetMutableDefault<UMassEntitySettings>();
+	for (int32 PhaseIndex = 0; PhaseIndex < int32(UE_ARRAY_COUNT(Settings->ProcessingPhasesConfig)); ++PhaseIndex)
+	{
+		FMassProcessingPhaseConfig& PhaseConfig = Settings->ProcessingPhasesConfig[PhaseIndex];
+		if (PhaseConfig.PhaseGroupClass == UMassCompositeProcessor::StaticClass())
+		{
+			PhaseConfig.PhaseGroupClass = UMassProfiledCompositeProcessor::StaticClass();
+			SwappedPhases.Add(PhaseIndex);
+		}
+	}
+}
+
+void FMassHelper::OnPostWorldInitialization(UWorld* World, const UWorld::InitializationValues IVS)
+{
+	UMassEntitySettings* Settings = GetMutableDefault<UMassEntitySettings>();
+	for (const int32 PhaseIndex : SwappedPhases)
+	{
+		Settings->ProcessingPhasesConfig[PhaseIndex].PhaseGroupClass = UMassCompositeProcessor::StaticClass();
+	}
+	SwappedPhases.Reset();
+}
@@ -0,0 +1,163 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+#include "MassHelper/Public/Processor/MassAllPhasesDependencyPrinter.h"
+
+#include "MassEntity/Public/MassEntityManager.h"
+#include "Serialization/MemoryWriter.h"
+
+FMassAllPhasesDependencyPrinter::FMassAllPhasesDependencyPrinter(UObject& InProcessorOuter, TConstArrayView<FMassProcessingPhaseConfig> InPhasesConfig)
+	: ProcessorOuter(InProcessorOuter)
+	, PhasesConfig(InPhasesConfig)
+{
+}
+
+void FMassAllPhasesDependencyPrinter::InstantiateProcessors(TArray<TArray<UMassProcessor*>>& OutPhaseInstances)
+{
+	TMap<const UClass*, UMassProcessor*> InstancesByClass;
+	OutPhaseInstances.SetNum(PhasesConfig.Num());
+	for (int32 PhaseIndex = 0; PhaseIndex < PhasesConfig.Num(); ++PhaseIndex)
+	{
+		for (const UMassProcessor* ProcessorCDO : PhasesConfig[PhaseIndex].ProcessorCDOs)
+		{
+			if (ProcessorCDO == nullptr)
+			{
+				continue;
+			}
+			UMassProcessor*& Instance = InstancesByClass.FindOrAdd(ProcessorCDO->GetClass());
+			if (Instance == nullptr)
+			{
+				Instance = NewObject<UMassProcessor>(&ProcessorOuter, ProcessorCDO->GetClass());
+			}
+			OutPhaseInstances[PhaseIndex].AddUnique(Instance);
+		}
+	}
+}
+
+void FMassAllPhasesDependencyPrinter::Print(EPrintMode PrintMode, FArchive& OutputArchive)
+{
+	check(IsInGameThread());
+
+	TArray<TArray<UMassProcessor*>> PhaseInstances;
+	InstantiateProcessors(PhaseInstances);
+
+	TArray<UMassCompositeProcessor*> PhaseProcessors;
+	for (int32 PhaseIndex = 0; PhaseIndex < PhasesConfig.Num(); ++PhaseIndex)
+	{
+		PhaseProcessors.Add(NewObject<UMassCompositeProcessor>(&ProcessorOuter, UMassCompositeProcessor::StaticClass()
+			, *FString::Printf(TEXT("GMTmp_ProcessingPhase_%d"), PhaseIndex)));
+	}
+
+	// solving caches archetypes in the processors' queries, shared by every phase listing the same class, and the
+	// solver overrides the global LogMass verbosity. The phases are solved one after another here, only writing the
+	// solved phases, the bulk of the analysis modes, runs concurrently.
+	TArray<TUniquePtr<FMassSolvedProcessorPhase>> SolvedPhases;
+	TArray<FMassPhaseProcessorDependencyPrinter> Configurators;
+	Configurators.Reserve(PhasesConfig.Num());
+	{
+		FScopedCategoryAndVerbosityOverride LogOverride(TEXT("LogMass"), ELogVerbosity::Log);
+		for (int32 PhaseIndex = 0; PhaseIndex < PhasesConfig.Num(); ++PhaseIndex)
+		{
+			FMassPhaseProcessorDependencyPrinter& Configurator = Configurators.Emplace_GetRef(*PhaseProcessors[PhaseIndex], PhasesConfig[PhaseIndex], ProcessorOuter, EMassProcessingPhase(PhaseIndex));
+			Configurator.bIsGameRuntime = bIsGameRuntime;
+			Configurator.Annotations = Annotations;
+			Configurator.CostTable = CostTable;
+			Configurator.WorkerCount = WorkerCount;
+			Configurator.ProcessorInstances = PhaseInstances[PhaseIndex];
+
+			TUniquePtr<FMassSolvedProcessorPhase>& Solved = SolvedPhases.Add_GetRef(MakeUnique<FMassSolvedProcessorPhase>());
+			Configurator.Solve(PrintMode, *Solved, DynamicProcessors, EntityManager, nullptr);
+		}
+	}
+
+	TArray<TArray<uint8>> PhaseDocuments;
+	PhaseDocuments.SetNum(PhasesConfig.Num());
+	FGraphEventArray Events;
+	for (int32 PhaseIndex = 0; PhaseIndex < PhasesConfig.Num(); ++PhaseIndex)
+	{
+		Events.Add(FFunctionGraphTask::CreateAndDispatchWhenReady(
+			[PrintMode, PhaseIndex, &Configurators, &SolvedPhases, &PhaseDocuments]()
+			{
+				FMemoryWriter PhaseWriter(PhaseDocuments[PhaseIndex]);
+				Configurators[PhaseIndex].Write(PrintMode, *SolvedPhases[PhaseIndex], PhaseWriter);
+			}
+			, TStatId(), nullptr, ENamedThreads::AnyHiPriThreadNormalTask));
+	}
+	FTaskGraphInterface::Get().WaitUntilTasksComplete(Events, ENamedThreads::GameThread);
+
+	FMassDependencyJsonWriter Writer(OutputArchive);
+	Writer.BeginObject();
+	Writer.WriteStringField(TEXT("PrintMode"), TEXT("AllPhases"));
+
+	Writer.WriteKey(TEXT("Phases"));
+	Writer.BeginArray();
+	for (int32 PhaseIndex = 0; PhaseIndex < PhasesConfig.Num(); ++PhaseIndex)
+	{
+		Writer.BeginObject();
+		Writer.WriteNumberField(TEXT("PhaseID"), PhaseIndex);
+		Writer.WriteStringField(TEXT("Phase"), UEnum::GetDisplayValueAsText(EMassProcessingPhase(PhaseIndex)).ToString());
+		Writer.WriteKey(TEXT("Dependency"));
+		if (PhaseDocuments[PhaseIndex].Num())
+		{
+			Writer.WriteRawValue(PhaseDocuments[PhaseIndex]);
+		}
+		else
+		{
+			// a phase without processors prints nothing
+			Writer.BeginArray();
+			Writer.EndArray();
+		}
+		Writer.EndObject();
+	}
+	Writer.EndArray();
+
+	WriteCrossPhase(Writer, PhaseInstances);
+	Writer.EndObject();
+}
+
+void FMassAllPhasesDependencyPrinter::WriteCrossPhase(FMassDependencyJsonWriter& Writer, const TArray<TArray<UMassProcessor*>>& PhaseInstances) const
+{
+	TMap<FName, TArray<int32>> ClassPhases;
+	for (int32 PhaseIndex = 0; PhaseIndex < PhaseInstances.Num(); ++PhaseIndex)
+	{
+		for (const UMassProcessor* Processor : PhaseInstances[PhaseIndex])
+		{
+			ClassPhases.FindOrAdd(Processor->GetClass()->GetFName()).AddUnique(PhaseIndex);
+		}
+	}
+	for (const UMassProcessor* Processor : DynamicProcessors)
+	{
+		const int32 PhaseIndex = int32(Processor->GetProcessingPhase());
+		if (PhasesConfig.IsValidIndex(PhaseIndex))
+		{
+			ClassPhases.FindOrAdd(Processor->GetClass()->GetFName()).AddUnique(PhaseIndex);
+		}
+	}
+	ClassPhases.KeySort(FNameLexicalLess());
+
+	Writer.WriteKey(TEXT("CrossPhase"));
+	Writer.BeginObject();
+
+	int32 MultiPhaseCount = 0;
+	Writer.WriteKey(TEXT("Processors"));
+	Writer.BeginArray();
+	for (TPair<FName, TArray<int32>>& It : ClassPhases)
+	{
+		It.Value.Sort();
+		MultiPhaseCount += It.Value.Num() > 1 ? 1 : 0;
+
+		Writer.BeginObject();
+		Writer.WriteNameField(TEXT("Class"), It.Key);
+		Writer.WriteKey(TEXT("Phases"));
+		Writer.BeginArray();
+		for (const int32 PhaseIndex : It.Value)
+		{
+			Writer.WriteNumber(PhaseIndex);
+		}
+		Writer.EndArray();
+		Writer.EndObject();
+	}
+	Writer.EndArray();
+
+	Writer.WriteNumberField(TEXT("ProcessorClassCount"), ClassPhases.Num());
+	Writer.WriteNumberField(TEXT("MultiPhaseClassCount"), MultiPhaseCount);
+	Writer.EndObject();
+}
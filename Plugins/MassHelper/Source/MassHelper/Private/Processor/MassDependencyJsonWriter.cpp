@@ -0,0 +1,186 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+#include "MassHelper/Public/Processor/MassDependencyJsonWriter.h"
+
+FMassDependencyJsonWriter::FMassDependencyJsonWriter(FArchive& InArchive)
+	: Archive(InArchive)
+{
+}
+
+void FMassDependencyJsonWriter::WriteRaw(const ANSICHAR* Data, const int32 Length)
+{
+	Archive.Serialize(const_cast<ANSICHAR*>(Data), Length);
+}
+
+void FMassDependencyJsonWriter::BeginValue()
+{
+	if (bAfterKey)
+	{
+		bAfterKey = false;
+		return;
+	}
+	if (ScopeIsEmpty.Num())
+	{
+		if (ScopeIsEmpty.Last() == false)
+		{
+			WriteRaw(",", 1);
+		}
+		ScopeIsEmpty.Last() = false;
+	}
+}
+
+void FMassDependencyJsonWriter::BeginObject()
+{
+	BeginValue();
+	WriteRaw("{", 1);
+	ScopeIsEmpty.Push(true);
+}
+
+void FMassDependencyJsonWriter::EndObject()
+{
+	check(ScopeIsEmpty.Num() && bAfterKey == false);
+	ScopeIsEmpty.Pop(/*bAllowShrinking=*/false);
+	WriteRaw("}", 1);
+}
+
+void FMassDependencyJsonWriter::BeginArray()
+{
+	BeginValue();
+	WriteRaw("[", 1);
+	ScopeIsEmpty.Push(true);
+}
+
+void FMassDependencyJsonWriter::EndArray()
+{
+	check(ScopeIsEmpty.Num() && bAfterKey == false);
+	ScopeIsEmpty.Pop(/*bAllowShrinking=*/false);
+	WriteRaw("]", 1);
+}
+
+void FMassDependencyJsonWriter::WriteKey(FStringView Key)
+{
+	check(bAfterKey == false);
+	BeginValue();
+	Scratch.Reset();
+	AppendEscaped(Key, Scratch);
+	Scratch.Add(':');
+	WriteRaw(Scratch.GetData(), Scratch.Num());
+	bAfterKey = true;
+}
+
+void FMassDependencyJsonWriter::WriteString(FStringView Value)
+{
+	BeginValue();
+	Scratch.Reset();
+	AppendEscaped(Value, Scratch);
+	WriteRaw(Scratch.GetData(), Scratch.Num());
+}
+
+void FMassDependencyJsonWriter::WriteName(const FName Name)
+{
+	BeginValue();
+	TArray<ANSICHAR>* Interned = NameTable.Find(Name);
+	if (Interned == nullptr)
+	{
+		TCHAR NameBuffer[NAME_SIZE];
+		const uint32 NameLength = Name.ToString(NameBuffer);
+		Interned = &NameTable.Add(Name);
+		AppendEscaped(FStringView(NameBuffer, NameLength), *Interned);
+	}
+	WriteRaw(Interned->GetData(), Interned->Num());
+}
+
+void FMassDependencyJsonWriter::WriteNumber(const double Value)
+{
+	BeginValue();
+	ANSICHAR Buffer[64];
+	int32 Length = 0;
+	if (FMath::IsFinite(Value) == false)
+	{
+		// json has no representation for inf/nan
+		Length = FCStringAnsi::Snprintf(Buffer, UE_ARRAY_COUNT(Buffer), "null");
+	}
+	else if (Value == FMath::RoundToDouble(Value) && FMath::Abs(Value) < 1e15)
+	{
+		Length = FCStringAnsi::Snprintf(Buffer, UE_ARRAY_COUNT(Buffer), "%lld", (long long)Value);
+	}
+	else
+	{
+		Length = FCStringAnsi::Snprintf(Buffer, UE_ARRAY_COUNT(Buffer), "%.9g", Value);
+	}
+	WriteRaw(Buffer, Length);
+}
+
+void FMassDependencyJsonWriter::WriteBool(const bool bValue)
+{
+	BeginValue();
+	WriteRaw(bValue ? "true" : "false");
+}
+
+void FMassDependencyJsonWriter::WriteNull()
+{
+	BeginValue();
+	WriteRaw("null", 4);
+}
+
+void FMassDependencyJsonWriter::WriteRawValue(TConstArrayView<uint8> Utf8Json)
+{
+	if (Utf8Json.Num() == 0)
+	{
+		WriteNull();
+		return;
+	}
+	BeginValue();
+	WriteRaw(reinterpret_cast<const ANSICHAR*>(Utf8Json.GetData()), Utf8Json.Num());
+}
+
+void FMassDependencyJsonWriter::AppendEscaped(FStringView Value, TArray<ANSICHAR>& OutUtf8)
+{
+	OutUtf8.Add('"');
+	for (int32 CharIndex = 0; CharIndex < Value.Len(); ++CharIndex)
+	{
+		const TCHAR Char = Value[CharIndex];
+		switch (Char)
+		{
+		case TCHAR('"'):
+			OutUtf8.Append("\\\"", 2);
+			break;
+		case TCHAR('\\'):
+			OutUtf8.Append("\\\\", 2);
+			break;
+		case TCHAR('\n'):
+			OutUtf8.Append("\\n", 2);
+			break;
+		case TCHAR('\r'):
+			OutUtf8.Append("\\r", 2);
+			break;
+		case TCHAR('\t'):
+			OutUtf8.Append("\\t", 2);
+			break;
+		default:
+			if (Char < 0x20)
+			{
+				ANSICHAR Escaped[8];
+				const int32 Length = FCStringAnsi::Snprintf(Escaped, UE_ARRAY_COUNT(Escaped), "\\u%04x", uint32(Char));
+				OutUtf8.Append(Escaped, Length);
+			}
+			else if (Char < 0x80)
+			{
+				OutUtf8.Add(ANSICHAR(Char));
+			}
+			else
+			{
+				// convert the whole non-ascii run at once so surrogate pairs stay together
+				int32 RunEnd = CharIndex + 1;
+				while (RunEnd < Value.Len() && Value[RunEnd] >= 0x80)
+				{
+					++RunEnd;
+				}
+				const FTCHARToUTF8 Utf8(Value.GetData() + CharIndex, RunEnd - CharIndex);
+				OutUtf8.Append(Utf8.Get(), Utf8.Length());
+				CharIndex = RunEnd - 1;
+			}
+			break;
+		}
+	}
+	OutUtf8.Add('"');
+}
@@ -1,75 +1,163 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 #include "MassHelper/Public/Processor/MassProcessorDependencyPrinter.h"
+#include "MassHelper/Public/Analysis/MassProcessorGraph.h"
+#include "MassHelper/Public/Analysis/MassProcessorDependencyReasons.h"
+#include "MassHelper/Public/Analysis/MassProcessorScheduleSimulation.h"
+#include "MassHelper/Public/Analysis/MassArchetypeMemoryReport.h"
+#include "MassHelper/Public/Analysis/MassProcessorGraphLayout.h"
+#include "MassHelper/Public/Analysis/MassProcessorConstraintAnalysis.h"
+#include "MassHelper/Public/Analysis/MassGameThreadAudit.h"
+#include "MassHelper/Public/Analysis/MassArchetypeMatchIndex.h"
+
+#include "MassEntity/Public/MassArchetypeData.h"
+
+#include "HAL/IConsoleManager.h"
+#include "Serialization/MemoryWriter.h"
 
 namespace UE::MassHelper::Private
 {
-	FString NameViewToString(TConstArrayView<FName> View)
+	bool bVerifyArchetypeMatchIndex = false;
+	FAutoConsoleVariableRef CVarVerifyArchetypeMatchIndex(TEXT("mass.helper.VerifyArchetypeMatchIndex"), bVerifyArchetypeMatchIndex,
+		TEXT("Checks every processor's archetypes matched through FMassArchetypeMatchIndex against GetArchetypesMatchingOwnedQueries when printing dependencies."));
+
+	/** Logs the processors the index and the engine's own query matching disagree on. */
+	void VerifyArchetypeMatchIndex(UMassProcessor& Processor, const FMassEntityManager& EntityManager, TConstArrayView<FMassArchetypeHandle> IndexArchetypes)
 	{
-		if (View.Num() == 0)
+		TArray<FMassArchetypeHandle> QueryArchetypes;
+		Processor.GetArchetypesMatchingOwnedQueries(EntityManager, QueryArchetypes);
+		const TSet<FMassArchetypeHandle> IndexSet(IndexArchetypes);
+		const TSet<FMassArchetypeHandle> QuerySet(QueryArchetypes);
+		if (IndexSet.Num() != IndexArchetypes.Num() || IndexSet.Num() != QuerySet.Num() || IndexSet.Includes(QuerySet) == false)
 		{
-			return TEXT("[]");
+			UE_LOG(LogMass, Error, TEXT("%s: %s matches %d archetypes through the index, %d through its queries")
+				, ANSI_TO_TCHAR(__FUNCTION__), *Processor.GetName(), IndexArchetypes.Num(), QuerySet.Num());
 		}
-		FString ReturnVal = FString::Printf(TEXT("[%s"), *View[0].ToString());
-		for (int i = 1; i < View.Num(); ++i)
-		{
-			ReturnVal += FString::Printf(TEXT(", %s"), *View[i].ToString());
-		}
-		return ReturnVal + TEXT("]");
 	}
 }
 
-void FMassPhaseProcessorDependencyPrinter::Print(EPrintMode PrintMode, FString& OutputString, TArrayView<UMassProcessor*> DynamicProcessors, const TSharedPtr<FMassEntityManager>& EntityManager, FMassProcessorDependencySolver::FResult* OutOptionalResult)
+void FMassPrintAnnotations::WriteNodeFields(FMassDependencyJsonWriter& Writer, const FName NodeName) const
 {
-    switch (PrintMode)
+    if (Base)
     {
-    case EPrintMode::ExecutesGroupTree:
-        PrintExecutesGroupTree(OutputString, DynamicProcessors, EntityManager, OutOptionalResult);
-        break;
-    case EPrintMode::CompletelyDependency:
-        PrintCompletelyDependency(OutputString, DynamicProcessors, EntityManager, OutOptionalResult);
-        break;
-    default:
-        break;
+        Base->WriteNodeFields(Writer, NodeName);
+    }
+    for (const FNodeWriter& NodeWriter : NodeWriters)
+    {
+        NodeWriter(Writer, NodeName);
     }
 }
 
-void FMassPhaseProcessorDependencyPrinter::PrintExecutesGroupTree(FString& OutputString, TArrayView<UMassProcessor*> DynamicProcessors, const TSharedPtr<FMassEntityManager>& EntityManager, FMassProcessorDependencySolver::FResult* OutOptionalResult)
+void FMassPrintAnnotations::WriteRootFields(FMassDependencyJsonWriter& Writer) const
 {
-    FMassRuntimePipeline TmpPipeline;
-    TmpPipeline.CreateFromArray(PhaseConfig.ProcessorCDOs, ProcessorOuter);
-    for (UMassProcessor* Processor : DynamicProcessors)
+    if (Base)
     {
-        checkf(Processor != nullptr, TEXT("Dynamic processor provided to MASS is null."));
-        if (Processor->GetProcessingPhase() == Phase)
-        {
-            TmpPipeline.AppendProcessor(*Processor);
-        }
+        Base->WriteRootFields(Writer);
+    }
+    for (const FRootWriter& RootWriter : RootWriters)
+    {
+        RootWriter(Writer);
     }
+}
+
+void FMassPhaseProcessorDependencyPrinter::Print(EPrintMode PrintMode, FString& OutputString, TArrayView<UMassProcessor*> DynamicProcessors, const TSharedPtr<FMassEntityManager>& EntityManager, FMassProcessorDependencySolver::FResult* OutOptionalResult)
+{
+    TArray<uint8> Utf8Bytes;
+    FMemoryWriter Writer(Utf8Bytes);
+    Print(PrintMode, Writer, DynamicProcessors, EntityManager, OutOptionalResult);
+    OutputString = FString(FUTF8ToTCHAR(reinterpret_cast<const ANSICHAR*>(Utf8Bytes.GetData()), Utf8Bytes.Num()));
+}
+
+void FMassPhaseProcessorDependencyPrinter::Print(EPrintMode PrintMode, FArchive& OutputArchive, TArrayView<UMassProcessor*> DynamicProcessors, const TSharedPtr<FMassEntityManager>& EntityManager, FMassProcessorDependencySolver::FResult* OutOptionalResult)
+{
+	FMassSolvedProcessorPhase Solved;
+	Solve(PrintMode, Solved, DynamicProcessors, EntityManager, OutOptionalResult);
+	Write(PrintMode, Solved, OutputArchive);
+}
+
+void FMassPhaseProcessorDependencyPrinter::Solve(EPrintMode PrintMode, FMassSolvedProcessorPhase& OutSolved, TArrayView<UMassProcessor*> DynamicProcessors, const TSharedPtr<FMassEntityManager>& EntityManager, FMassProcessorDependencySolver::FResult* OutOptionalResult)
+{
+	CreateTmpPipeline(OutSolved.Pipeline, DynamicProcessors);
+	FMassProcessorDependencySolverPrinterImpl& Solver = OutSolved.Solver.Emplace(OutSolved.Pipeline.GetMutableProcessors(), bIsGameRuntime);
+
+	if (PrintMode == EPrintMode::ExecutesGroupTree)
+	{
+		Solver.ResolveExecutesGroupTree(EntityManager, OutOptionalResult);
+		OutSolved.PrintAnnotations = Annotations;
+		return;
+	}
+
+	ResolveDependencies(Solver, OutSolved.Pipeline, OutSolved.SortedProcessors, EntityManager, OutOptionalResult);
+	OutSolved.PrintAnnotations = GetPrintAnnotations(Solver, EntityManager, OutSolved.RuntimeAnnotations);
+}
+
+void FMassPhaseProcessorDependencyPrinter::Write(EPrintMode PrintMode, FMassSolvedProcessorPhase& Solved, FArchive& OutputArchive) const
+{
+	check(Solved.Solver.IsSet());
+	FMassProcessorDependencySolverPrinterImpl& Solver = Solved.Solver.GetValue();
 
-    FMassProcessorDependencySolverPrinterImpl Solver(TmpPipeline.GetMutableProcessors(), bIsGameRuntime);
-    Solver.ResolveExecutesGroupTree(EntityManager, OutOptionalResult);
-    Solver.PrintExecutesGroupTree(OutputString);
+	const FMassProcessorCostTable DefaultCostTable;
+	const FMassProcessorCostTable& Costs = CostTable ? *CostTable : DefaultCostTable;
+	switch (PrintMode)
+	{
+	case EPrintMode::ExecutesGroupTree:
+		Solver.PrintExecutesGroupTree(OutputArchive, Solved.PrintAnnotations);
+		break;
+	case EPrintMode::CompletelyDependency:
+		Solver.PrintCompletelyDependency(OutputArchive, Solved.PrintAnnotations, Solved.SortedProcessors);
+		break;
+	case EPrintMode::CriticalPathAnalysis:
+		Solver.PrintCriticalPathAnalysis(OutputArchive, Solved.SortedProcessors, Costs, GetEffectiveWorkerCount(), Solved.PrintAnnotations);
+		break;
+	case EPrintMode::ScheduleSimulation:
+		Solver.PrintScheduleSimulation(OutputArchive, Solved.SortedProcessors, Costs, GetEffectiveWorkerCount(), Solved.PrintAnnotations);
+		break;
+	case EPrintMode::LayeredLayout:
+		Solver.PrintLayeredLayout(OutputArchive, Solved.SortedProcessors, Solved.PrintAnnotations);
+		break;
+	case EPrintMode::GraphvizDot:
+		Solver.PrintGraphvizDot(OutputArchive, Solved.SortedProcessors);
+		break;
+	case EPrintMode::ConstraintAnalysis:
+		Solver.PrintConstraintAnalysis(OutputArchive, Solved.SortedProcessors, Costs, GetEffectiveWorkerCount(), Solved.PrintAnnotations);
+		break;
+	case EPrintMode::GameThreadAudit:
+		Solver.PrintGameThreadAudit(OutputArchive, Solved.SortedProcessors, Costs, GetEffectiveWorkerCount(), Solved.PrintAnnotations);
+		break;
+	default:
+		break;
+	}
 }
 
-void FMassPhaseProcessorDependencyPrinter::PrintCompletelyDependency(FString& OutputString, TArrayView<UMassProcessor*> DynamicProcessors, const TSharedPtr<FMassEntityManager>& EntityManager, FMassProcessorDependencySolver::FResult* OutOptionalResult)
+void FMassPhaseProcessorDependencyPrinter::CreateTmpPipeline(FMassRuntimePipeline& OutPipeline, TArrayView<UMassProcessor*> DynamicProcessors)
 {
-	FMassRuntimePipeline TmpPipeline;
-	TmpPipeline.CreateFromArray(PhaseConfig.ProcessorCDOs, ProcessorOuter);
+	if (ProcessorInstances.Num())
+	{
+		for (UMassProcessor* Processor : ProcessorInstances)
+		{
+			OutPipeline.AppendProcessor(*Processor);
+		}
+	}
+	else
+	{
+		OutPipeline.CreateFromArray(PhaseConfig.ProcessorCDOs, ProcessorOuter);
+	}
 	for (UMassProcessor* Processor : DynamicProcessors)
 	{
 		checkf(Processor != nullptr, TEXT("Dynamic processor provided to MASS is null."));
 		if (Processor->GetProcessingPhase() == Phase)
 		{
-			TmpPipeline.AppendProcessor(*Processor);
+			OutPipeline.AppendProcessor(*Processor);
 		}
 	}
+}
 
-	TArray<FMassProcessorOrderInfo> SortedProcessors;
-	FMassProcessorDependencySolverPrinterImpl Solver(TmpPipeline.GetMutableProcessors(), bIsGameRuntime);
-
-	Solver.ResolveDependencies(SortedProcessors, EntityManager, OutOptionalResult);
+void FMassPhaseProcessorDependencyPrinter::ResolveDependencies(FMassProcessorDependencySolverPrinterImpl& Solver, FMassRuntimePipeline& TmpPipeline, TArray<FMassProcessorOrderInfo>& OutSortedProcessors, const TSharedPtr<FMassEntityManager>& EntityManager, FMassProcessorDependencySolver::FResult* OutOptionalResult)
+{
+	// the engine solver matches and prunes through the processors' queries, FMassArchetypeMatchIndex only speeds up
+	// ResolveExecutesGroupTree
+	Solver.ResolveDependencies(OutSortedProcessors, EntityManager, OutOptionalResult);
 
-	for (const FMassProcessorOrderInfo& ProcessorOrderInfo : SortedProcessors)
+	for (const FMassProcessorOrderInfo& ProcessorOrderInfo : OutSortedProcessors)
 	{
 		TmpPipeline.RemoveProcessor(*ProcessorOrderInfo.Processor);
 	}
@@ -82,8 +170,24 @@ void FMassPhaseProcessorDependencyPrinter::PrintCompletelyDependency(FString& Ou
 			UE_VLOG_UELOG(&PhaseProcessor, LogMass, Verbose, TEXT("\t%s"), *Processor->GetProcessorName());
 		}
 	}
+}
 
-	Solver.PrintCompletelyDependency(OutputString);
+int32 FMassPhaseProcessorDependencyPrinter::GetEffectiveWorkerCount() const
+{
+	return WorkerCount > 0 ? WorkerCount : FTaskGraphInterface::Get().GetNumWorkerThreads() + 1;
+}
+
+const FMassPrintAnnotations* FMassPhaseProcessorDependencyPrinter::GetPrintAnnotations(const FMassProcessorDependencySolverPrinterImpl& Solver
+	, const TSharedPtr<FMassEntityManager>& EntityManager, FMassPrintAnnotations& OutStorage) const
+{
+	if (EntityManager.IsValid() == false)
+	{
+		return Annotations;
+	}
+
+	OutStorage.Base = Annotations;
+	Solver.AddWorkloadAnnotations(OutStorage);
+	return &OutStorage;
 }
 
 void FMassProcessorDependencySolverPrinterImpl::ResolveExecutesGroupTree(TSharedPtr<FMassEntityManager> EntityManager, FMassProcessorDependencySolver::FResult* InOutOptionalResult)
@@ -144,6 +248,11 @@ void FMassProcessorDependencySolverPrinterImpl::ResolveExecutesGroupTree(TShared
 
     UE_LOG(LogMass, Verbose, TEXT("Pruning processors..."));
 
+    // matching through the queries makes each of them cache every archetype, which dominates the dump time once
+    // there are thousands of archetypes
+    FMassArchetypeMatchIndex MatchIndex;
+    MatchIndex.Build(*EntityManager.Get());
+
     int32 PrunedProcessorsCount = 0;
     for (FForPrintExecutesGroupTreeNode& Node : AllForPrintGroupTreeNodes)
     {
@@ -151,7 +260,11 @@ void FMassProcessorDependencySolverPrinterImpl::ResolveExecutesGroupTree(TShared
         {
             // for each processor-representing node we cache information on which archetypes among the once we've created 
             // above (see the EntityManager.CreateArchetype call in the previous loop) match this processor. 
-            Node.Processor->GetArchetypesMatchingOwnedQueries(*EntityManager.Get(), Node.ValidArchetypes);
+            MatchIndex.GetArchetypesMatchingOwnedQueries(*Node.Processor, Node.ValidArchetypes);
+            if (UE::MassHelper::Private::bVerifyArchetypeMatchIndex)
+            {
+                UE::MassHelper::Private::VerifyArchetypeMatchIndex(*Node.Processor, *EntityManager, Node.ValidArchetypes);
+            }
 
             // prune the archetype-less processors
             if (Node.ValidArchetypes.Num() == 0 && Node.Processor->ShouldAllowQueryBasedPruning(bGameRuntime))
@@ -180,14 +293,388 @@ void FMassProcessorDependencySolverPrinterImpl::ResolveExecutesGroupTree(TShared
     //Check bAnyCyclesDetected
 }
 
-void FMassProcessorDependencySolverPrinterImpl::PrintExecutesGroupTree(FString& OutputString)
+void FMassProcessorDependencySolverPrinterImpl::PrintExecutesGroupTree(FArchive& OutputArchive, const FMassPrintAnnotations* Annotations)
+{
+    PrintCommon(FString("ExecutesGroupTree"), AllForPrintGroupTreeNodes, OutputArchive, Annotations);
+}
+
+void FMassProcessorDependencySolverPrinterImpl::PrintCompletelyDependency(FArchive& OutputArchive, const FMassPrintAnnotations* Annotations, TConstArrayView<FMassProcessorOrderInfo> SortedProcessors)
+{
+    if (SortedProcessors.Num() == 0)
+    {
+        PrintCommon(FString("CompletelyDependency"), AllNodes, OutputArchive, Annotations);
+        return;
+    }
+
+    FMassProcessorGraph Graph;
+    BuildProcessorGraph(Graph, SortedProcessors);
+
+    FMassPrintAnnotations ReasonAnnotations(Annotations);
+    AddDependencyReasonAnnotations(Graph, ReasonAnnotations);
+
+    PrintCommon(FString("CompletelyDependency"), AllNodes, OutputArchive, &ReasonAnnotations);
+}
+
+void FMassProcessorDependencySolverPrinterImpl::PrintLayeredLayout(FArchive& OutputArchive, TConstArrayView<FMassProcessorOrderInfo> SortedProcessors, const FMassPrintAnnotations* Annotations)
+{
+    FMassProcessorGraph Graph;
+    BuildProcessorGraph(Graph, SortedProcessors);
+
+    FMassProcessorGraphLayout Layout;
+    Layout.Compute(Graph);
+
+    FMassPrintAnnotations LayoutAnnotations(Annotations);
+    Layout.ExportAnnotations(Graph, LayoutAnnotations);
+
+    PrintCommon(FString("CompletelyDependency"), AllNodes, OutputArchive, &LayoutAnnotations);
+}
+
+void FMassProcessorDependencySolverPrinterImpl::PrintGraphvizDot(FArchive& OutputArchive, TConstArrayView<FMassProcessorOrderInfo> SortedProcessors)
+{
+    FMassProcessorGraph Graph;
+    BuildProcessorGraph(Graph, SortedProcessors);
+
+    TArray<int32> ParentGroups;
+    GetParentGroups(Graph, ParentGroups);
+
+    FMassProcessorGraphLayout::WriteDot(Graph, ParentGroups, OutputArchive);
+}
+
+void FMassProcessorDependencySolverPrinterImpl::PrintConstraintAnalysis(FArchive& OutputArchive, TConstArrayView<FMassProcessorOrderInfo> SortedProcessors, const FMassProcessorCostTable& CostTable, const int32 CoreCount, const FMassPrintAnnotations* Annotations)
+{
+    FMassProcessorGraph Graph;
+    BuildProcessorGraph(Graph, SortedProcessors);
+    Graph.ApplyCosts(CostTable);
+
+    TArray<int32> ParentGroups;
+    GetParentGroups(Graph, ParentGroups);
+    TArray<FMassDependencyReasonResolver::FNodeDesc> NodeDescs;
+    NodeDescs.SetNum(Graph.Nodes.Num());
+    for (int32 NodeIndex = 0; NodeIndex < Graph.Nodes.Num(); ++NodeIndex)
+    {
+        const int32 SourceNodeIndex = Graph.Nodes[NodeIndex].SourceNodeIndex;
+        if (SourceNodeIndex != INDEX_NONE)
+        {
+            NodeDescs[NodeIndex] = FMassDependencyReasonResolver::MakeNodeDesc(AllNodes[SourceNodeIndex]);
+        }
+        else
+        {
+            NodeDescs[NodeIndex].Name = Graph.Nodes[NodeIndex].Name;
+        }
+    }
+
+    FMassProcessorConstraintAnalysis Analysis;
+    Analysis.Analyze(Graph, NodeDescs, ParentGroups, CoreCount);
+
+    FMassPrintAnnotations AnalysisAnnotations(Annotations);
+    AnalysisAnnotations.AddRootWriter([&Analysis, &Graph](FMassDependencyJsonWriter& Writer)
+        {
+            Writer.WriteKey(TEXT("ConstraintAnalysis"));
+            Analysis.WriteJson(Writer, Graph);
+        });
+
+    PrintCommon(FString("CompletelyDependency"), AllNodes, OutputArchive, &AnalysisAnnotations);
+}
+
+void FMassProcessorDependencySolverPrinterImpl::PrintGameThreadAudit(FArchive& OutputArchive, TConstArrayView<FMassProcessorOrderInfo> SortedProcessors, const FMassProcessorCostTable& CostTable, const int32 CoreCount, const FMassPrintAnnotations* Annotations)
+{
+    FMassProcessorGraph Graph;
+    BuildProcessorGraph(Graph, SortedProcessors);
+    Graph.ApplyCosts(CostTable);
+
+    FMassGameThreadAudit Audit;
+    Audit.Analyze(Graph, SortedProcessors, CoreCount);
+
+    FMassPrintAnnotations AuditAnnotations(Annotations);
+
+    TMap<int32, int32> NodeRanks;
+    for (int32 Rank = 0; Rank < Audit.Processors.Num(); ++Rank)
+    {
+        NodeRanks.Add(Audit.Processors[Rank].NodeIndex, Rank);
+    }
+    AuditAnnotations.AddNodeWriter([&Audit, &Graph, &CostTable, &NodeRanks](FMassDependencyJsonWriter& Writer, const FName NodeName)
+        {
+            const int32* NodeIndex = Graph.NodeIndexMap.Find(NodeName);
+            const int32* Rank = NodeIndex ? NodeRanks.Find(*NodeIndex) : nullptr;
+            if (Rank == nullptr)
+            {
+                return;
+            }
+            const FMassGameThreadAudit::FProcessorInfo& Info = Audit.Processors[*Rank];
+            Writer.WriteKey(TEXT("GameThreadAudit"));
+            Writer.BeginObject();
+            Writer.WriteNumberField(TEXT("Rank"), *Rank + 1);
+            Writer.WriteNumberField(TEXT("SolvedOrderIndex"), Info.SolvedOrderIndex);
+            Writer.WriteBoolField(TEXT("CostMeasured"), CostTable.IsMeasured(NodeName));
+            Writer.WriteNumberField(TEXT("WaitingProcessorCount"), Info.WaitingProcessorCount);
+            Writer.WriteNumberField(TEXT("IdleWorkerMs"), Info.IdleWorkerMs);
+            Writer.WriteNumberField(TEXT("SimulatedGainMs"), Info.SimulatedGainMs);
+            Writer.EndObject();
+        });
+    AuditAnnotations.AddRootWriter([&Audit, &Graph](FMassDependencyJsonWriter& Writer)
+        {
+            Writer.WriteKey(TEXT("GameThreadAudit"));
+            Audit.WriteJson(Writer, Graph);
+        });
+
+    PrintCommon(FString("CompletelyDependency"), AllNodes, OutputArchive, &AuditAnnotations);
+}
+
+void FMassProcessorDependencySolverPrinterImpl::GetParentGroups(const FMassProcessorGraph& Graph, TArray<int32>& OutParentGroups) const
 {
-    PrintCommon(FString("ExecutesGroupTree"), AllForPrintGroupTreeNodes, OutputString);
+    OutParentGroups.Init(INDEX_NONE, Graph.Nodes.Num());
+    for (const FNode& Node : AllNodes)
+    {
+        const int32 GroupIndex = Graph.NodeIndexMap.FindChecked(Node.Name);
+        for (const int32 SubNodeIndex : Node.SubNodeIndices)
+        {
+            OutParentGroups[Graph.NodeIndexMap.FindChecked(AllNodes[SubNodeIndex].Name)] = GroupIndex;
+        }
+    }
+}
+
+void FMassProcessorDependencySolverPrinterImpl::BuildProcessorGraph(FMassProcessorGraph& OutGraph, TConstArrayView<FMassProcessorOrderInfo> SortedProcessors) const
+{
+    OutGraph.AddSolverNodes(AllNodes);
+    OutGraph.AddExecutionOrder(SortedProcessors);
+}
+
+void FMassProcessorDependencySolverPrinterImpl::AddWorkloadAnnotations(FMassPrintAnnotations& InOutAnnotations) const
+{
+    struct FWorkload
+    {
+        int32 ChunkCount = 0;
+        int32 EntityCount = 0;
+        TArray<FMassArchetypeMemoryReport::FArchetypeInfo> Archetypes;
+    };
+
+    // written later, possibly off the game thread, so the archetypes are read now
+    TSharedRef<TMap<FName, FWorkload>> Workloads = MakeShared<TMap<FName, FWorkload>>();
+    int32 TotalEntityCount = 0;
+    for (const FNode& Node : AllNodes)
+    {
+        if (Node.IsGroup())
+        {
+            continue;
+        }
+
+        // a processor's queries can match the same archetype more than once
+        TSet<const FMassArchetypeData*> MatchedArchetypes;
+        for (const FMassArchetypeHandle& ArchetypeHandle : Node.ValidArchetypes)
+        {
+            if (const FMassArchetypeData* ArchetypeData = FMassArchetypeHelper::ArchetypeDataFromHandle(ArchetypeHandle))
+            {
+                MatchedArchetypes.Add(ArchetypeData);
+            }
+        }
+
+        FWorkload& Workload = Workloads->Add(Node.Name);
+        Workload.Archetypes.Reserve(MatchedArchetypes.Num());
+        for (const FMassArchetypeData* ArchetypeData : MatchedArchetypes)
+        {
+            FMassArchetypeMemoryReport::FArchetypeInfo& ArchetypeInfo = Workload.Archetypes.AddDefaulted_GetRef();
+            FMassArchetypeMemoryReport::GatherArchetype(*ArchetypeData, ArchetypeInfo);
+            Workload.ChunkCount += ArchetypeInfo.NonEmptyChunkCount;
+            Workload.EntityCount += ArchetypeInfo.EntityCount;
+        }
+        TotalEntityCount += Workload.EntityCount;
+    }
+
+    InOutAnnotations.AddNodeWriter([Workloads](FMassDependencyJsonWriter& Writer, const FName NodeName)
+        {
+            const FWorkload* Workload = Workloads->Find(NodeName);
+            if (Workload == nullptr)
+            {
+                return;
+            }
+            Writer.WriteKey(TEXT("Workload"));
+            Writer.BeginObject();
+            Writer.WriteNumberField(TEXT("ArchetypeCount"), Workload->Archetypes.Num());
+            Writer.WriteNumberField(TEXT("ChunkCount"), Workload->ChunkCount);
+            Writer.WriteNumberField(TEXT("EntityCount"), Workload->EntityCount);
+            Writer.WriteKey(TEXT("Archetypes"));
+            Writer.BeginArray();
+            for (const FMassArchetypeMemoryReport::FArchetypeInfo& ArchetypeInfo : Workload->Archetypes)
+            {
+                Writer.BeginObject();
+                Writer.WriteStringField(TEXT("CompositionHash"), FString::Printf(TEXT("%08x"), ArchetypeInfo.CompositionHash));
+                Writer.WriteNumberField(TEXT("EntityCount"), ArchetypeInfo.EntityCount);
+                Writer.WriteNumberField(TEXT("ChunkCount"), ArchetypeInfo.NonEmptyChunkCount);
+                Writer.EndObject();
+            }
+            Writer.EndArray();
+            Writer.EndObject();
+        });
+
+    InOutAnnotations.AddRootWriter([TotalEntityCount](FMassDependencyJsonWriter& Writer)
+        {
+            Writer.WriteKey(TEXT("Workload"));
+            Writer.BeginObject();
+            Writer.WriteNumberField(TEXT("EntityIterations"), TotalEntityCount);
+            Writer.EndObject();
+        });
 }
 
-void FMassProcessorDependencySolverPrinterImpl::PrintCompletelyDependency(FString& OutputString)
+SIZE_T FMassProcessorDependencySolverPrinterImpl::GetAllocatedSize() const
 {
-    PrintCommon(FString("CompletelyDependency"), AllNodes, OutputString);
+    auto GetNodeArraySize = [](const auto& Nodes)
+    {
+        SIZE_T Size = Nodes.GetAllocatedSize();
+        for (const auto& Node : Nodes)
+        {
+            Size += Node.OriginalDependencies.GetAllocatedSize() + Node.SubNodeIndices.GetAllocatedSize()
+                + Node.ExecuteBefore.GetAllocatedSize() + Node.ExecuteAfter.GetAllocatedSize() + Node.ValidArchetypes.GetAllocatedSize();
+        }
+        return Size;
+    };
+
+    return GetNodeArraySize(AllNodes) + NodeIndexMap.GetAllocatedSize()
+        + GetNodeArraySize(AllForPrintGroupTreeNodes) + ForPrintGroupTreeNodeIndexMap.GetAllocatedSize();
+}
+
+void FMassProcessorDependencySolverPrinterImpl::AddDependencyReasonAnnotations(const FMassProcessorGraph& Graph, FMassPrintAnnotations& InOutAnnotations) const
+{
+    TArray<int32> ParentGroups;
+    GetParentGroups(Graph, ParentGroups);
+
+    InOutAnnotations.AddNodeWriter([this, &Graph, ParentGroups = MoveTemp(ParentGroups)](FMassDependencyJsonWriter& Writer, const FName NodeName)
+        {
+            using EEdgeSource = FMassProcessorGraph::EEdgeSource;
+            using FGroupDescs = TArray<FMassDependencyReasonResolver::FNodeDesc, TInlineAllocator<8>>;
+
+            // enclosing groups innermost first, for edges inherited from group ordering
+            auto GetGroupDescs = [this, &Graph, &ParentGroups](const int32 GraphNodeIndex, FGroupDescs& OutGroupDescs)
+            {
+                OutGroupDescs.Reset();
+                for (int32 GroupIndex = ParentGroups[GraphNodeIndex]; GroupIndex != INDEX_NONE; GroupIndex = ParentGroups[GroupIndex])
+                {
+                    const int32 SourceNodeIndex = Graph.Nodes[GroupIndex].SourceNodeIndex;
+                    if (SourceNodeIndex != INDEX_NONE)
+                    {
+                        OutGroupDescs.Add(FMassDependencyReasonResolver::MakeNodeDesc(AllNodes[SourceNodeIndex]));
+                    }
+                }
+            };
+
+            const int32* NodeIndex = Graph.NodeIndexMap.Find(NodeName);
+            const FMassProcessorGraph::FNode* Node = NodeIndex ? &Graph.Nodes[*NodeIndex] : nullptr;
+            if (Node == nullptr || Node->SourceNodeIndex == INDEX_NONE || Node->Dependencies.Num() == 0)
+            {
+                return;
+            }
+
+            const FMassDependencyReasonResolver::FNodeDesc ToDesc = FMassDependencyReasonResolver::MakeNodeDesc(AllNodes[Node->SourceNodeIndex]);
+            FGroupDescs ToGroupDescs;
+            GetGroupDescs(*NodeIndex, ToGroupDescs);
+            FGroupDescs FromGroupDescs;
+            TArray<FMassDependencyEdgeReason> Reasons;
+            Writer.WriteKey(TEXT("DependencyReasons"));
+            Writer.BeginArray();
+            for (const int32 DependencyIndex : Node->Dependencies)
+            {
+                const FMassProcessorGraph::FNode& DependencyNode = Graph.Nodes[DependencyIndex];
+                if (DependencyNode.SourceNodeIndex == INDEX_NONE)
+                {
+                    continue;
+                }
+
+                const EEdgeSource Source = Graph.GetEdgeSource(DependencyIndex, *NodeIndex);
+                const FMassDependencyReasonResolver::FNodeDesc FromDesc = FMassDependencyReasonResolver::MakeNodeDesc(AllNodes[DependencyNode.SourceNodeIndex]);
+
+                GetGroupDescs(DependencyIndex, FromGroupDescs);
+
+                Reasons.Reset();
+                FMassDependencyReasonResolver::GetReasons(FromDesc, ToDesc, FromGroupDescs, ToGroupDescs, EnumHasAnyFlags(Source, EEdgeSource::OriginalDependency), Reasons);
+
+                Writer.BeginObject();
+                Writer.WriteNameField(TEXT("From"), DependencyNode.Name);
+                Writer.WriteStringField(TEXT("Source"), EnumHasAllFlags(Source, EEdgeSource::OriginalDependency | EEdgeSource::ExecutionOrder) ? TEXT("Both")
+                    : EnumHasAnyFlags(Source, EEdgeSource::OriginalDependency) ? TEXT("OriginalDependency") : TEXT("ExecutionOrder"));
+                Writer.WriteKey(TEXT("Reasons"));
+                Writer.BeginArray();
+                for (const FMassDependencyEdgeReason& Reason : Reasons)
+                {
+                    Reason.WriteJson(Writer);
+                }
+                Writer.EndArray();
+                Writer.EndObject();
+            }
+            Writer.EndArray();
+        });
+}
+
+void FMassProcessorDependencySolverPrinterImpl::PrintCriticalPathAnalysis(FArchive& OutputArchive, TConstArrayView<FMassProcessorOrderInfo> SortedProcessors, const FMassProcessorCostTable& CostTable, const int32 WorkerCount, const FMassPrintAnnotations* Annotations)
+{
+    FMassProcessorGraph Graph;
+    BuildProcessorGraph(Graph, SortedProcessors);
+    Graph.ApplyCosts(CostTable);
+
+    FMassCriticalPathAnalysis Analysis;
+    Analysis.Analyze(Graph);
+
+    FMassPrintAnnotations AnalysisAnnotations(Annotations);
+
+    AnalysisAnnotations.AddNodeWriter([&Analysis, &Graph, &CostTable](FMassDependencyJsonWriter& Writer, const FName NodeName)
+        {
+            const int32* NodeIndex = Graph.NodeIndexMap.Find(NodeName);
+            if (NodeIndex == nullptr || Graph.Nodes[*NodeIndex].IsProcessor() == false)
+            {
+                return;
+            }
+            const FMassCriticalPathAnalysis::FNodeInfo& Info = Analysis.NodeInfos[*NodeIndex];
+            Writer.WriteKey(TEXT("CriticalPath"));
+            Writer.BeginObject();
+            Writer.WriteNumberField(TEXT("CostMs"), Graph.Nodes[*NodeIndex].CostMs);
+            Writer.WriteBoolField(TEXT("CostMeasured"), CostTable.IsMeasured(NodeName));
+            Writer.WriteNumberField(TEXT("Level"), Info.Level);
+            Writer.WriteNumberField(TEXT("EarliestStartMs"), Info.EarliestStartMs);
+            Writer.WriteNumberField(TEXT("SlackMs"), Info.GetSlackMs());
+            Writer.WriteBoolField(TEXT("OnCriticalPath"), Info.bOnCriticalPath);
+            Writer.EndObject();
+        });
+    AnalysisAnnotations.AddRootWriter([&Analysis, &Graph, WorkerCount](FMassDependencyJsonWriter& Writer)
+        {
+            Writer.WriteKey(TEXT("CriticalPathAnalysis"));
+            Analysis.WriteJson(Writer, Graph, WorkerCount);
+        });
+
+    PrintCommon(FString("CompletelyDependency"), AllNodes, OutputArchive, &AnalysisAnnotations);
+}
+
+void FMassProcessorDependencySolverPrinterImpl::PrintScheduleSimulation(FArchive& OutputArchive, TConstArrayView<FMassProcessorOrderInfo> SortedProcessors, const FMassProcessorCostTable& CostTable, const int32 MaxCoreCount, const FMassPrintAnnotations* Annotations)
+{
+    FMassProcessorGraph Graph;
+    BuildProcessorGraph(Graph, SortedProcessors);
+    Graph.ApplyCosts(CostTable);
+
+    FMassProcessorScheduleSimulation::FCoreCountSweep Sweep;
+    FMassProcessorScheduleSimulation::SimulateCoreCounts(Graph, MaxCoreCount, Sweep);
+    const FMassProcessorScheduleSimulation::FResult& TimelineResult = Sweep.Timeline;
+
+    FMassPrintAnnotations SimulationAnnotations(Annotations);
+
+    SimulationAnnotations.AddNodeWriter([&TimelineResult, &Graph, &CostTable](FMassDependencyJsonWriter& Writer, const FName NodeName)
+        {
+            const int32* NodeIndex = Graph.NodeIndexMap.Find(NodeName);
+            if (NodeIndex == nullptr || Graph.Nodes[*NodeIndex].IsProcessor() == false || TimelineResult.NodeLanes[*NodeIndex] == INDEX_NONE)
+            {
+                return;
+            }
+            Writer.WriteKey(TEXT("Schedule"));
+            Writer.BeginObject();
+            Writer.WriteNumberField(TEXT("Lane"), TimelineResult.NodeLanes[*NodeIndex]);
+            Writer.WriteNumberField(TEXT("StartMs"), TimelineResult.NodeStartMs[*NodeIndex]);
+            Writer.WriteNumberField(TEXT("CostMs"), Graph.Nodes[*NodeIndex].CostMs);
+            Writer.WriteBoolField(TEXT("CostMeasured"), CostTable.IsMeasured(NodeName));
+            Writer.EndObject();
+        });
+    SimulationAnnotations.AddRootWriter([&Sweep, &Graph](FMassDependencyJsonWriter& Writer)
+        {
+            Writer.WriteKey(TEXT("ScheduleSimulation"));
+            FMassProcessorScheduleSimulation::WriteJson(Writer, Graph, Sweep);
+        });
+
+    PrintCommon(FString("CompletelyDependency"), AllNodes, OutputArchive, &SimulationAnnotations);
 }
 
 int32 FMassProcessorDependencySolverPrinterImpl::CreateForPrintGroupTreeNodes(UMassProcessor& Processor)
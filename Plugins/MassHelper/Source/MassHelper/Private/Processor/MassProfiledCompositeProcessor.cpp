@@ -0,0 +1,501 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+#include "MassHelper/Public/Processor/MassProfiledCompositeProcessor.h"
+#include "MassHelper/Public/Profiling/MassProcessorProfiler.h"
+#include "MassHelper/Public/Analysis/MassArchetypeMemoryReport.h"
+#include "MassHelper/Private/Analysis/MassPrivateMemberAccess.h"
+
+#include "MassEntity/Public/MassArchetypeData.h"
+#include "MassEntity/Public/MassCommandBuffer.h"
+#include "MassEntity/Public/MassEntityManager.h"
+#include "MassEntity/Public/MassExecutionContext.h"
+#include "MassSimulation/Public/MassSimulationSubsystem.h"
+#include "UObject/UObjectHash.h"
+
+namespace UE::MassHelper::Private
+{
+	struct FCommandInstancesTag
+	{
+		using Type = TArray<FMassBatchedCommand*> FMassCommandBuffer::*;
+		friend Type GetPrivateMember(FCommandInstancesTag);
+	};
+	template struct TMassPrivateMemberAccessor<FCommandInstancesTag, &FMassCommandBuffer::CommandInstances>;
+
+	struct FTargetEntitiesTag
+	{
+		using Type = TArray<FMassEntityHandle> FMassBatchedEntityCommand::*;
+		friend Type GetPrivateMember(FTargetEntitiesTag);
+	};
+	template struct TMassPrivateMemberAccessor<FTargetEntitiesTag, &FMassBatchedEntityCommand::TargetEntities>;
+
+	/**
+	 * Entities the command in the given slot of a command buffer targets. Without RTTI the commands deriving from
+	 * FMassBatchedEntityCommand are told apart by their slot and operation type: the lambda wrapping FMassDeferredCommand
+	 * instantiations have fixed slots, and creation commands are skipped since some of them keep their entities apart.
+	 */
+	TConstArrayView<FMassEntityHandle> GetTargetEntities(const FMassBatchedCommand& Command, const int32 CommandIndex)
+	{
+		static const uint32 LambdaCommandIndices[] = {
+			FMassBatchedCommand::GetCommandIndex<FMassDeferredCreateCommand>(),
+			FMassBatchedCommand::GetCommandIndex<FMassDeferredAddCommand>(),
+			FMassBatchedCommand::GetCommandIndex<FMassDeferredRemoveCommand>(),
+			FMassBatchedCommand::GetCommandIndex<FMassDeferredChangeCompositionCommand>(),
+			FMassBatchedCommand::GetCommandIndex<FMassDeferredSetCommand>(),
+			FMassBatchedCommand::GetCommandIndex<FMassDeferredDestroyCommand>(),
+		};
+		const EMassCommandOperationType OperationType = Command.GetOperationType();
+		if (OperationType == EMassCommandOperationType::None || OperationType == EMassCommandOperationType::Create
+			|| MakeArrayView(LambdaCommandIndices).Contains(uint32(CommandIndex)))
+		{
+			return TConstArrayView<FMassEntityHandle>();
+		}
+		return static_cast<const FMassBatchedEntityCommand&>(Command).*GetPrivateMember(FTargetEntitiesTag());
+	}
+
+	/** Per command instance of a buffer, what it held before a processor ran. */
+	struct FCommandCount
+	{
+		/** The operations it holds, without Mass debug names only whether it holds any. */
+		int32 Operations = 0;
+		int32 TargetEntities = 0;
+	};
+	using FCommandCounts = TMap<const FMassBatchedCommand*, FCommandCount>;
+
+	int32 GetCommandCount(const FMassBatchedCommand& Command)
+	{
+#if CSV_PROFILER || WITH_MASSENTITY_DEBUG
+		return Command.GetNumOperationsStat();
+#else
+		return Command.HasWork() ? 1 : 0;
+#endif
+	}
+
+	void GatherCommandCounts(const FMassCommandBuffer& CommandBuffer, FCommandCounts& OutCounts)
+	{
+		OutCounts.Reset();
+		const TArray<FMassBatchedCommand*>& Commands = CommandBuffer.*GetPrivateMember(FCommandInstancesTag());
+		for (int32 CommandIndex = 0; CommandIndex < Commands.Num(); ++CommandIndex)
+		{
+			const FMassBatchedCommand* Command = Commands[CommandIndex];
+			if (Command && Command->HasWork())
+			{
+				OutCounts.Add(Command, { GetCommandCount(*Command), GetTargetEntities(*Command, CommandIndex).Num() });
+			}
+		}
+	}
+
+	/**
+	 * Reports what one processor execution added to CommandBuffer since CountsBefore was gathered, and appends the
+	 * entities the added commands target to OutTargetEntities. Nothing else may push commands meanwhile. Without Mass
+	 * debug names, commands appended to batches that already had work are missed.
+	 */
+	void ReportIssuedCommands(const FMassCommandBuffer& CommandBuffer, const FCommandCounts& CountsBefore, const FMassProcessorExecutionRecord& Execution, TArray<FMassEntityHandle>& OutTargetEntities)
+	{
+		FMassProcessorCommandsRecord Record;
+		Record.NodeName = Execution.NodeName;
+		Record.Processor = Execution.Processor;
+		Record.Phase = Execution.Phase;
+		Record.ThreadId = Execution.ThreadId;
+		const TArray<FMassBatchedCommand*>& Commands = CommandBuffer.*GetPrivateMember(FCommandInstancesTag());
+		for (int32 CommandIndex = 0; CommandIndex < Commands.Num(); ++CommandIndex)
+		{
+			const FMassBatchedCommand* Command = Commands[CommandIndex];
+			if (Command == nullptr || Command->HasWork() == false)
+			{
+				continue;
+			}
+			const FCommandCount CountBefore = CountsBefore.FindRef(Command);
+			const TConstArrayView<FMassEntityHandle> TargetEntities = GetTargetEntities(*Command, CommandIndex);
+			if (TargetEntities.Num() > CountBefore.TargetEntities)
+			{
+				Record.TargetEntities.Append(TargetEntities.RightChop(CountBefore.TargetEntities));
+			}
+
+			const int32 IssuedCount = GetCommandCount(*Command) - CountBefore.Operations;
+			if (IssuedCount > 0)
+			{
+				FMassProcessorCommandsRecord::FCommandBatch& Batch = Record.Commands.AddDefaulted_GetRef();
+				Batch.OperationType = Command->GetOperationType();
+#if CSV_PROFILER || WITH_MASSENTITY_DEBUG
+				Batch.Name = Command->GetFName();
+				Batch.OperationCount = IssuedCount;
+#endif
+			}
+		}
+		if (Record.Commands.Num())
+		{
+			FMassProcessorProfiler::Get().BroadcastProcessorCommandsIssued(Record);
+		}
+		OutTargetEntities.Append(Record.TargetEntities);
+	}
+
+	/** Called on the processor's own execution path, nothing else touches its queries meanwhile. */
+	void GatherMatchedArchetypes(UMassProcessor& Processor, const FMassEntityManager& EntityManager, FMassProcessorExecutionRecord& OutRecord)
+	{
+		TArray<FMassArchetypeHandle> MatchingArchetypes;
+		Processor.GetArchetypesMatchingOwnedQueries(EntityManager, MatchingArchetypes);
+
+		// a processor's queries can match the same archetype more than once
+		OutRecord.MatchedArchetypes.Reset(MatchingArchetypes.Num());
+		for (const FMassArchetypeHandle& ArchetypeHandle : MatchingArchetypes)
+		{
+			const FMassArchetypeData* ArchetypeData = FMassArchetypeHelper::ArchetypeDataFromHandle(ArchetypeHandle);
+			if (ArchetypeData && OutRecord.MatchedArchetypes.ContainsByPredicate([ArchetypeData](const TPair<const FMassArchetypeData*, int32>& Matched) { return Matched.Key == ArchetypeData; }) == false)
+			{
+				OutRecord.MatchedArchetypes.Emplace(ArchetypeData, ArchetypeData->GetNumEntities());
+			}
+		}
+	}
+
+	const FMassArchetypeData* GetEntityArchetype(const FMassEntityManager& EntityManager, const FMassEntityHandle Entity)
+	{
+		return EntityManager.IsEntityValid(Entity) ? FMassArchetypeHelper::ArchetypeDataFromHandle(EntityManager.GetArchetypeForEntity(Entity)) : nullptr;
+	}
+
+	/** Compares every target entity's archetype after the flush with the one it had before, issuer by issuer. */
+	void GatherTransitions(const FMassEntityManager& EntityManager, const TMap<FName, TArray<FMassEntityHandle>>& TargetEntities
+		, const TMap<FMassEntityHandle, const FMassArchetypeData*>& ArchetypesBefore, FMassPhaseTransitionsRecord& OutRecord)
+	{
+		TArray<TSharedPtr<FMassArchetypeData>> Archetypes;
+		FMassArchetypeMemoryReport::GetArchetypes(EntityManager, Archetypes);
+		TMap<const FMassArchetypeData*, TSharedPtr<FMassArchetypeData>> SharedArchetypes;
+		for (const TSharedPtr<FMassArchetypeData>& ArchetypeData : Archetypes)
+		{
+			SharedArchetypes.Add(ArchetypeData.Get(), ArchetypeData);
+		}
+
+		TMap<TPair<const FMassArchetypeData*, const FMassArchetypeData*>, int32> TransitionIndices;
+		TMap<FMassEntityHandle, int32> EntityTransitions;
+		for (const TPair<FMassEntityHandle, const FMassArchetypeData*>& Before : ArchetypesBefore)
+		{
+			const FMassArchetypeData* After = GetEntityArchetype(EntityManager, Before.Key);
+			if (After == Before.Value)
+			{
+				continue;
+			}
+			int32& TransitionIndex = TransitionIndices.FindOrAdd(MakeTuple(Before.Value, After), INDEX_NONE);
+			if (TransitionIndex == INDEX_NONE)
+			{
+				TransitionIndex = OutRecord.Transitions.AddDefaulted();
+				OutRecord.Transitions[TransitionIndex].From = SharedArchetypes.FindRef(Before.Value);
+				OutRecord.Transitions[TransitionIndex].To = SharedArchetypes.FindRef(After);
+			}
+			++OutRecord.Transitions[TransitionIndex].EntityCount;
+			EntityTransitions.Add(Before.Key, TransitionIndex);
+		}
+
+		TSet<FMassEntityHandle> IssuerEntities;
+		for (const TPair<FName, TArray<FMassEntityHandle>>& Issuer : TargetEntities)
+		{
+			// several commands of one processor can target the same entity
+			IssuerEntities.Reset();
+			for (const FMassEntityHandle Entity : Issuer.Value)
+			{
+				bool bAlreadyCounted = false;
+				IssuerEntities.Add(Entity, &bAlreadyCounted);
+				const int32* TransitionIndex = bAlreadyCounted ? nullptr : EntityTransitions.Find(Entity);
+				if (TransitionIndex)
+				{
+					++OutRecord.Transitions[*TransitionIndex].Issuers.FindOrAdd(Issuer.Key);
+				}
+			}
+		}
+	}
+}
+
+void UMassProfiledCompositeProcessor::ExecuteProcessorTask(UMassProcessor& Processor, const TSharedPtr<FMassEntityManager>& EntityManager
+	, FMassExecutionContext& ExecutionContext, const bool bAttributeCommands, const bool bCountEntities)
+{
+	// mirrors what FMassProcessorTask does for a single processor, with the timing taken around the actual execution
+	check(EntityManager);
+	FMassEntityManager& EntityManagerRef = *EntityManager.Get();
+	FMassEntityManager::FScopedProcessing ProcessingScope = EntityManagerRef.NewProcessingScope();
+
+	const TSharedPtr<FMassCommandBuffer> MainCommandBuffer = ExecutionContext.GetSharedDeferredCommandBuffer();
+	const TSharedPtr<FMassCommandBuffer> CommandBuffer = MakeShareable(new FMassCommandBuffer());
+	ExecutionContext.SetDeferredCommandBuffer(CommandBuffer);
+	ExecutionContext.SetFlushDeferredCommands(false);
+
+	FMassProcessorExecutionRecord Record;
+	Record.NodeName = ProfilerNodeNames.FindRef(&Processor);
+	Record.Processor = &Processor;
+	Record.Phase = GetProcessingPhase();
+	if (bCountEntities)
+	{
+		UE::MassHelper::Private::GatherMatchedArchetypes(Processor, EntityManagerRef, Record);
+	}
+	Record.ThreadId = FPlatformTLS::GetCurrentThreadId();
+	Record.BeginCycles = FPlatformTime::Cycles64();
+	Processor.CallExecute(EntityManagerRef, ExecutionContext);
+	Record.EndCycles = FPlatformTime::Cycles64();
+
+	ExecutionContext.SetDeferredCommandBuffer(MainCommandBuffer);
+	if (bAttributeCommands)
+	{
+		// the task's buffer holds nothing but this execution's commands
+		TArray<FMassEntityHandle> TargetEntities;
+		UE::MassHelper::Private::ReportIssuedCommands(*CommandBuffer, UE::MassHelper::Private::FCommandCounts(), Record, TargetEntities);
+		AddPendingTargetEntities(Record.NodeName, TargetEntities);
+	}
+	(MainCommandBuffer ? *MainCommandBuffer : EntityManagerRef.Defer()).MoveAppend(*CommandBuffer);
+
+	FMassProcessorProfiler::Get().BroadcastProcessorExecuted(Record);
+}
+
+void UMassProfiledCompositeProcessor::AddPendingTargetEntities(const FName NodeName, TConstArrayView<FMassEntityHandle> Entities)
+{
+	if (Entities.Num())
+	{
+		FScopeLock Lock(&TargetEntitiesCS);
+		PendingTargetEntities.FindOrAdd(NodeName).Append(Entities);
+	}
+}
+
+FGraphEventRef UMassProfiledCompositeProcessor::DispatchProcessorTasks(const TSharedPtr<FMassEntityManager>& EntityManager, FMassExecutionContext& ExecutionContext, const FGraphEventArray& InPrerequisites)
+{
+	FMassProcessorProfiler& Profiler = FMassProcessorProfiler::Get();
+	if (Profiler.IsActive() == false || FlatProcessingGraph.Num() == 0)
+	{
+		return Super::DispatchProcessorTasks(EntityManager, ExecutionContext, InPrerequisites);
+	}
+
+	RefreshProfilerNodeNames();
+	BindPhaseFinished();
+
+	const EMassProcessingPhase Phase = GetProcessingPhase();
+	Profiler.BroadcastPhaseBegin(Phase);
+
+	// leaf processors run the way FMassProcessorTask runs them, each with a command buffer of its own, so the timing
+	// is taken around CallExecute on the thread that runs it. Nested composites dispatch their children themselves.
+	const bool bAttributeCommands = Profiler.IsAttributingCommands();
+	const bool bCountEntities = Profiler.IsCountingEntities();
+
+	FGraphEventArray Events;
+	Events.Reserve(FlatProcessingGraph.Num());
+	for (const FDependencyNode& ProcessingNode : FlatProcessingGraph)
+	{
+		check(ProcessingNode.Processor);
+		FGraphEventArray Prerequisites;
+		if (ProcessingNode.Dependencies.Num() == 0)
+		{
+			Prerequisites = InPrerequisites;
+		}
+		for (const int32 DependencyIndex : ProcessingNode.Dependencies)
+		{
+			Prerequisites.Add(Events[DependencyIndex]);
+		}
+
+		UMassProcessor* Processor = ProcessingNode.Processor;
+		if (Processor->IsA<UMassCompositeProcessor>())
+		{
+			FGraphEventRef CompositeEvent = Processor->DispatchProcessorTasks(EntityManager, ExecutionContext, Prerequisites);
+			if (CompositeEvent.IsValid() == false)
+			{
+				CompositeEvent = FFunctionGraphTask::CreateAndDispatchWhenReady([]() {}, TStatId(), &Prerequisites, ENamedThreads::AnyHiPriThreadHiPriTask);
+			}
+			Events.Add(CompositeEvent);
+			continue;
+		}
+
+		const ENamedThreads::Type DesiredThread = Processor->DoesRequireGameThreadExecution()
+			? ENamedThreads::GameThread : ENamedThreads::AnyHiPriThreadNormalTask;
+
+		Events.Add(FFunctionGraphTask::CreateAndDispatchWhenReady(
+			[this, Processor, EntityManager, bAttributeCommands, bCountEntities, TaskContext = ExecutionContext]() mutable
+			{
+				ExecuteProcessorTask(*Processor, EntityManager, TaskContext, bAttributeCommands, bCountEntities);
+			}
+			, TStatId(), &Prerequisites, DesiredThread));
+	}
+
+	// the phase flushes the deferred commands itself once this event completes
+	return FFunctionGraphTask::CreateAndDispatchWhenReady([this, EntityManager]()
+		{
+			BeginPhaseFlush(*EntityManager);
+		}
+		, TStatId(), &Events, ENamedThreads::AnyHiPriThreadHiPriTask);
+}
+
+void UMassProfiledCompositeProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
+{
+	FMassProcessorProfiler& Profiler = FMassProcessorProfiler::Get();
+	if (Profiler.IsActive() == false)
+	{
+		Super::Execute(EntityManager, Context);
+		return;
+	}
+
+	RefreshProfilerNodeNames();
+	BindPhaseFinished();
+
+	const EMassProcessingPhase Phase = GetProcessingPhase();
+	Profiler.BroadcastPhaseBegin(Phase);
+
+	const bool bAttributeCommands = Profiler.IsAttributingCommands();
+	const bool bCountEntities = Profiler.IsCountingEntities();
+	UE::MassHelper::Private::FCommandCounts CommandCountsBefore;
+	TArray<FMassEntityHandle> TargetEntities;
+
+	for (UMassProcessor* Processor : ChildPipeline.GetMutableProcessors())
+	{
+		FMassProcessorExecutionRecord Record;
+		Record.NodeName = ProfilerNodeNames.FindRef(Processor);
+		Record.Processor = Processor;
+		Record.Phase = Phase;
+		Record.ThreadId = FPlatformTLS::GetCurrentThreadId();
+
+		if (bAttributeCommands)
+		{
+			UE::MassHelper::Private::GatherCommandCounts(Context.Defer(), CommandCountsBefore);
+		}
+		if (bCountEntities)
+		{
+			UE::MassHelper::Private::GatherMatchedArchetypes(*Processor, EntityManager, Record);
+		}
+
+		Record.BeginCycles = FPlatformTime::Cycles64();
+		Processor->CallExecute(EntityManager, Context);
+		Record.EndCycles = FPlatformTime::Cycles64();
+
+		if (bAttributeCommands)
+		{
+			TargetEntities.Reset();
+			UE::MassHelper::Private::ReportIssuedCommands(Context.Defer(), CommandCountsBefore, Record, TargetEntities);
+			AddPendingTargetEntities(Record.NodeName, TargetEntities);
+		}
+
+		Profiler.BroadcastProcessorExecuted(Record);
+	}
+
+	BeginPhaseFlush(EntityManager);
+}
+
+void UMassProfiledCompositeProcessor::BindPhaseFinished()
+{
+	if (PhaseFinishedHandle.IsValid())
+	{
+		return;
+	}
+	if (UMassSimulationSubsystem* SimulationSubsystem = Cast<UMassSimulationSubsystem>(GetOuter()))
+	{
+		PhaseFinishedHandle = SimulationSubsystem->GetOnProcessingPhaseFinished(GetProcessingPhase()).AddUObject(this, &UMassProfiledCompositeProcessor::OnProcessingPhaseFinished);
+	}
+}
+
+void UMassProfiledCompositeProcessor::BeginPhaseFlush(FMassEntityManager& EntityManager)
+{
+	FMassProcessorProfiler& Profiler = FMassProcessorProfiler::Get();
+	if (PhaseFinishedHandle.IsValid() == false)
+	{
+		// not a phase processor, whoever runs it decides when to flush
+		PendingTargetEntities.Reset();
+		Profiler.BroadcastPhaseEnd(GetProcessingPhase());
+		return;
+	}
+
+	if (Profiler.IsAttributingCommands())
+	{
+		// every processor task is done, nothing adds target entities until the next phase run
+		FlushEntityManager = EntityManager.AsShared();
+		ArchetypesBeforeFlush.Reset();
+		for (const TPair<FName, TArray<FMassEntityHandle>>& Issuer : PendingTargetEntities)
+		{
+			for (const FMassEntityHandle Entity : Issuer.Value)
+			{
+				ArchetypesBeforeFlush.Add(Entity, UE::MassHelper::Private::GetEntityArchetype(EntityManager, Entity));
+			}
+		}
+	}
+	FlushBeginCycles = FPlatformTime::Cycles64();
+}
+
+void UMassProfiledCompositeProcessor::OnProcessingPhaseFinished(const float DeltaSeconds)
+{
+	if (FlushBeginCycles == 0)
+	{
+		// the phase ran uninstrumented
+		return;
+	}
+
+	const EMassProcessingPhase Phase = GetProcessingPhase();
+	FMassProcessorProfiler& Profiler = FMassProcessorProfiler::Get();
+	Profiler.BroadcastCommandsFlushed(Phase, FlushBeginCycles, FPlatformTime::Cycles64());
+	FlushBeginCycles = 0;
+
+	if (const TSharedPtr<FMassEntityManager> EntityManager = FlushEntityManager.Pin())
+	{
+		FMassPhaseTransitionsRecord Record;
+		Record.Phase = Phase;
+		UE::MassHelper::Private::GatherTransitions(*EntityManager, PendingTargetEntities, ArchetypesBeforeFlush, Record);
+		Profiler.BroadcastPhaseTransitions(Record);
+	}
+	FlushEntityManager.Reset();
+	ArchetypesBeforeFlush.Reset();
+	PendingTargetEntities.Reset();
+
+	Profiler.BroadcastPhaseEnd(Phase);
+}
+
+void UMassProfiledCompositeProcessor::RefreshProfilerNodeNames()
+{
+	TConstArrayView<UMassProcessor*> ChildProcessors = GetChildProcessorsView();
+	if (ProfilerNodeNames.Num() == ChildProcessors.Num())
+	{
+		return;
+	}
+
+	// same naming rules FMassProcessorDependencySolver applies: the first instance of a class is known by the class
+	// name, every subsequent instance by its own object name
+	ProfilerNodeNames.Reset();
+	TSet<FName> UsedNames;
+	for (const UMassProcessor* Processor : ChildProcessors)
+	{
+		if (Processor == nullptr)
+		{
+			continue;
+		}
+		FName NodeName = Processor->GetClass()->GetFName();
+		bool bAlreadyUsed = false;
+		UsedNames.Add(NodeName, &bAlreadyUsed);
+		if (bAlreadyUsed)
+		{
+			NodeName = Processor->GetFName();
+		}
+		ProfilerNodeNames.Add(Processor, NodeName);
+	}
+}
+
+UMassCompositeProcessor* UMassProfiledCompositeProcessor::FindPhaseProcessor(UObject& PhaseOwner, const EMassProcessingPhase Phase)
+{
+	// FMassProcessingPhaseManager creates its phase processors with the simulation subsystem as outer and names them
+	// "ProcessingPhase_<PhaseName>"
+	UMassCompositeProcessor* FoundProcessor = nullptr;
+	ForEachObjectWithOuter(&PhaseOwner, [&FoundProcessor, Phase](UObject* Object)
+		{
+			UMassCompositeProcessor* Composite = Cast<UMassCompositeProcessor>(Object);
+			if (FoundProcessor == nullptr && Composite && Composite->GetProcessingPhase() == Phase
+				&& Composite->GetName().StartsWith(TEXT("ProcessingPhase_")))
+			{
+				FoundProcessor = Composite;
+			}
+		}, /*bIncludeNestedObjects=*/false);
+	return FoundProcessor;
+}
+
+bool UMassProfiledCompositeProcessor::WarnIfNoProfiledPhase(UObject& PhaseOwner, const TCHAR* Consequence, const int32 PhaseID)
+{
+	const int32 FirstPhaseID = PhaseID == INDEX_NONE ? 0 : PhaseID;
+	const int32 LastPhaseID = PhaseID == INDEX_NONE ? int32(EMassProcessingPhase::MAX) - 1 : PhaseID;
+	for (int32 ProfiledPhaseID = FirstPhaseID; ProfiledPhaseID <= LastPhaseID; ++ProfiledPhaseID)
+	{
+		const UMassCompositeProcessor* PhaseProcessor = FindPhaseProcessor(PhaseOwner, EMassProcessingPhase(ProfiledPhaseID));
+		if (PhaseProcessor && PhaseProcessor->IsA<UMassProfiledCompositeProcessor>())
+		{
+			return false;
+		}
+	}
+
+	const FString Phases = PhaseID == INDEX_NONE ? FString(TEXT("no phase is")) : FString::Printf(TEXT("phase %d is not"), PhaseID);
+	UE_LOG(LogMass, Warning, TEXT("%s %s running a UMassProfiledCompositeProcessor, %s. Set mass.helper.ProfiledPhases before the world is initialized.")
+		, ANSI_TO_TCHAR(__FUNCTION__), *Phases, Consequence);
+	return true;
+}
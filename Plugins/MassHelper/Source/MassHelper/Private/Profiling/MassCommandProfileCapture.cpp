@@ -0,0 +1,309 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+#include "MassHelper/Public/Profiling/MassCommandProfileCapture.h"
+#include "MassHelper/Public/Processor/MassDependencyJsonWriter.h"
+
+#include "MassEntity/Public/MassArchetypeData.h"
+
+#include "Async/Async.h"
+
+namespace UE::MassHelper::Private
+{
+	const TCHAR* CommandOperationToString(const EMassCommandOperationType OperationType)
+	{
+		switch (OperationType)
+		{
+		case EMassCommandOperationType::Create: return TEXT("Create");
+		case EMassCommandOperationType::Add: return TEXT("Add");
+		case EMassCommandOperationType::Remove: return TEXT("Remove");
+		case EMassCommandOperationType::ChangeComposition: return TEXT("ChangeComposition");
+		case EMassCommandOperationType::Set: return TEXT("Set");
+		case EMassCommandOperationType::Destroy: return TEXT("Destroy");
+		default: return TEXT("None");
+		}
+	}
+
+	template<typename TBitSet>
+	void DiffTypes(const TBitSet& From, const TBitSet& To, TArray<FName>& OutAdded, TArray<FName>& OutRemoved)
+	{
+		TArray<const UStruct*> FromTypes;
+		TArray<const UStruct*> ToTypes;
+		From.ExportTypes(FromTypes);
+		To.ExportTypes(ToTypes);
+		for (const UStruct* Type : ToTypes)
+		{
+			if (Type && FromTypes.Contains(Type) == false)
+			{
+				OutAdded.Add(Type->GetFName());
+			}
+		}
+		for (const UStruct* Type : FromTypes)
+		{
+			if (Type && ToTypes.Contains(Type) == false)
+			{
+				OutRemoved.Add(Type->GetFName());
+			}
+		}
+	}
+
+	/** Writes the two archetypes by composition hash along with what the move added and removed. */
+	void WriteTransitionFields(FMassDependencyJsonWriter& Writer, const FMassArchetypeData& From, const FMassArchetypeData& To)
+	{
+		const FMassArchetypeCompositionDescriptor& FromComposition = From.GetCompositionDescriptor();
+		const FMassArchetypeCompositionDescriptor& ToComposition = To.GetCompositionDescriptor();
+		TArray<FName> Added;
+		TArray<FName> Removed;
+		DiffTypes(FromComposition.Fragments, ToComposition.Fragments, Added, Removed);
+		DiffTypes(FromComposition.Tags, ToComposition.Tags, Added, Removed);
+		DiffTypes(FromComposition.ChunkFragments, ToComposition.ChunkFragments, Added, Removed);
+		DiffTypes(FromComposition.SharedFragments, ToComposition.SharedFragments, Added, Removed);
+
+		Writer.WriteStringField(TEXT("From"), FString::Printf(TEXT("%08X"), FromComposition.CalculateHash()));
+		Writer.WriteStringField(TEXT("To"), FString::Printf(TEXT("%08X"), ToComposition.CalculateHash()));
+		Writer.WriteKey(TEXT("Added"));
+		Writer.BeginArray();
+		for (const FName Type : Added)
+		{
+			Writer.WriteName(Type);
+		}
+		Writer.EndArray();
+		Writer.WriteKey(TEXT("Removed"));
+		Writer.BeginArray();
+		for (const FName Type : Removed)
+		{
+			Writer.WriteName(Type);
+		}
+		Writer.EndArray();
+	}
+}
+
+FMassCommandProfileCapture::FMassCommandProfileCapture(const int32 InFrameCount)
+	: FrameCount(FMath::Max(1, InFrameCount))
+{
+}
+
+void FMassCommandProfileCapture::Start()
+{
+	{
+		FScopeLock Lock(&StatsCS);
+		if (bStarted)
+		{
+			return;
+		}
+		bStarted = true;
+		StartFrame = GFrameCounter;
+	}
+	FMassProcessorProfiler::Get().AddCommandAttribution();
+	FMassProcessorProfiler::Get().AddListener(AsShared());
+}
+
+void FMassCommandProfileCapture::Stop()
+{
+	{
+		FScopeLock Lock(&StatsCS);
+		if (bStarted == false)
+		{
+			return;
+		}
+		bStarted = false;
+		bCompleted = true;
+		CapturedFrames = int32(GFrameCounter - StartFrame);
+	}
+	FMassProcessorProfiler::Get().RemoveListener(AsShared());
+	FMassProcessorProfiler::Get().RemoveCommandAttribution();
+}
+
+void FMassCommandProfileCapture::OnPhaseBegin(const EMassProcessingPhase Phase, const uint64 Cycles)
+{
+	{
+		FScopeLock Lock(&StatsCS);
+		if (bCompleted || GFrameCounter < StartFrame + FrameCount)
+		{
+			return;
+		}
+		bCompleted = true;
+	}
+
+	// phases can begin on any thread, the capture is handed over on the game thread
+	AsyncTask(ENamedThreads::GameThread, [WeakThis = AsWeak()]()
+		{
+			if (TSharedPtr<FMassCommandProfileCapture> This = WeakThis.Pin())
+			{
+				This->Stop();
+				if (This->OnCompleted)
+				{
+					This->OnCompleted(*This);
+				}
+			}
+		});
+}
+
+void FMassCommandProfileCapture::OnCommandsFlushed(const EMassProcessingPhase Phase, const uint32 ThreadId, const uint64 BeginCycles, const uint64 EndCycles)
+{
+	const double FlushMs = FPlatformTime::ToMilliseconds64(EndCycles - BeginCycles);
+
+	FScopeLock Lock(&StatsCS);
+	if (bCompleted)
+	{
+		return;
+	}
+	FPhaseStats& Stats = Phases.FindOrAdd(Phase);
+	++Stats.FlushCount;
+	Stats.FlushMs += FlushMs;
+	Stats.MaxFlushMs = FMath::Max(Stats.MaxFlushMs, FlushMs);
+}
+
+void FMassCommandProfileCapture::OnProcessorCommandsIssued(const FMassProcessorCommandsRecord& Record)
+{
+	using namespace UE::MassHelper::Private;
+
+	FScopeLock Lock(&StatsCS);
+	if (bCompleted)
+	{
+		return;
+	}
+
+	FProcessorStats& Stats = Processors.FindOrAdd(MakeTuple(Record.NodeName, Record.Phase));
+	Stats.NodeName = Record.NodeName;
+	Stats.Phase = Record.Phase;
+	++Stats.IssueCount;
+	for (const FMassProcessorCommandsRecord::FCommandBatch& Batch : Record.Commands)
+	{
+		FCommandStats& CommandStats = Stats.Commands.FindOrAdd(Batch.Name.IsNone() ? FName(CommandOperationToString(Batch.OperationType)) : Batch.Name);
+		CommandStats.OperationType = Batch.OperationType;
+		++CommandStats.BatchCount;
+		CommandStats.OperationCount += Batch.OperationCount;
+	}
+}
+
+void FMassCommandProfileCapture::OnPhaseTransitions(const FMassPhaseTransitionsRecord& Record)
+{
+	FScopeLock Lock(&StatsCS);
+	if (bCompleted)
+	{
+		return;
+	}
+
+	FPhaseStats& Stats = Phases.FindOrAdd(Record.Phase);
+	for (const FMassPhaseTransitionsRecord::FTransition& Transition : Record.Transitions)
+	{
+		if (Transition.From == nullptr || Transition.To == nullptr)
+		{
+			// an entity reserved before the flush or destroyed by it
+			(Transition.From ? Stats.DestroyedEntities : Stats.CreatedEntities) += Transition.EntityCount;
+			continue;
+		}
+
+		FTransitionStats& TransitionStats = Stats.Transitions.FindOrAdd(FTransitionKey(Transition.From.Get(), Transition.To.Get()));
+		TransitionStats.Count += Transition.EntityCount;
+		for (const TPair<FName, int32>& Issuer : Transition.Issuers)
+		{
+			TransitionStats.Issuers.FindOrAdd(Issuer.Key) += Issuer.Value;
+		}
+		Stats.MovedEntities += Transition.EntityCount;
+		Archetypes.Add(Transition.From.Get(), Transition.From);
+		Archetypes.Add(Transition.To.Get(), Transition.To);
+	}
+}
+
+void FMassCommandProfileCapture::Write(FArchive& OutArchive) const
+{
+	using namespace UE::MassHelper::Private;
+
+	FScopeLock Lock(&StatsCS);
+	const double FrameScale = 1. / FMath::Max(1, CapturedFrames);
+
+	TArray<const FProcessorStats*> SortedProcessors;
+	for (const TPair<TPair<FName, EMassProcessingPhase>, FProcessorStats>& It : Processors)
+	{
+		SortedProcessors.Add(&It.Value);
+	}
+	SortedProcessors.Sort([](const FProcessorStats& A, const FProcessorStats& B) { return A.IssueCount > B.IssueCount; });
+
+	TArray<TTuple<EMassProcessingPhase, FTransitionKey, const FTransitionStats*>> SortedTransitions;
+	for (const TPair<EMassProcessingPhase, FPhaseStats>& Phase : Phases)
+	{
+		for (const TPair<FTransitionKey, FTransitionStats>& Transition : Phase.Value.Transitions)
+		{
+			SortedTransitions.Emplace(Phase.Key, Transition.Key, &Transition.Value);
+		}
+	}
+	SortedTransitions.Sort([](const TTuple<EMassProcessingPhase, FTransitionKey, const FTransitionStats*>& A, const TTuple<EMassProcessingPhase, FTransitionKey, const FTransitionStats*>& B)
+		{
+			return A.Get<2>()->Count > B.Get<2>()->Count;
+		});
+
+	auto PhaseName = [](const EMassProcessingPhase Phase) { return UEnum::GetDisplayValueAsText(Phase).ToString(); };
+
+	FMassDependencyJsonWriter Writer(OutArchive);
+	Writer.BeginObject();
+	Writer.WriteStringField(TEXT("PrintMode"), TEXT("CommandProfile"));
+	Writer.WriteNumberField(TEXT("FrameCount"), CapturedFrames);
+
+	Writer.WriteKey(TEXT("Processors"));
+	Writer.BeginArray();
+	for (const FProcessorStats* Stats : SortedProcessors)
+	{
+		Writer.BeginObject();
+		Writer.WriteNameField(TEXT("Name"), Stats->NodeName);
+		Writer.WriteStringField(TEXT("Phase"), PhaseName(Stats->Phase));
+		Writer.WriteNumberField(TEXT("IssueCount"), Stats->IssueCount);
+
+		Writer.WriteKey(TEXT("Commands"));
+		Writer.BeginArray();
+		for (const TPair<FName, FCommandStats>& Command : Stats->Commands)
+		{
+			Writer.BeginObject();
+			Writer.WriteNameField(TEXT("Name"), Command.Key);
+			Writer.WriteStringField(TEXT("OperationType"), CommandOperationToString(Command.Value.OperationType));
+			Writer.WriteNumberField(TEXT("Batches"), Command.Value.BatchCount);
+			Writer.WriteNumberField(TEXT("Operations"), double(Command.Value.OperationCount));
+			Writer.EndObject();
+		}
+		Writer.EndArray();
+		Writer.EndObject();
+	}
+	Writer.EndArray();
+
+	Writer.WriteKey(TEXT("Phases"));
+	Writer.BeginArray();
+	for (const TPair<EMassProcessingPhase, FPhaseStats>& Phase : Phases)
+	{
+		Writer.BeginObject();
+		Writer.WriteStringField(TEXT("Phase"), PhaseName(Phase.Key));
+		Writer.WriteNumberField(TEXT("FlushCount"), Phase.Value.FlushCount);
+		Writer.WriteNumberField(TEXT("FlushMsPerFrame"), Phase.Value.FlushMs * FrameScale);
+		Writer.WriteNumberField(TEXT("MaxFlushMs"), Phase.Value.MaxFlushMs);
+		Writer.WriteNumberField(TEXT("MovedEntitiesPerFrame"), Phase.Value.MovedEntities * FrameScale);
+		Writer.WriteNumberField(TEXT("MovedEntities"), double(Phase.Value.MovedEntities));
+		Writer.WriteNumberField(TEXT("CreatedEntities"), double(Phase.Value.CreatedEntities));
+		Writer.WriteNumberField(TEXT("DestroyedEntities"), double(Phase.Value.DestroyedEntities));
+		Writer.EndObject();
+	}
+	Writer.EndArray();
+
+	Writer.WriteKey(TEXT("Transitions"));
+	Writer.BeginArray();
+	for (const TTuple<EMassProcessingPhase, FTransitionKey, const FTransitionStats*>& Transition : SortedTransitions)
+	{
+		const FTransitionStats& Stats = *Transition.Get<2>();
+		Writer.BeginObject();
+		Writer.WriteStringField(TEXT("Phase"), PhaseName(Transition.Get<0>()));
+		WriteTransitionFields(Writer, *Transition.Get<1>().Key, *Transition.Get<1>().Value);
+		Writer.WriteNumberField(TEXT("Count"), double(Stats.Count));
+		Writer.WriteNumberField(TEXT("CountPerFrame"), Stats.Count * FrameScale);
+		Writer.WriteKey(TEXT("Issuers"));
+		Writer.BeginArray();
+		for (const TPair<FName, int64>& Issuer : Stats.Issuers)
+		{
+			Writer.BeginObject();
+			Writer.WriteNameField(TEXT("Name"), Issuer.Key);
+			Writer.WriteNumberField(TEXT("Count"), double(Issuer.Value));
+			Writer.EndObject();
+		}
+		Writer.EndArray();
+		Writer.EndObject();
+	}
+	Writer.EndArray();
+
+	Writer.EndObject();
+}
@@ -0,0 +1,356 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+#include "MassHelper/Public/Profiling/MassLODTickCapture.h"
+#include "MassHelper/Public/Processor/MassProfiledCompositeProcessor.h"
+#include "MassHelper/Public/Processor/MassDependencyJsonWriter.h"
+#include "MassHelper/Public/Analysis/MassArchetypeMemoryReport.h"
+
+#include "MassEntity/Public/MassArchetypeData.h"
+#include "MassEntity/Public/MassEntitySubsystem.h"
+#include "MassEntity/Public/MassExecutionContext.h"
+#include "MassLOD/Public/MassLODFragments.h"
+#include "MassLOD/Public/MassSimulationLOD.h"
+#include "MassSimulation/Public/MassSimulationSubsystem.h"
+
+#include "Misc/App.h"
+#include "Misc/CoreDelegates.h"
+
+namespace UE::MassHelper::Private
+{
+	int32 GetLODTagBucket(const FMassTagBitSet& Tags)
+	{
+		if (Tags.Contains<FMassHighLODTag>())
+		{
+			return int32(EMassLOD::High);
+		}
+		if (Tags.Contains<FMassMediumLODTag>())
+		{
+			return int32(EMassLOD::Medium);
+		}
+		if (Tags.Contains<FMassLowLODTag>())
+		{
+			return int32(EMassLOD::Low);
+		}
+		if (Tags.Contains<FMassOffLODTag>())
+		{
+			return int32(EMassLOD::Off);
+		}
+		return int32(EMassLOD::Max);
+	}
+
+	const TCHAR* LODBucketToString(const int32 Bucket)
+	{
+		switch (EMassLOD::Type(Bucket))
+		{
+		case EMassLOD::High: return TEXT("High");
+		case EMassLOD::Medium: return TEXT("Medium");
+		case EMassLOD::Low: return TEXT("Low");
+		case EMassLOD::Off: return TEXT("Off");
+		default: return TEXT("None");
+		}
+	}
+}
+
+FMassLODTickCapture::FMassLODTickCapture(UWorld& InWorld, const int32 InFrameCount)
+	: World(&InWorld)
+	, FrameCount(FMath::Max(1, InFrameCount))
+{
+	VariableTickQuery.AddChunkRequirement<FMassSimulationVariableTickChunkFragment>(EMassFragmentAccess::ReadOnly);
+}
+
+FMassLODTickCapture::~FMassLODTickCapture()
+{
+	FCoreDelegates::OnEndFrame.Remove(EndFrameHandle);
+}
+
+void FMassLODTickCapture::Start()
+{
+	check(IsInGameThread());
+	if (EndFrameHandle.IsValid())
+	{
+		return;
+	}
+	EndFrameHandle = FCoreDelegates::OnEndFrame.AddSP(this, &FMassLODTickCapture::OnEndFrame);
+	FMassProcessorProfiler::Get().AddEntityCounting();
+	FMassProcessorProfiler::Get().AddListener(AsShared());
+}
+
+void FMassLODTickCapture::Stop()
+{
+	check(IsInGameThread());
+	if (EndFrameHandle.IsValid() == false)
+	{
+		return;
+	}
+	FMassProcessorProfiler::Get().RemoveListener(AsShared());
+	FMassProcessorProfiler::Get().RemoveEntityCounting();
+	FCoreDelegates::OnEndFrame.Remove(EndFrameHandle);
+	EndFrameHandle.Reset();
+	bCompleted = true;
+}
+
+void FMassLODTickCapture::OnProcessorExecuted(const FMassProcessorExecutionRecord& Record)
+{
+	FScopeLock Lock(&PendingCS);
+	FPendingTiming& Timing = PendingTimings.FindOrAdd(Record.Processor);
+	Timing.NodeName = Record.NodeName;
+	Timing.Ms += Record.GetDurationMs();
+	Timing.MatchedArchetypes = Record.MatchedArchetypes;
+}
+
+void FMassLODTickCapture::OnEndFrame()
+{
+	if (World.IsValid() == false)
+	{
+		Stop();
+		return;
+	}
+
+	SampleFrame();
+	if (Frames.Num() >= FrameCount)
+	{
+		Stop();
+		if (OnCompleted)
+		{
+			OnCompleted(*this);
+		}
+	}
+}
+
+void FMassLODTickCapture::RefreshLODAwareProcessors()
+{
+	UMassSimulationSubsystem* SimulationSubsystem = UWorld::GetSubsystem<UMassSimulationSubsystem>(World.Get());
+	if (SimulationSubsystem == nullptr)
+	{
+		return;
+	}
+
+	for (int32 PhaseIndex = 0; PhaseIndex < int32(EMassProcessingPhase::MAX); ++PhaseIndex)
+	{
+		const EMassProcessingPhase Phase = EMassProcessingPhase(PhaseIndex);
+		UMassCompositeProcessor* PhaseProcessor = UMassProfiledCompositeProcessor::FindPhaseProcessor(*SimulationSubsystem, Phase);
+		if (PhaseProcessor == nullptr)
+		{
+			continue;
+		}
+
+		for (UMassProcessor* Processor : PhaseProcessor->GetChildProcessorsView())
+		{
+			const int32* ExistingIndex = Processor ? ProcessorIndices.Find(Processor) : nullptr;
+			if (Processor == nullptr || (ExistingIndex && (*ExistingIndex == INDEX_NONE || ProcessorInfos[*ExistingIndex].Processor.Get() == Processor)))
+			{
+				continue;
+			}
+
+			// the variable tick chunk filter needs the chunk fragment, processors declaring it are the LOD aware ones
+			FMassExecutionRequirements Requirements;
+			Processor->ExportRequirements(Requirements);
+			const bool bLODAware = Requirements.ChunkFragments.Read.Contains<FMassSimulationVariableTickChunkFragment>()
+				|| Requirements.ChunkFragments.Write.Contains<FMassSimulationVariableTickChunkFragment>();
+			if (bLODAware == false)
+			{
+				ProcessorIndices.Add(Processor, INDEX_NONE);
+				continue;
+			}
+
+			FProcessorInfo& Info = ProcessorInfos.AddDefaulted_GetRef();
+			Info.Processor = Processor;
+			Info.NodeName = Processor->GetClass()->GetFName();
+			Info.Phase = Phase;
+			ProcessorIndices.Add(Processor, ProcessorInfos.Num() - 1);
+		}
+	}
+}
+
+void FMassLODTickCapture::SampleFrame()
+{
+	using namespace UE::MassHelper::Private;
+
+	UMassEntitySubsystem* EntitySubsystem = UWorld::GetSubsystem<UMassEntitySubsystem>(World.Get());
+	if (EntitySubsystem == nullptr)
+	{
+		return;
+	}
+	FMassEntityManager& EntityManager = EntitySubsystem->GetMutableEntityManager();
+
+	RefreshLODAwareProcessors();
+
+	FFrameSample& Sample = Frames.AddDefaulted_GetRef();
+	Sample.Frame = GFrameCounter;
+	Sample.FrameMs = FApp::GetDeltaTime() * 1000.;
+
+	TArray<TSharedPtr<FMassArchetypeData>> Archetypes;
+	FMassArchetypeMemoryReport::GetArchetypes(EntityManager, Archetypes);
+	for (const TSharedPtr<FMassArchetypeData>& ArchetypeData : Archetypes)
+	{
+		Sample.TaggedEntities[GetLODTagBucket(ArchetypeData->GetCompositionDescriptor().Tags)] += ArchetypeData->GetNumEntities();
+	}
+
+	// the LOD processors decided this frame's ticking before any simulation processor ran, the chunks still hold that decision
+	TMap<const FMassArchetypeData*, FTickCounts> ArchetypeTicks;
+	FMassExecutionContext Context(EntityManager);
+	VariableTickQuery.ForEachEntityChunk(EntityManager, Context, [&Sample, &ArchetypeTicks](FMassExecutionContext& ChunkContext)
+		{
+			const FMassSimulationVariableTickChunkFragment& TickChunk = ChunkContext.GetChunkFragment<FMassSimulationVariableTickChunkFragment>();
+			const FMassArchetypeData* ArchetypeData = FMassArchetypeHelper::ArchetypeDataFromHandle(ChunkContext.GetEntityCollection().GetArchetype());
+			const int32 LODBucket = FMath::Clamp(int32(TickChunk.GetLOD()), 0, LODBucketCount - 1);
+			const bool bTicked = TickChunk.ShouldTickThisFrame();
+			(bTicked ? Sample.VariableTickEntities[LODBucket].Ticked : Sample.VariableTickEntities[LODBucket].Skipped) += ChunkContext.GetNumEntities();
+			FTickCounts& Ticks = ArchetypeTicks.FindOrAdd(ArchetypeData);
+			(bTicked ? Ticks.Ticked : Ticks.Skipped) += ChunkContext.GetNumEntities();
+		});
+
+	TMap<const UMassProcessor*, FPendingTiming> Timings;
+	{
+		FScopeLock Lock(&PendingCS);
+		Timings = MoveTemp(PendingTimings);
+		PendingTimings.Reset();
+	}
+	for (const TPair<const UMassProcessor*, FPendingTiming>& Timing : Timings)
+	{
+		Sample.ProcessorMs += Timing.Value.Ms;
+	}
+
+	for (int32 ProcessorIndex = 0; ProcessorIndex < ProcessorInfos.Num(); ++ProcessorIndex)
+	{
+		FProcessorInfo& Info = ProcessorInfos[ProcessorIndex];
+		const UMassProcessor* Processor = Info.Processor.Get();
+		if (Processor == nullptr)
+		{
+			continue;
+		}
+
+		// a processor that didn't run this frame neither ticked nor skipped anything
+		FPendingTiming* Timing = Timings.Find(Processor);
+		if (Timing == nullptr)
+		{
+			continue;
+		}
+
+		FProcessorSample& ProcessorSample = Sample.Processors.AddDefaulted_GetRef();
+		ProcessorSample.ProcessorIndex = ProcessorIndex;
+
+		// the matches come from the processor's own execution, the live queries are never touched from here
+		Info.MatchedArchetypes = MoveTemp(Timing->MatchedArchetypes);
+		for (const TPair<const FMassArchetypeData*, int32>& MatchedArchetype : Info.MatchedArchetypes)
+		{
+			if (const FTickCounts* Ticks = ArchetypeTicks.Find(MatchedArchetype.Key))
+			{
+				ProcessorSample.Entities.Ticked += Ticks->Ticked;
+				ProcessorSample.Entities.Skipped += Ticks->Skipped;
+			}
+			else
+			{
+				// no variable tick chunks, the chunk filter lets everything through
+				ProcessorSample.Entities.Ticked += MatchedArchetype.Value;
+			}
+		}
+
+		ProcessorSample.Ms = Timing->Ms;
+		Info.NodeName = Timing->NodeName.IsNone() ? Info.NodeName : Timing->NodeName;
+		Info.Ms += Timing->Ms;
+		Info.Entities.Ticked += ProcessorSample.Entities.Ticked;
+		Info.Entities.Skipped += ProcessorSample.Entities.Skipped;
+		++Info.ExecutedFrames;
+		ProcessorSample.SavedMs = ProcessorSample.Entities.Skipped * Info.GetMsPerEntity();
+		Info.SavedMs += ProcessorSample.SavedMs;
+
+		Sample.LODAwareProcessorMs += ProcessorSample.Ms;
+		Sample.SavedMs += ProcessorSample.SavedMs;
+	}
+}
+
+void FMassLODTickCapture::Write(FArchive& OutArchive) const
+{
+	using namespace UE::MassHelper::Private;
+
+	auto WriteLODCounts = [](FMassDependencyJsonWriter& Writer, const TCHAR* Key, const int32* Counts)
+	{
+		Writer.WriteKey(Key);
+		Writer.BeginObject();
+		for (int32 Bucket = 0; Bucket < LODBucketCount; ++Bucket)
+		{
+			Writer.WriteNumberField(LODBucketToString(Bucket), Counts[Bucket]);
+		}
+		Writer.EndObject();
+	};
+	auto WriteTickCounts = [](FMassDependencyJsonWriter& Writer, const FTickCounts& Counts)
+	{
+		Writer.WriteNumberField(TEXT("Ticked"), double(Counts.Ticked));
+		Writer.WriteNumberField(TEXT("Skipped"), double(Counts.Skipped));
+	};
+
+	double TotalProcessorMs = 0.;
+	double TotalSavedMs = 0.;
+	for (const FFrameSample& Sample : Frames)
+	{
+		TotalProcessorMs += Sample.ProcessorMs;
+		TotalSavedMs += Sample.SavedMs;
+	}
+	const double FrameScale = 1. / FMath::Max(1, Frames.Num());
+
+	FMassDependencyJsonWriter Writer(OutArchive);
+	Writer.BeginObject();
+	Writer.WriteStringField(TEXT("PrintMode"), TEXT("LODTick"));
+	Writer.WriteNumberField(TEXT("FrameCount"), Frames.Num());
+	Writer.WriteNumberField(TEXT("ProcessorMsPerFrame"), TotalProcessorMs * FrameScale);
+	Writer.WriteNumberField(TEXT("SavedMsPerFrame"), TotalSavedMs * FrameScale);
+	// share of the tick-everything cost the variable tick rate avoids
+	Writer.WriteNumberField(TEXT("SavedRatio"), TotalSavedMs > 0. ? TotalSavedMs / (TotalProcessorMs + TotalSavedMs) : 0.);
+
+	Writer.WriteKey(TEXT("Processors"));
+	Writer.BeginArray();
+	for (const FProcessorInfo& Info : ProcessorInfos)
+	{
+		Writer.BeginObject();
+		Writer.WriteNameField(TEXT("Name"), Info.NodeName);
+		Writer.WriteStringField(TEXT("Phase"), UEnum::GetDisplayValueAsText(Info.Phase).ToString());
+		Writer.WriteNumberField(TEXT("ExecutedFrames"), Info.ExecutedFrames);
+		WriteTickCounts(Writer, Info.Entities);
+		Writer.WriteNumberField(TEXT("MsPerFrame"), Info.Ms * FrameScale);
+		Writer.WriteNumberField(TEXT("UsPerTickedEntity"), Info.GetMsPerEntity() * 1000.);
+		Writer.WriteNumberField(TEXT("SavedMsPerFrame"), Info.SavedMs * FrameScale);
+		Writer.EndObject();
+	}
+	Writer.EndArray();
+
+	Writer.WriteKey(TEXT("Frames"));
+	Writer.BeginArray();
+	for (const FFrameSample& Sample : Frames)
+	{
+		Writer.BeginObject();
+		Writer.WriteNumberField(TEXT("Frame"), double(Sample.Frame));
+		Writer.WriteNumberField(TEXT("FrameMs"), Sample.FrameMs);
+		Writer.WriteNumberField(TEXT("ProcessorMs"), Sample.ProcessorMs);
+		Writer.WriteNumberField(TEXT("LODAwareProcessorMs"), Sample.LODAwareProcessorMs);
+		Writer.WriteNumberField(TEXT("SavedMs"), Sample.SavedMs);
+		WriteLODCounts(Writer, TEXT("TaggedEntities"), Sample.TaggedEntities);
+
+		Writer.WriteKey(TEXT("VariableTickEntities"));
+		Writer.BeginObject();
+		for (int32 Bucket = 0; Bucket < LODBucketCount; ++Bucket)
+		{
+			Writer.WriteKey(LODBucketToString(Bucket));
+			Writer.BeginObject();
+			WriteTickCounts(Writer, Sample.VariableTickEntities[Bucket]);
+			Writer.EndObject();
+		}
+		Writer.EndObject();
+
+		Writer.WriteKey(TEXT("Processors"));
+		Writer.BeginArray();
+		for (const FProcessorSample& ProcessorSample : Sample.Processors)
+		{
+			Writer.BeginObject();
+			Writer.WriteNameField(TEXT("Name"), ProcessorInfos[ProcessorSample.ProcessorIndex].NodeName);
+			WriteTickCounts(Writer, ProcessorSample.Entities);
+			Writer.WriteNumberField(TEXT("Ms"), ProcessorSample.Ms);
+			Writer.WriteNumberField(TEXT("SavedMs"), ProcessorSample.SavedMs);
+			Writer.EndObject();
+		}
+		Writer.EndArray();
+		Writer.EndObject();
+	}
+	Writer.EndArray();
+
+	Writer.EndObject();
+}
@@ -0,0 +1,284 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+#include "MassHelper/Public/Profiling/MassProcessorLiveStats.h"
+
+#include "Debug/DebugDrawService.h"
+#include "Engine/Canvas.h"
+#include "Engine/Engine.h"
+
+namespace UE::MassHelper::Private
+{
+	std::atomic<uint32> NextLiveStatsInstanceId = 1;
+
+	/** Last ring the thread pushed into, saves the ring lookup on every event. */
+	struct FLiveStatsRingCache
+	{
+		uint32 InstanceId = 0;
+		void* Ring = nullptr;
+	};
+	thread_local FLiveStatsRingCache LiveStatsRingCache;
+}
+
+FMassProcessorLiveStats::FMassProcessorLiveStats(UWorld& InWorld, const int32 InTopCount)
+	: World(&InWorld)
+	, TopCount(FMath::Max(1, InTopCount))
+	, InstanceId(UE::MassHelper::Private::NextLiveStatsInstanceId.fetch_add(1))
+{
+}
+
+FMassProcessorLiveStats::~FMassProcessorLiveStats()
+{
+	// the profiler holds a reference while calling us, nobody can be pushing anymore
+	for (std::atomic<FThreadRing*>& Ring : ThreadRings)
+	{
+		delete Ring.load(std::memory_order_acquire);
+	}
+}
+
+void FMassProcessorLiveStats::Start()
+{
+	check(IsInGameThread());
+	if (IsRunning())
+	{
+		return;
+	}
+
+	WindowStartFrame = GFrameCounter;
+	WindowStartSeconds = FPlatformTime::Seconds();
+	LastDrainFrame = GFrameCounter;
+	DrawHandle = UDebugDrawService::Register(TEXT("Game"), FDebugDrawDelegate::CreateSP(this, &FMassProcessorLiveStats::Draw));
+	FMassProcessorProfiler::Get().AddEntityCounting();
+	FMassProcessorProfiler::Get().AddListener(AsShared());
+}
+
+void FMassProcessorLiveStats::Stop()
+{
+	check(IsInGameThread());
+	if (IsRunning() == false)
+	{
+		return;
+	}
+
+	FMassProcessorProfiler::Get().RemoveListener(AsShared());
+	FMassProcessorProfiler::Get().RemoveEntityCounting();
+	UDebugDrawService::Unregister(DrawHandle);
+	DrawHandle.Reset();
+}
+
+FMassProcessorLiveStats::FThreadRing* FMassProcessorLiveStats::GetThreadRing()
+{
+	using namespace UE::MassHelper::Private;
+
+	FLiveStatsRingCache& Cache = LiveStatsRingCache;
+	if (Cache.InstanceId == InstanceId)
+	{
+		return static_cast<FThreadRing*>(Cache.Ring);
+	}
+
+	// the thread may have registered before pushing for another instance in between
+	const uint32 ThreadId = FPlatformTLS::GetCurrentThreadId();
+	FThreadRing* Ring = nullptr;
+	const int32 RingCount = FMath::Min(ThreadRingCount.load(std::memory_order_acquire), MaxThreadRings);
+	for (int32 RingIndex = 0; RingIndex < RingCount && Ring == nullptr; ++RingIndex)
+	{
+		FThreadRing* Candidate = ThreadRings[RingIndex].load(std::memory_order_acquire);
+		Ring = (Candidate && Candidate->ThreadId == ThreadId) ? Candidate : nullptr;
+	}
+
+	if (Ring == nullptr)
+	{
+		const int32 RingIndex = ThreadRingCount.fetch_add(1);
+		if (RingIndex >= MaxThreadRings)
+		{
+			return nullptr;
+		}
+		Ring = new FThreadRing(ThreadId);
+		ThreadRings[RingIndex].store(Ring, std::memory_order_release);
+	}
+
+	Cache.InstanceId = InstanceId;
+	Cache.Ring = Ring;
+	return Ring;
+}
+
+void FMassProcessorLiveStats::PushEvent(const FEvent& Event)
+{
+	FThreadRing* Ring = GetThreadRing();
+	if (Ring == nullptr || Ring->Events.Push(Event) == false)
+	{
+		DroppedEventCount.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+void FMassProcessorLiveStats::OnPhaseBegin(const EMassProcessingPhase Phase, const uint64 Cycles)
+{
+	// a phase never overlaps itself, its end pairs with the last begin
+	PhaseBeginCycles[int(Phase)].store(Cycles, std::memory_order_relaxed);
+}
+
+void FMassProcessorLiveStats::OnPhaseEnd(const EMassProcessingPhase Phase, const uint64 Cycles)
+{
+	const uint64 BeginCycles = PhaseBeginCycles[int(Phase)].exchange(0, std::memory_order_relaxed);
+	if (BeginCycles == 0)
+	{
+		return;
+	}
+
+	FEvent Event;
+	Event.Kind = EEventKind::Phase;
+	Event.Phase = Phase;
+	Event.BeginCycles = BeginCycles;
+	Event.EndCycles = Cycles;
+	PushEvent(Event);
+}
+
+void FMassProcessorLiveStats::OnProcessorExecuted(const FMassProcessorExecutionRecord& Record)
+{
+	FEvent Event;
+	Event.NodeName = Record.NodeName;
+	Event.Kind = EEventKind::Processor;
+	Event.Phase = Record.Phase;
+	Event.BeginCycles = Record.BeginCycles;
+	Event.EndCycles = Record.EndCycles;
+	Event.EntityCount = Record.GetMatchedEntityCount();
+	PushEvent(Event);
+}
+
+void FMassProcessorLiveStats::OnCommandsFlushed(const EMassProcessingPhase Phase, const uint32 ThreadId, const uint64 BeginCycles, const uint64 EndCycles)
+{
+	FEvent Event;
+	Event.Kind = EEventKind::CommandFlush;
+	Event.Phase = Phase;
+	Event.BeginCycles = BeginCycles;
+	Event.EndCycles = EndCycles;
+	PushEvent(Event);
+}
+
+void FMassProcessorLiveStats::DrainEvents()
+{
+	const int32 RingCount = FMath::Min(ThreadRingCount.load(std::memory_order_acquire), MaxThreadRings);
+	for (int32 RingIndex = 0; RingIndex < RingCount; ++RingIndex)
+	{
+		FThreadRing* Ring = ThreadRings[RingIndex].load(std::memory_order_acquire);
+		if (Ring == nullptr)
+		{
+			continue;
+		}
+
+		Ring->Events.Drain([this](const FEvent& Event)
+			{
+				const double DurationMs = FPlatformTime::ToMilliseconds64(Event.EndCycles - Event.BeginCycles);
+				FPhaseStats& PhaseStats = WindowPhases[int(Event.Phase)];
+				switch (Event.Kind)
+				{
+				case EEventKind::Phase:
+					PhaseStats.TotalMs += DurationMs;
+					PhaseStats.MaxMs = FMath::Max(PhaseStats.MaxMs, DurationMs);
+					break;
+				case EEventKind::CommandFlush:
+					PhaseStats.FlushMs += DurationMs;
+					break;
+				case EEventKind::Processor:
+					{
+						FProcessorStats& Stats = WindowProcessors.FindOrAdd(MakeTuple(Event.NodeName, Event.Phase));
+						Stats.NodeName = Event.NodeName;
+						Stats.Phase = Event.Phase;
+						Stats.TotalMs += DurationMs;
+						Stats.EntityCount += Event.EntityCount;
+						++Stats.ExecutionCount;
+					}
+					break;
+				}
+			});
+	}
+}
+
+void FMassProcessorLiveStats::CloseWindow(const int32 FrameCount)
+{
+	Display.FrameCount = FMath::Max(1, FrameCount);
+	const double FrameScale = 1. / Display.FrameCount;
+	for (int32 PhaseIndex = 0; PhaseIndex < int32(EMassProcessingPhase::MAX); ++PhaseIndex)
+	{
+		Display.Phases[PhaseIndex].TotalMs = WindowPhases[PhaseIndex].TotalMs * FrameScale;
+		Display.Phases[PhaseIndex].FlushMs = WindowPhases[PhaseIndex].FlushMs * FrameScale;
+		Display.Phases[PhaseIndex].MaxMs = WindowPhases[PhaseIndex].MaxMs;
+		WindowPhases[PhaseIndex] = FPhaseStats();
+	}
+
+	TArray<FProcessorStats> Processors;
+	WindowProcessors.GenerateValueArray(Processors);
+	WindowProcessors.Reset();
+	Processors.Sort([](const FProcessorStats& A, const FProcessorStats& B) { return A.TotalMs > B.TotalMs; });
+
+	Display.ActiveProcessorCount = Processors.Num();
+	Display.TopProcessors.Reset();
+	Display.TopProcessors.Append(Processors.GetData(), FMath::Min(Processors.Num(), TopCount));
+	for (FProcessorStats& Stats : Display.TopProcessors)
+	{
+		Stats.TotalMs *= FrameScale;
+		Stats.EntityCount /= FMath::Max(1, Stats.ExecutionCount);
+	}
+}
+
+void FMassProcessorLiveStats::Draw(UCanvas* Canvas, APlayerController* PlayerController)
+{
+	if (Canvas == nullptr || World.IsValid() == false)
+	{
+		return;
+	}
+
+	// every viewport draws, the events only get drained once per frame
+	if (LastDrainFrame != GFrameCounter)
+	{
+		LastDrainFrame = GFrameCounter;
+		DrainEvents();
+
+		const double NowSeconds = FPlatformTime::Seconds();
+		if (NowSeconds - WindowStartSeconds >= WindowSeconds)
+		{
+			CloseWindow(int32(GFrameCounter - WindowStartFrame));
+			Display.MeasuredSeconds = NowSeconds - WindowStartSeconds;
+			WindowStartFrame = GFrameCounter;
+			WindowStartSeconds = NowSeconds;
+		}
+	}
+
+	const UFont* Font = GEngine->GetSmallFont();
+	const float LineHeight = Font->GetMaxCharHeight() + 2.f;
+	const float Left = 40.f;
+	float Y = 120.f;
+
+	auto DrawRow = [Canvas, Font, Left, &Y, LineHeight](const FString& Name, const FString& Column1, const FString& Column2, const FString& Column3)
+	{
+		Canvas->DrawText(Font, Name, Left, Y);
+		Canvas->DrawText(Font, Column1, Left + 320.f, Y);
+		Canvas->DrawText(Font, Column2, Left + 400.f, Y);
+		Canvas->DrawText(Font, Column3, Left + 480.f, Y);
+		Y += LineHeight;
+	};
+
+	Canvas->SetDrawColor(FColor::White);
+	const uint32 DroppedCount = DroppedEventCount.load(std::memory_order_relaxed);
+	Canvas->DrawText(Font, FString::Printf(TEXT("Mass stats, per frame over %.2fs%s"), Display.MeasuredSeconds
+		, DroppedCount ? *FString::Printf(TEXT(" (%u events dropped)"), DroppedCount) : TEXT("")), Left, Y);
+	Y += LineHeight * 1.5f;
+
+	Canvas->SetDrawColor(FColor::Yellow);
+	DrawRow(TEXT("Phase"), TEXT("ms"), TEXT("max ms"), TEXT("flush ms"));
+	Canvas->SetDrawColor(FColor::White);
+	for (int32 PhaseIndex = 0; PhaseIndex < int32(EMassProcessingPhase::MAX); ++PhaseIndex)
+	{
+		const FPhaseStats& Stats = Display.Phases[PhaseIndex];
+		DrawRow(UEnum::GetDisplayValueAsText(EMassProcessingPhase(PhaseIndex)).ToString(), FString::Printf(TEXT("%.2f"), Stats.TotalMs)
+			, FString::Printf(TEXT("%.2f"), Stats.MaxMs), FString::Printf(TEXT("%.3f"), Stats.FlushMs));
+	}
+	Y += LineHeight * 0.5f;
+
+	Canvas->SetDrawColor(FColor::Yellow);
+	DrawRow(FString::Printf(TEXT("Top %d of %d processors"), Display.TopProcessors.Num(), Display.ActiveProcessorCount), TEXT("ms"), TEXT("runs"), TEXT("entities"));
+	Canvas->SetDrawColor(FColor::White);
+	for (const FProcessorStats& Stats : Display.TopProcessors)
+	{
+		DrawRow(Stats.NodeName.ToString(), FString::Printf(TEXT("%.3f"), Stats.TotalMs), FString::Printf(TEXT("%.1f"), double(Stats.ExecutionCount) / Display.FrameCount)
+			, FString::Printf(TEXT("%lld"), Stats.EntityCount));
+	}
+}
@@ -0,0 +1,102 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+#include "MassHelper/Public/Profiling/MassProcessorProfiler.h"
+
+int32 FMassProcessorExecutionRecord::GetMatchedEntityCount() const
+{
+	int32 EntityCount = 0;
+	for (const TPair<const FMassArchetypeData*, int32>& MatchedArchetype : MatchedArchetypes)
+	{
+		EntityCount += MatchedArchetype.Value;
+	}
+	return EntityCount;
+}
+
+FMassProcessorProfiler& FMassProcessorProfiler::Get()
+{
+	static FMassProcessorProfiler Instance;
+	return Instance;
+}
+
+void FMassProcessorProfiler::AddListener(const TSharedRef<IMassProcessorProfilerListener>& Listener)
+{
+	FRWScopeLock ScopeLock(ListenersLock, SLT_Write);
+	Listeners.AddUnique(Listener);
+	bActive.store(Listeners.Num() > 0, std::memory_order_relaxed);
+}
+
+void FMassProcessorProfiler::RemoveListener(const TSharedRef<IMassProcessorProfilerListener>& Listener)
+{
+	FRWScopeLock ScopeLock(ListenersLock, SLT_Write);
+	Listeners.Remove(Listener);
+	bActive.store(Listeners.Num() > 0, std::memory_order_relaxed);
+}
+
+void FMassProcessorProfiler::GetListenersSnapshot(FListenerArray& OutListeners) const
+{
+	// listeners are allowed to unregister themselves from within a callback, so we never call them with the lock held
+	FRWScopeLock ScopeLock(ListenersLock, SLT_ReadOnly);
+	OutListeners = Listeners;
+}
+
+void FMassProcessorProfiler::BroadcastPhaseBegin(const EMassProcessingPhase Phase)
+{
+	const uint64 Cycles = FPlatformTime::Cycles64();
+	FListenerArray Snapshot;
+	GetListenersSnapshot(Snapshot);
+	for (const TSharedRef<IMassProcessorProfilerListener>& Listener : Snapshot)
+	{
+		Listener->OnPhaseBegin(Phase, Cycles);
+	}
+}
+
+void FMassProcessorProfiler::BroadcastPhaseEnd(const EMassProcessingPhase Phase)
+{
+	const uint64 Cycles = FPlatformTime::Cycles64();
+	FListenerArray Snapshot;
+	GetListenersSnapshot(Snapshot);
+	for (const TSharedRef<IMassProcessorProfilerListener>& Listener : Snapshot)
+	{
+		Listener->OnPhaseEnd(Phase, Cycles);
+	}
+}
+
+void FMassProcessorProfiler::BroadcastProcessorExecuted(const FMassProcessorExecutionRecord& Record)
+{
+	FListenerArray Snapshot;
+	GetListenersSnapshot(Snapshot);
+	for (const TSharedRef<IMassProcessorProfilerListener>& Listener : Snapshot)
+	{
+		Listener->OnProcessorExecuted(Record);
+	}
+}
+
+void FMassProcessorProfiler::BroadcastCommandsFlushed(const EMassProcessingPhase Phase, const uint64 BeginCycles, const uint64 EndCycles)
+{
+	const uint32 ThreadId = FPlatformTLS::GetCurrentThreadId();
+	FListenerArray Snapshot;
+	GetListenersSnapshot(Snapshot);
+	for (const TSharedRef<IMassProcessorProfilerListener>& Listener : Snapshot)
+	{
+		Listener->OnCommandsFlushed(Phase, ThreadId, BeginCycles, EndCycles);
+	}
+}
+
+void FMassProcessorProfiler::BroadcastProcessorCommandsIssued(const FMassProcessorCommandsRecord& Record)
+{
+	FListenerArray Snapshot;
+	GetListenersSnapshot(Snapshot);
+	for (const TSharedRef<IMassProcessorProfilerListener>& Listener : Snapshot)
+	{
+		Listener->OnProcessorCommandsIssued(Record);
+	}
+}
+
+void FMassProcessorProfiler::BroadcastPhaseTransitions(const FMassPhaseTransitionsRecord& Record)
+{
+	FListenerArray Snapshot;
+	GetListenersSnapshot(Snapshot);
+	for (const TSharedRef<IMassProcessorProfilerListener>& Listener : Snapshot)
+	{
+		Listener->OnPhaseTransitions(Record);
+	}
+}
@@ -0,0 +1,176 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+#include "MassHelper/Public/Profiling/MassProcessorTimingCapture.h"
+#include "MassHelper/Public/Processor/MassProcessorDependencyPrinter.h"
+
+#include "Async/Async.h"
+#include "HAL/ThreadManager.h"
+
+FMassProcessorTimingCapture::FMassProcessorTimingCapture(const EMassProcessingPhase InPhase, const int32 InFrameCount)
+	: Phase(InPhase)
+	, FrameCount(FMath::Max(1, InFrameCount))
+{
+}
+
+void FMassProcessorTimingCapture::Start()
+{
+	FMassProcessorProfiler::Get().AddListener(AsShared());
+}
+
+void FMassProcessorTimingCapture::Stop()
+{
+	FMassProcessorProfiler::Get().RemoveListener(AsShared());
+}
+
+void FMassProcessorTimingCapture::OnPhaseBegin(const EMassProcessingPhase InPhase, const uint64 Cycles)
+{
+	if (InPhase != Phase)
+	{
+		return;
+	}
+	FScopeLock Lock(&SamplesCS);
+	if (bCompleted == false)
+	{
+		bInPhase = true;
+		PhaseBeginCycles = Cycles;
+	}
+}
+
+void FMassProcessorTimingCapture::OnPhaseEnd(const EMassProcessingPhase InPhase, const uint64 Cycles)
+{
+	if (InPhase != Phase)
+	{
+		return;
+	}
+
+	{
+		FScopeLock Lock(&SamplesCS);
+		if (bInPhase == false || bCompleted)
+		{
+			return;
+		}
+		bInPhase = false;
+		PhaseSamplesMs.Add(FPlatformTime::ToMilliseconds64(Cycles - PhaseBeginCycles));
+		bCompleted = (++CapturedFrames >= FrameCount);
+		if (bCompleted == false)
+		{
+			return;
+		}
+	}
+
+	// the phase end can be reported from a worker thread, while everyone interested in the results expects the game thread
+	AsyncTask(ENamedThreads::GameThread, [WeakThis = AsWeak()]()
+		{
+			if (TSharedPtr<FMassProcessorTimingCapture> This = WeakThis.Pin())
+			{
+				This->Stop();
+				if (This->OnCompleted)
+				{
+					This->OnCompleted(*This);
+				}
+			}
+		});
+}
+
+void FMassProcessorTimingCapture::OnProcessorExecuted(const FMassProcessorExecutionRecord& Record)
+{
+	if (Record.Phase != Phase)
+	{
+		return;
+	}
+	FScopeLock Lock(&SamplesCS);
+	if (bInPhase)
+	{
+		Samples.FindOrAdd(Record.NodeName).Add({ Record.GetDurationMs(), Record.ThreadId });
+	}
+}
+
+void FMassProcessorTimingCapture::ComputeStats(TMap<FName, FProcessorStats>& OutStats) const
+{
+	FScopeLock Lock(&SamplesCS);
+	OutStats.Reset();
+	TArray<double> SortedMs;
+	for (const TPair<FName, TArray<FSample>>& It : Samples)
+	{
+		if (It.Value.Num() == 0)
+		{
+			continue;
+		}
+
+		FProcessorStats& Stats = OutStats.Add(It.Key);
+		SortedMs.Reset(It.Value.Num());
+		double TotalMs = 0.;
+		for (const FSample& Sample : It.Value)
+		{
+			SortedMs.Add(Sample.DurationMs);
+			TotalMs += Sample.DurationMs;
+			const FString ThreadName = FThreadManager::GetThreadName(Sample.ThreadId);
+			Stats.Threads.FindOrAdd(ThreadName.IsEmpty() ? FString::Printf(TEXT("Thread %u"), Sample.ThreadId) : ThreadName)++;
+		}
+		SortedMs.Sort();
+
+		Stats.SampleCount = SortedMs.Num();
+		Stats.MinMs = SortedMs[0];
+		Stats.MaxMs = SortedMs.Last();
+		Stats.AvgMs = TotalMs / SortedMs.Num();
+		Stats.P95Ms = SortedMs[FMath::Clamp(FMath::CeilToInt32(0.95 * SortedMs.Num()) - 1, 0, SortedMs.Num() - 1)];
+	}
+}
+
+double FMassProcessorTimingCapture::GetAveragePhaseMs() const
+{
+	FScopeLock Lock(&SamplesCS);
+	double TotalMs = 0.;
+	for (const double Ms : PhaseSamplesMs)
+	{
+		TotalMs += Ms;
+	}
+	return PhaseSamplesMs.Num() ? TotalMs / PhaseSamplesMs.Num() : 0.;
+}
+
+void FMassProcessorTimingCapture::GetPhaseSamples(TArray<double>& OutSamplesMs) const
+{
+	FScopeLock Lock(&SamplesCS);
+	OutSamplesMs = PhaseSamplesMs;
+}
+
+void FMassProcessorTimingCapture::ExportAnnotations(FMassPrintAnnotations& OutAnnotations) const
+{
+	TSharedRef<TMap<FName, FProcessorStats>> AllStats = MakeShared<TMap<FName, FProcessorStats>>();
+	ComputeStats(*AllStats);
+
+	OutAnnotations.AddNodeWriter([AllStats](FMassDependencyJsonWriter& Writer, const FName NodeName)
+		{
+			const FProcessorStats* Stats = AllStats->Find(NodeName);
+			if (Stats == nullptr)
+			{
+				return;
+			}
+			Writer.WriteKey(TEXT("Timing"));
+			Writer.BeginObject();
+			Writer.WriteNumberField(TEXT("Samples"), Stats->SampleCount);
+			Writer.WriteNumberField(TEXT("MinMs"), Stats->MinMs);
+			Writer.WriteNumberField(TEXT("AvgMs"), Stats->AvgMs);
+			Writer.WriteNumberField(TEXT("P95Ms"), Stats->P95Ms);
+			Writer.WriteNumberField(TEXT("MaxMs"), Stats->MaxMs);
+			Writer.WriteKey(TEXT("Threads"));
+			Writer.BeginArray();
+			for (const TPair<FString, int32>& Thread : Stats->Threads)
+			{
+				Writer.BeginObject();
+				Writer.WriteStringField(TEXT("Name"), Thread.Key);
+				Writer.WriteNumberField(TEXT("Count"), Thread.Value);
+				Writer.EndObject();
+			}
+			Writer.EndArray();
+			Writer.EndObject();
+		});
+
+	OutAnnotations.AddRootWriter([Frames = CapturedFrames, AvgMs = GetAveragePhaseMs()](FMassDependencyJsonWriter& Writer)
+		{
+			Writer.WriteKey(TEXT("PhaseTiming"));
+			Writer.BeginObject();
+			Writer.WriteNumberField(TEXT("Frames"), Frames);
+			Writer.WriteNumberField(TEXT("AvgMs"), AvgMs);
+			Writer.EndObject();
+		});
+}
@@ -0,0 +1,212 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+#include "MassHelper/Public/Profiling/MassProcessorTraceCapture.h"
+#include "MassHelper/Public/Processor/MassDependencyJsonWriter.h"
+
+#include "Async/Async.h"
+#include "HAL/ThreadManager.h"
+
+namespace UE::MassHelper::Private
+{
+	/** Thread id of the artificial track the phase boundaries are drawn on. */
+	constexpr uint32 PhaseTrackThreadId = 0;
+}
+
+FMassProcessorTraceCapture::FMassProcessorTraceCapture(const int32 InFrameCount)
+	: FrameCount(FMath::Max(0, InFrameCount))
+{
+}
+
+void FMassProcessorTraceCapture::Start()
+{
+	{
+		FScopeLock Lock(&EventsCS);
+		StartFrame = GFrameCounter;
+		StartCycles = FPlatformTime::Cycles64();
+	}
+	FMassProcessorProfiler::Get().AddListener(AsShared());
+}
+
+void FMassProcessorTraceCapture::Stop()
+{
+	FMassProcessorProfiler::Get().RemoveListener(AsShared());
+	FScopeLock Lock(&EventsCS);
+	bCompleted = true;
+}
+
+int32 FMassProcessorTraceCapture::GetEventCount() const
+{
+	FScopeLock Lock(&EventsCS);
+	return Events.Num();
+}
+
+void FMassProcessorTraceCapture::AddEvent(FTraceEvent&& Event)
+{
+	FScopeLock Lock(&EventsCS);
+	if (bCompleted == false)
+	{
+		Events.Add(MoveTemp(Event));
+	}
+}
+
+void FMassProcessorTraceCapture::OnPhaseBegin(const EMassProcessingPhase Phase, const uint64 Cycles)
+{
+	{
+		FScopeLock Lock(&EventsCS);
+		if (bCompleted)
+		{
+			return;
+		}
+		if (FrameCount == 0 || GFrameCounter < StartFrame + FrameCount)
+		{
+			PhaseBeginCycles[int(Phase)] = Cycles;
+			return;
+		}
+		bCompleted = true;
+	}
+
+	// phases can begin on any thread, the capture is handed over on the game thread
+	AsyncTask(ENamedThreads::GameThread, [WeakThis = AsWeak()]()
+		{
+			if (TSharedPtr<FMassProcessorTraceCapture> This = WeakThis.Pin())
+			{
+				This->Stop();
+				if (This->OnCompleted)
+				{
+					This->OnCompleted(*This);
+				}
+			}
+		});
+}
+
+void FMassProcessorTraceCapture::OnPhaseEnd(const EMassProcessingPhase Phase, const uint64 Cycles)
+{
+	uint64 BeginCycles = 0;
+	{
+		FScopeLock Lock(&EventsCS);
+		BeginCycles = PhaseBeginCycles[int(Phase)];
+		PhaseBeginCycles[int(Phase)] = 0;
+	}
+	if (BeginCycles == 0)
+	{
+		return;
+	}
+
+	// named on write, phase ends are reported off the game thread
+	FTraceEvent Event;
+	Event.Kind = EEventKind::Phase;
+	Event.Phase = Phase;
+	Event.ThreadId = UE::MassHelper::Private::PhaseTrackThreadId;
+	Event.BeginCycles = BeginCycles;
+	Event.EndCycles = Cycles;
+	Event.Frame = GFrameCounter;
+	AddEvent(MoveTemp(Event));
+}
+
+void FMassProcessorTraceCapture::OnProcessorExecuted(const FMassProcessorExecutionRecord& Record)
+{
+	FTraceEvent Event;
+	Event.Name = Record.NodeName;
+	Event.Kind = EEventKind::Processor;
+	Event.Phase = Record.Phase;
+	Event.ThreadId = Record.ThreadId;
+	Event.BeginCycles = Record.BeginCycles;
+	Event.EndCycles = Record.EndCycles;
+	Event.Frame = GFrameCounter;
+	AddEvent(MoveTemp(Event));
+}
+
+void FMassProcessorTraceCapture::OnCommandsFlushed(const EMassProcessingPhase Phase, const uint32 ThreadId, const uint64 BeginCycles, const uint64 EndCycles)
+{
+	FTraceEvent Event;
+	Event.Name = TEXT("FlushCommands");
+	Event.Kind = EEventKind::CommandFlush;
+	Event.Phase = Phase;
+	Event.ThreadId = ThreadId;
+	Event.BeginCycles = BeginCycles;
+	Event.EndCycles = EndCycles;
+	Event.Frame = GFrameCounter;
+	AddEvent(MoveTemp(Event));
+}
+
+void FMassProcessorTraceCapture::Write(FArchive& OutArchive) const
+{
+	FScopeLock Lock(&EventsCS);
+
+	auto ToMicroseconds = [this](const uint64 Cycles)
+	{
+		return Cycles > StartCycles ? FPlatformTime::ToMilliseconds64(Cycles - StartCycles) * 1000. : 0.;
+	};
+
+	FMassDependencyJsonWriter Writer(OutArchive);
+	Writer.BeginObject();
+	Writer.WriteStringField(TEXT("displayTimeUnit"), TEXT("ms"));
+	Writer.WriteKey(TEXT("traceEvents"));
+	Writer.BeginArray();
+
+	TArray<FString> PhaseNames;
+	for (int32 PhaseIndex = 0; PhaseIndex <= int32(EMassProcessingPhase::MAX); ++PhaseIndex)
+	{
+		PhaseNames.Add(UEnum::GetDisplayValueAsText(EMassProcessingPhase(PhaseIndex)).ToString());
+	}
+
+	// metadata events name the tracks
+	TSet<uint32> ThreadIds;
+	for (const FTraceEvent& Event : Events)
+	{
+		ThreadIds.Add(Event.ThreadId);
+	}
+	for (const uint32 ThreadId : ThreadIds)
+	{
+		const bool bPhaseTrack = ThreadId == UE::MassHelper::Private::PhaseTrackThreadId;
+		const FString ThreadName = bPhaseTrack ? FString(TEXT("Mass Phases")) : FThreadManager::GetThreadName(ThreadId);
+		Writer.BeginObject();
+		Writer.WriteStringField(TEXT("name"), TEXT("thread_name"));
+		Writer.WriteStringField(TEXT("ph"), TEXT("M"));
+		Writer.WriteNumberField(TEXT("pid"), 1);
+		Writer.WriteNumberField(TEXT("tid"), ThreadId);
+		Writer.WriteKey(TEXT("args"));
+		Writer.BeginObject();
+		Writer.WriteStringField(TEXT("name"), ThreadName.IsEmpty() ? FString::Printf(TEXT("Thread %u"), ThreadId) : ThreadName);
+		Writer.EndObject();
+		Writer.EndObject();
+
+		Writer.BeginObject();
+		Writer.WriteStringField(TEXT("name"), TEXT("thread_sort_index"));
+		Writer.WriteStringField(TEXT("ph"), TEXT("M"));
+		Writer.WriteNumberField(TEXT("pid"), 1);
+		Writer.WriteNumberField(TEXT("tid"), ThreadId);
+		Writer.WriteKey(TEXT("args"));
+		Writer.BeginObject();
+		Writer.WriteNumberField(TEXT("sort_index"), bPhaseTrack ? -1 : (ThreadId == GGameThreadId ? 0 : 1));
+		Writer.EndObject();
+		Writer.EndObject();
+	}
+
+	for (const FTraceEvent& Event : Events)
+	{
+		Writer.BeginObject();
+		if (Event.Kind == EEventKind::Phase)
+		{
+			Writer.WriteStringField(TEXT("name"), PhaseNames[int32(Event.Phase)]);
+		}
+		else
+		{
+			Writer.WriteNameField(TEXT("name"), Event.Name);
+		}
+		Writer.WriteStringField(TEXT("cat"), Event.Kind == EEventKind::Phase ? TEXT("Phase") : Event.Kind == EEventKind::Processor ? TEXT("Processor") : TEXT("CommandFlush"));
+		Writer.WriteStringField(TEXT("ph"), TEXT("X"));
+		Writer.WriteNumberField(TEXT("pid"), 1);
+		Writer.WriteNumberField(TEXT("tid"), Event.ThreadId);
+		Writer.WriteNumberField(TEXT("ts"), ToMicroseconds(Event.BeginCycles));
+		Writer.WriteNumberField(TEXT("dur"), FPlatformTime::ToMilliseconds64(Event.EndCycles - Event.BeginCycles) * 1000.);
+		Writer.WriteKey(TEXT("args"));
+		Writer.BeginObject();
+		Writer.WriteStringField(TEXT("Phase"), PhaseNames[int32(Event.Phase)]);
+		Writer.WriteNumberField(TEXT("Frame"), double(Event.Frame - StartFrame));
+		Writer.EndObject();
+		Writer.EndObject();
+	}
+
+	Writer.EndArray();
+	Writer.EndObject();
+}
@@ -0,0 +1,315 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+#include "MassHelper/Public/Profiling/MassSignalCapture.h"
+#include "MassHelper/Public/Processor/MassDependencyJsonWriter.h"
+#include "MassHelper/Private/Analysis/MassPrivateMemberAccess.h"
+
+#include "MassSignals/Public/MassSignalSubsystem.h"
+#include "MassSignals/Public/MassSignalProcessorBase.h"
+
+#include "Misc/App.h"
+#include "Misc/CoreDelegates.h"
+
+namespace UE::MassHelper::Private
+{
+	// the delayed signals' element type is a protected nested type, so both subsystem members deduce their type
+	struct FNamedSignalsTag
+	{
+		friend auto GetPrivateMember(FNamedSignalsTag);
+	};
+	template struct TMassPrivateMemberAutoAccessor<FNamedSignalsTag, &UMassSignalSubsystem::NamedSignals>;
+
+	struct FDelayedSignalsTag
+	{
+		friend auto GetPrivateMember(FDelayedSignalsTag);
+	};
+	template struct TMassPrivateMemberAutoAccessor<FDelayedSignalsTag, &UMassSignalSubsystem::DelayedSignals>;
+
+	struct FRegisteredSignalsTag
+	{
+		using Type = TArray<FName> UMassSignalProcessorBase::*;
+		friend Type GetPrivateMember(FRegisteredSignalsTag);
+	};
+	template struct TMassPrivateMemberAccessor<FRegisteredSignalsTag, &UMassSignalProcessorBase::RegisteredSignals>;
+
+	void GetDelayedEntityCounts(const UMassSignalSubsystem& Subsystem, TMap<FName, int32>& OutCounts)
+	{
+		for (const auto& DelayedSignal : Subsystem.*GetPrivateMember(FDelayedSignalsTag()))
+		{
+			OutCounts.FindOrAdd(DelayedSignal.SignalName) += DelayedSignal.Entities.Num();
+		}
+	}
+}
+
+FMassSignalCapture::FMassSignalCapture(UWorld& InWorld, const int32 InFrameCount)
+	: World(&InWorld)
+	, FrameCount(FMath::Max(1, InFrameCount))
+{
+}
+
+FMassSignalCapture::~FMassSignalCapture()
+{
+	FCoreDelegates::OnEndFrame.Remove(EndFrameHandle);
+	UnsubscribeAll();
+}
+
+void FMassSignalCapture::Start()
+{
+	check(IsInGameThread());
+	UMassSignalSubsystem* SignalSubsystem = UWorld::GetSubsystem<UMassSignalSubsystem>(World.Get());
+	if (EndFrameHandle.IsValid() || SignalSubsystem == nullptr)
+	{
+		return;
+	}
+
+	SignalSubsystemWeak = SignalSubsystem;
+	SubscribeToNewSignals(*SignalSubsystem);
+	EndFrameHandle = FCoreDelegates::OnEndFrame.AddSP(this, &FMassSignalCapture::OnEndFrame);
+	FMassProcessorProfiler::Get().AddListener(AsShared());
+}
+
+void FMassSignalCapture::Stop()
+{
+	check(IsInGameThread());
+	if (EndFrameHandle.IsValid() == false)
+	{
+		return;
+	}
+	FMassProcessorProfiler::Get().RemoveListener(AsShared());
+	FCoreDelegates::OnEndFrame.Remove(EndFrameHandle);
+	EndFrameHandle.Reset();
+	UnsubscribeAll();
+	bCompleted = true;
+}
+
+void FMassSignalCapture::SubscribeToNewSignals(UMassSignalSubsystem& SignalSubsystem)
+{
+	TArray<FName> SignalNames;
+	(SignalSubsystem.*GetPrivateMember(UE::MassHelper::Private::FNamedSignalsTag())).GetKeys(SignalNames);
+	for (const FName SignalName : SignalNames)
+	{
+		if (SignalHandles.Contains(SignalName) == false)
+		{
+			FPendingSignal* Pending = PendingSignals.Add(SignalName, MakeUnique<FPendingSignal>()).Get();
+			SignalHandles.Add(SignalName, SignalSubsystem.GetSignalDelegateByName(SignalName).AddSP(this, &FMassSignalCapture::OnSignal, Pending));
+		}
+	}
+}
+
+void FMassSignalCapture::UnsubscribeAll()
+{
+	if (UMassSignalSubsystem* SignalSubsystem = SignalSubsystemWeak.Get())
+	{
+		for (const TPair<FName, FDelegateHandle>& It : SignalHandles)
+		{
+			SignalSubsystem->GetSignalDelegateByName(It.Key).Remove(It.Value);
+		}
+	}
+	SignalHandles.Reset();
+	PendingSignals.Reset();
+}
+
+void FMassSignalCapture::OnSignal(FName SignalName, TConstArrayView<FMassEntityHandle> Entities, FPendingSignal* Pending)
+{
+	Pending->RaisedCount.fetch_add(1, std::memory_order_relaxed);
+	Pending->EntityCount.fetch_add(Entities.Num(), std::memory_order_relaxed);
+}
+
+void FMassSignalCapture::OnProcessorExecuted(const FMassProcessorExecutionRecord& Record)
+{
+	const UMassSignalProcessorBase* SignalProcessor = Cast<const UMassSignalProcessorBase>(Record.Processor);
+	if (SignalProcessor == nullptr)
+	{
+		return;
+	}
+	FScopeLock Lock(&PendingCS);
+	PendingSignalProcessorsMs.FindOrAdd(Record.NodeName) += Record.GetDurationMs();
+	if (ProcessorSignals.Contains(Record.NodeName) == false)
+	{
+		ProcessorSignals.Add(Record.NodeName, SignalProcessor->*GetPrivateMember(UE::MassHelper::Private::FRegisteredSignalsTag()));
+	}
+}
+
+void FMassSignalCapture::OnEndFrame()
+{
+	UMassSignalSubsystem* SignalSubsystem = SignalSubsystemWeak.Get();
+	if (SignalSubsystem == nullptr)
+	{
+		Stop();
+		return;
+	}
+
+	FFrameSample& Sample = Frames.AddDefaulted_GetRef();
+	Sample.Frame = GFrameCounter;
+	Sample.FrameMs = FApp::GetDeltaTime() * 1000.;
+	for (const TPair<FName, TUniquePtr<FPendingSignal>>& It : PendingSignals)
+	{
+		const int32 RaisedCount = It.Value->RaisedCount.exchange(0, std::memory_order_relaxed);
+		const int32 EntityCount = It.Value->EntityCount.exchange(0, std::memory_order_relaxed);
+		if (RaisedCount > 0)
+		{
+			FSignalSample& SignalSample = Sample.Signals.Add(It.Key);
+			SignalSample.RaisedCount = RaisedCount;
+			SignalSample.EntityCount = EntityCount;
+		}
+	}
+	{
+		FScopeLock Lock(&PendingCS);
+		Sample.SignalProcessorsMs = MoveTemp(PendingSignalProcessorsMs);
+		PendingSignalProcessorsMs.Reset();
+		for (const TPair<FName, double>& It : Sample.SignalProcessorsMs)
+		{
+			Sample.SignalProcessorMs += It.Value;
+			for (const FName SignalName : ProcessorSignals.FindChecked(It.Key))
+			{
+				Sample.Signals.FindOrAdd(SignalName).ProcessorMs += It.Value;
+			}
+		}
+	}
+
+	TMap<FName, int32> DelayedEntityCounts;
+	UE::MassHelper::Private::GetDelayedEntityCounts(*SignalSubsystem, DelayedEntityCounts);
+	for (const TPair<FName, int32>& It : DelayedEntityCounts)
+	{
+		Sample.Signals.FindOrAdd(It.Key).DelayedEntityCount = It.Value;
+	}
+
+	if (Frames.Num() >= FrameCount)
+	{
+		Stop();
+		if (OnCompleted)
+		{
+			OnCompleted(*this);
+		}
+		return;
+	}
+
+	// processors subscribe to their signals when they get initialized, which can happen at any point
+	SubscribeToNewSignals(*SignalSubsystem);
+}
+
+void FMassSignalCapture::Write(FArchive& OutArchive) const
+{
+	struct FSignalTotals
+	{
+		int64 RaisedCount = 0;
+		int64 EntityCount = 0;
+		int32 MaxEntityCount = 0;
+		int32 MaxDelayedEntityCount = 0;
+		double ProcessorMs = 0.;
+	};
+	struct FProcessorTotals
+	{
+		double Ms = 0.;
+		double MaxMs = 0.;
+		int32 ExecutedFrames = 0;
+	};
+
+	TMap<FName, FSignalTotals> SignalTotals;
+	TMap<FName, FProcessorTotals> ProcessorTotals;
+	for (const FFrameSample& Sample : Frames)
+	{
+		for (const TPair<FName, FSignalSample>& It : Sample.Signals)
+		{
+			FSignalTotals& Totals = SignalTotals.FindOrAdd(It.Key);
+			Totals.RaisedCount += It.Value.RaisedCount;
+			Totals.EntityCount += It.Value.EntityCount;
+			Totals.MaxEntityCount = FMath::Max(Totals.MaxEntityCount, It.Value.EntityCount);
+			Totals.MaxDelayedEntityCount = FMath::Max(Totals.MaxDelayedEntityCount, It.Value.DelayedEntityCount);
+			Totals.ProcessorMs += It.Value.ProcessorMs;
+		}
+		for (const TPair<FName, double>& It : Sample.SignalProcessorsMs)
+		{
+			FProcessorTotals& Totals = ProcessorTotals.FindOrAdd(It.Key);
+			Totals.Ms += It.Value;
+			Totals.MaxMs = FMath::Max(Totals.MaxMs, It.Value);
+			++Totals.ExecutedFrames;
+		}
+	}
+	SignalTotals.ValueSort([](const FSignalTotals& A, const FSignalTotals& B) { return A.EntityCount > B.EntityCount; });
+	ProcessorTotals.ValueSort([](const FProcessorTotals& A, const FProcessorTotals& B) { return A.MaxMs > B.MaxMs; });
+	const double FrameScale = 1. / FMath::Max(1, Frames.Num());
+
+	FMassDependencyJsonWriter Writer(OutArchive);
+	Writer.BeginObject();
+	Writer.WriteStringField(TEXT("PrintMode"), TEXT("Signals"));
+	Writer.WriteNumberField(TEXT("FrameCount"), Frames.Num());
+
+	Writer.WriteKey(TEXT("Signals"));
+	Writer.BeginArray();
+	for (const TPair<FName, FSignalTotals>& It : SignalTotals)
+	{
+		Writer.BeginObject();
+		Writer.WriteNameField(TEXT("Name"), It.Key);
+		Writer.WriteNumberField(TEXT("RaisedPerFrame"), It.Value.RaisedCount * FrameScale);
+		Writer.WriteNumberField(TEXT("EntitiesPerFrame"), It.Value.EntityCount * FrameScale);
+		Writer.WriteNumberField(TEXT("MaxEntities"), It.Value.MaxEntityCount);
+		Writer.WriteNumberField(TEXT("MaxDelayedEntities"), It.Value.MaxDelayedEntityCount);
+		Writer.WriteNumberField(TEXT("ProcessorMsPerFrame"), It.Value.ProcessorMs * FrameScale);
+		Writer.EndObject();
+	}
+	Writer.EndArray();
+
+	Writer.WriteKey(TEXT("SignalProcessors"));
+	Writer.BeginArray();
+	for (const TPair<FName, FProcessorTotals>& It : ProcessorTotals)
+	{
+		Writer.BeginObject();
+		Writer.WriteNameField(TEXT("Name"), It.Key);
+		Writer.WriteNumberField(TEXT("MsPerFrame"), It.Value.Ms * FrameScale);
+		Writer.WriteNumberField(TEXT("MaxMs"), It.Value.MaxMs);
+		Writer.WriteNumberField(TEXT("ExecutedFrames"), It.Value.ExecutedFrames);
+		if (const TArray<FName>* SubscribedSignals = ProcessorSignals.Find(It.Key))
+		{
+			Writer.WriteKey(TEXT("Signals"));
+			Writer.BeginArray();
+			for (const FName SignalName : *SubscribedSignals)
+			{
+				Writer.WriteName(SignalName);
+			}
+			Writer.EndArray();
+		}
+		Writer.EndObject();
+	}
+	Writer.EndArray();
+
+	Writer.WriteKey(TEXT("Frames"));
+	Writer.BeginArray();
+	for (const FFrameSample& Sample : Frames)
+	{
+		Writer.BeginObject();
+		Writer.WriteNumberField(TEXT("Frame"), double(Sample.Frame));
+		Writer.WriteNumberField(TEXT("FrameMs"), Sample.FrameMs);
+		Writer.WriteNumberField(TEXT("SignalProcessorMs"), Sample.SignalProcessorMs);
+		Writer.WriteKey(TEXT("Signals"));
+		Writer.BeginArray();
+		for (const TPair<FName, FSignalSample>& It : Sample.Signals)
+		{
+			if (It.Value.RaisedCount == 0 && It.Value.DelayedEntityCount == 0 && It.Value.ProcessorMs == 0.)
+			{
+				continue;
+			}
+			Writer.BeginObject();
+			Writer.WriteNameField(TEXT("Name"), It.Key);
+			Writer.WriteNumberField(TEXT("Raised"), It.Value.RaisedCount);
+			Writer.WriteNumberField(TEXT("Entities"), It.Value.EntityCount);
+			Writer.WriteNumberField(TEXT("DelayedEntities"), It.Value.DelayedEntityCount);
+			Writer.WriteNumberField(TEXT("ProcessorMs"), It.Value.ProcessorMs);
+			Writer.EndObject();
+		}
+		Writer.EndArray();
+		Writer.WriteKey(TEXT("Processors"));
+		Writer.BeginArray();
+		for (const TPair<FName, double>& It : Sample.SignalProcessorsMs)
+		{
+			Writer.BeginObject();
+			Writer.WriteNameField(TEXT("Name"), It.Key);
+			Writer.WriteNumberField(TEXT("Ms"), It.Value);
+			Writer.EndObject();
+		}
+		Writer.EndArray();
+		Writer.EndObject();
+	}
+	Writer.EndArray();
+
+	Writer.EndObject();
+}
@@ -0,0 +1,415 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+#include "MassHelper/Public/Profiling/MassTelemetryRing.h"
+#include "MassHelper/Public/Analysis/MassArchetypeMemoryReport.h"
+
+#include "MassEntity/Public/MassArchetypeData.h"
+#include "MassEntity/Public/MassEntitySubsystem.h"
+
+#include "HAL/PlatformFileManager.h"
+#include "Misc/App.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace UE::MassHelper::Private
+{
+	/** Fixed part of the ring file header, padded to FMassTelemetryRingWriter::HeaderSize. */
+	struct FTelemetryRingHeader
+	{
+		uint32 Magic = 0;
+		uint32 Version = 0;
+		int32 SlotSize = 0;
+		int32 SlotCount = 0;
+		int32 NameTableSize = 0;
+		int32 NameTableUsed = 0;
+		int32 NameCount = 0;
+		uint64 LatestSequence = 0;
+
+		void Serialize(FArchive& Ar)
+		{
+			Ar << Magic << Version << SlotSize << SlotCount << NameTableSize << NameTableUsed << NameCount << LatestSequence;
+		}
+	};
+
+	struct FTelemetrySlotHeader
+	{
+		uint32 Magic = 0;
+		uint32 PayloadSize = 0;
+		uint64 Sequence = 0;
+		uint32 Crc = 0;
+		uint32 Reserved = 0;
+
+		void Serialize(FArchive& Ar)
+		{
+			Ar << Magic << PayloadSize << Sequence << Crc << Reserved;
+		}
+	};
+
+	template<typename TElement, typename TSerializeElement>
+	void SerializeTelemetryArray(FArchive& Ar, TArray<TElement>& Array, TSerializeElement&& SerializeElement)
+	{
+		uint16 Count = uint16(FMath::Min(Array.Num(), int32(MAX_uint16)));
+		Ar << Count;
+		if (Ar.IsLoading())
+		{
+			Array.SetNum(Count);
+		}
+		for (int32 Index = 0; Index < Count; ++Index)
+		{
+			SerializeElement(Ar, Array[Index]);
+		}
+	}
+
+	FString MakeArchetypeName(const FMassArchetypeData& ArchetypeData)
+	{
+		const FMassArchetypeCompositionDescriptor& Composition = ArchetypeData.GetCompositionDescriptor();
+		TArray<const UStruct*> Types;
+		Composition.Fragments.ExportTypes(Types);
+		Composition.Tags.ExportTypes(Types);
+		FString Name = FString::Printf(TEXT("%08X"), Composition.CalculateHash());
+		for (int32 Index = 0; Index < Types.Num(); ++Index)
+		{
+			Name += Index == 0 ? TEXT(" ") : TEXT(",");
+			Name += Types[Index] ? Types[Index]->GetName() : TEXT("None");
+		}
+		return Name;
+	}
+}
+
+void FMassTelemetryFrame::Serialize(FArchive& Ar)
+{
+	using namespace UE::MassHelper::Private;
+
+	uint8 Flags = bTruncated ? 1 : 0;
+	Ar << Sequence << EngineFrame << TimeSeconds << FrameMs << EntityCount << Flags;
+	bTruncated = (Flags & 1) != 0;
+	SerializeTelemetryArray(Ar, Phases, [](FArchive& InAr, FPhase& Phase) { InAr << Phase.Phase << Phase.Ms << Phase.FlushMs << Phase.FlushCount; });
+	SerializeTelemetryArray(Ar, Processors, [](FArchive& InAr, FProcessor& Processor) { InAr << Processor.NameId << Processor.Phase << Processor.Ms; });
+	SerializeTelemetryArray(Ar, Archetypes, [](FArchive& InAr, FArchetype& Archetype) { InAr << Archetype.NameId << Archetype.EntityCount; });
+}
+
+FMassTelemetryRingWriter::FMassTelemetryRingWriter(UWorld& InWorld, const FString& InFilePath, const int64 InFileSizeBytes, const int32 InSlotSizeBytes
+	, const int32 InNameTableSizeBytes)
+	: World(&InWorld)
+	, FilePath(InFilePath)
+	, SlotSize(FMath::Max(InSlotSizeBytes, 1024))
+	, NameTableSize(FMath::Max(InNameTableSizeBytes, 4096))
+{
+	SlotCount = int32(FMath::Clamp<int64>((InFileSizeBytes - HeaderSize - NameTableSize) / SlotSize, 1, MAX_int32));
+}
+
+FMassTelemetryRingWriter::~FMassTelemetryRingWriter()
+{
+	FCoreDelegates::OnEndFrame.Remove(EndFrameHandle);
+}
+
+FString FMassTelemetryRingWriter::GetDefaultFilePath()
+{
+	return FPaths::ProjectSavedDir() / TEXT("MassTelemetry") / TEXT("MassTelemetry.ring");
+}
+
+bool FMassTelemetryRingWriter::Start()
+{
+	check(IsInGameThread());
+	if (IsRunning())
+	{
+		return true;
+	}
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	PlatformFile.CreateDirectoryTree(*FPaths::GetPath(FilePath));
+	// readable while we write, the query commandlet can look at a running session
+	FileHandle.Reset(PlatformFile.OpenWrite(*FilePath, /*bAppend=*/false, /*bAllowRead=*/true));
+	if (FileHandle.IsValid() == false)
+	{
+		UE_LOG(LogMass, Error, TEXT("%s could not open %s"), ANSI_TO_TCHAR(__FUNCTION__), *FilePath);
+		return false;
+	}
+
+	NextSequence = 1;
+	NameIds.Reset();
+	ArchetypeNameIds.Reset();
+	NameTableUsed = 0;
+	WriteHeader();
+
+	EndFrameHandle = FCoreDelegates::OnEndFrame.AddSP(this, &FMassTelemetryRingWriter::OnEndFrame);
+	FMassProcessorProfiler::Get().AddListener(AsShared());
+	return true;
+}
+
+void FMassTelemetryRingWriter::Stop()
+{
+	check(IsInGameThread());
+	if (IsRunning() == false)
+	{
+		return;
+	}
+	FMassProcessorProfiler::Get().RemoveListener(AsShared());
+	FCoreDelegates::OnEndFrame.Remove(EndFrameHandle);
+	EndFrameHandle.Reset();
+	WriteHeader();
+	FileHandle->Flush();
+	FileHandle.Reset();
+}
+
+void FMassTelemetryRingWriter::OnPhaseBegin(const EMassProcessingPhase Phase, const uint64 Cycles)
+{
+	FScopeLock Lock(&PendingCS);
+	PhaseBeginCycles[int(Phase)] = Cycles;
+}
+
+void FMassTelemetryRingWriter::OnPhaseEnd(const EMassProcessingPhase Phase, const uint64 Cycles)
+{
+	FScopeLock Lock(&PendingCS);
+	if (PhaseBeginCycles[int(Phase)] != 0)
+	{
+		PendingPhases[int(Phase)].Ms += float(FPlatformTime::ToMilliseconds64(Cycles - PhaseBeginCycles[int(Phase)]));
+		PhaseBeginCycles[int(Phase)] = 0;
+	}
+}
+
+void FMassTelemetryRingWriter::OnProcessorExecuted(const FMassProcessorExecutionRecord& Record)
+{
+	FScopeLock Lock(&PendingCS);
+	PendingProcessorsMs.FindOrAdd(MakeTuple(Record.NodeName, Record.Phase)) += float(Record.GetDurationMs());
+}
+
+void FMassTelemetryRingWriter::OnCommandsFlushed(const EMassProcessingPhase Phase, const uint32 ThreadId, const uint64 BeginCycles, const uint64 EndCycles)
+{
+	FScopeLock Lock(&PendingCS);
+	PendingPhases[int(Phase)].FlushMs += float(FPlatformTime::ToMilliseconds64(EndCycles - BeginCycles));
+	++PendingPhases[int(Phase)].FlushCount;
+}
+
+uint32 FMassTelemetryRingWriter::GetNameId(const FString& Name)
+{
+	if (const uint32* ExistingId = NameIds.Find(Name))
+	{
+		return *ExistingId;
+	}
+
+	// names are appended to the table once and never overwritten, unlike the frames
+	FTCHARToUTF8 Utf8Name(*Name);
+	uint16 Length = uint16(FMath::Min(Utf8Name.Length(), int32(MAX_uint16)));
+	if (NameTableUsed + int32(sizeof(Length)) + Length > NameTableSize)
+	{
+		return InvalidNameId;
+	}
+
+	FileHandle->Seek(HeaderSize + NameTableUsed);
+	FileHandle->Write(reinterpret_cast<const uint8*>(&Length), sizeof(Length));
+	FileHandle->Write(reinterpret_cast<const uint8*>(Utf8Name.Get()), Length);
+	NameTableUsed += sizeof(Length) + Length;
+
+	const uint32 NameId = uint32(NameIds.Num());
+	NameIds.Add(Name, NameId);
+	return NameId;
+}
+
+void FMassTelemetryRingWriter::WriteHeader()
+{
+	UE::MassHelper::Private::FTelemetryRingHeader Header;
+	Header.Magic = Magic;
+	Header.Version = Version;
+	Header.SlotSize = SlotSize;
+	Header.SlotCount = SlotCount;
+	Header.NameTableSize = NameTableSize;
+	Header.NameTableUsed = NameTableUsed;
+	Header.NameCount = NameIds.Num();
+	Header.LatestSequence = NextSequence - 1;
+
+	TArray<uint8> HeaderBytes;
+	FMemoryWriter HeaderWriter(HeaderBytes);
+	Header.Serialize(HeaderWriter);
+	HeaderBytes.SetNumZeroed(HeaderSize);
+	FileHandle->Seek(0);
+	FileHandle->Write(HeaderBytes.GetData(), HeaderBytes.Num());
+}
+
+void FMassTelemetryRingWriter::OnEndFrame()
+{
+	using namespace UE::MassHelper::Private;
+
+	UMassEntitySubsystem* EntitySubsystem = UWorld::GetSubsystem<UMassEntitySubsystem>(World.Get());
+	if (EntitySubsystem == nullptr)
+	{
+		Stop();
+		return;
+	}
+
+	FMassTelemetryFrame Frame;
+	Frame.Sequence = NextSequence++;
+	Frame.EngineFrame = GFrameCounter;
+	Frame.TimeSeconds = FPlatformTime::Seconds();
+	Frame.FrameMs = float(FApp::GetDeltaTime() * 1000.);
+
+	TMap<TPair<FName, EMassProcessingPhase>, float> ProcessorsMs;
+	{
+		FScopeLock Lock(&PendingCS);
+		for (int32 PhaseIndex = 0; PhaseIndex < int32(EMassProcessingPhase::MAX); ++PhaseIndex)
+		{
+			if (PendingPhases[PhaseIndex].Ms > 0.f || PendingPhases[PhaseIndex].FlushCount > 0)
+			{
+				FMassTelemetryFrame::FPhase& Phase = Frame.Phases.Add_GetRef(PendingPhases[PhaseIndex]);
+				Phase.Phase = uint8(PhaseIndex);
+			}
+			PendingPhases[PhaseIndex] = FMassTelemetryFrame::FPhase();
+		}
+		ProcessorsMs = MoveTemp(PendingProcessorsMs);
+		PendingProcessorsMs.Reset();
+	}
+
+	for (const TPair<TPair<FName, EMassProcessingPhase>, float>& It : ProcessorsMs)
+	{
+		FMassTelemetryFrame::FProcessor& Processor = Frame.Processors.AddDefaulted_GetRef();
+		Processor.NameId = GetNameId(It.Key.Key.ToString());
+		Processor.Phase = uint8(It.Key.Value);
+		Processor.Ms = It.Value;
+	}
+
+	TArray<TSharedPtr<FMassArchetypeData>> Archetypes;
+	FMassArchetypeMemoryReport::GetArchetypes(EntitySubsystem->GetEntityManager(), Archetypes);
+	for (const TSharedPtr<FMassArchetypeData>& ArchetypeData : Archetypes)
+	{
+		const int32 EntityCount = ArchetypeData->GetNumEntities();
+		Frame.EntityCount += EntityCount;
+		if (EntityCount == 0)
+		{
+			continue;
+		}
+		uint32* NameId = ArchetypeNameIds.Find(ArchetypeData.Get());
+		if (NameId == nullptr)
+		{
+			NameId = &ArchetypeNameIds.Add(ArchetypeData.Get(), GetNameId(MakeArchetypeName(*ArchetypeData)));
+		}
+		Frame.Archetypes.Add({ *NameId, EntityCount });
+	}
+
+	// what gets dropped first when the slot is too small
+	Frame.Processors.Sort([](const FMassTelemetryFrame::FProcessor& A, const FMassTelemetryFrame::FProcessor& B) { return A.Ms > B.Ms; });
+	Frame.Archetypes.Sort([](const FMassTelemetryFrame::FArchetype& A, const FMassTelemetryFrame::FArchetype& B) { return A.EntityCount > B.EntityCount; });
+
+	for (;;)
+	{
+		SlotBytes.Reset();
+		FMemoryWriter SlotWriter(SlotBytes);
+		FTelemetrySlotHeader SlotHeader;
+		SlotHeader.Serialize(SlotWriter);
+		Frame.Serialize(SlotWriter);
+		if (SlotBytes.Num() <= SlotSize || (Frame.Processors.Num() == 0 && Frame.Archetypes.Num() == 0))
+		{
+			break;
+		}
+		Frame.bTruncated = true;
+		Frame.Processors.SetNum(Frame.Processors.Num() * 3 / 4);
+		Frame.Archetypes.SetNum(Frame.Archetypes.Num() * 3 / 4);
+	}
+	if (SlotBytes.Num() > SlotSize)
+	{
+		return;
+	}
+
+	FTelemetrySlotHeader SlotHeader;
+	SlotHeader.Magic = SlotMagic;
+	SlotHeader.PayloadSize = uint32(SlotBytes.Num() - SlotHeaderSize);
+	SlotHeader.Sequence = Frame.Sequence;
+	SlotHeader.Crc = FCrc::MemCrc32(SlotBytes.GetData() + SlotHeaderSize, SlotHeader.PayloadSize);
+	{
+		FMemoryWriter SlotHeaderWriter(SlotBytes);
+		SlotHeader.Serialize(SlotHeaderWriter);
+	}
+
+	const int64 SlotOffset = int64(HeaderSize) + NameTableSize + int64((Frame.Sequence - 1) % SlotCount) * SlotSize;
+	FileHandle->Seek(SlotOffset);
+	FileHandle->Write(SlotBytes.GetData(), SlotBytes.Num());
+	WriteHeader();
+	// the OS cache takes the writes, a crash loses at most the frames since the last flush
+	if (Frame.Sequence % FlushIntervalFrames == 0)
+	{
+		FileHandle->Flush();
+	}
+}
+
+bool FMassTelemetryRingReader::Load(const FString& FilePath)
+{
+	using namespace UE::MassHelper::Private;
+
+	Names.Reset();
+	Frames.Reset();
+	TornSlotCount = 0;
+
+	TArray<uint8> FileBytes;
+	if (FFileHelper::LoadFileToArray(FileBytes, *FilePath, FILEREAD_AllowWrite) == false || FileBytes.Num() < FMassTelemetryRingWriter::HeaderSize)
+	{
+		UE_LOG(LogMass, Error, TEXT("%s could not read %s"), ANSI_TO_TCHAR(__FUNCTION__), *FilePath);
+		return false;
+	}
+
+	FTelemetryRingHeader Header;
+	{
+		FMemoryReader HeaderReader(FileBytes);
+		Header.Serialize(HeaderReader);
+	}
+	if (Header.Magic != FMassTelemetryRingWriter::Magic || Header.Version != FMassTelemetryRingWriter::Version)
+	{
+		UE_LOG(LogMass, Error, TEXT("%s %s is not a Mass telemetry ring file of version %u"), ANSI_TO_TCHAR(__FUNCTION__), *FilePath
+			, FMassTelemetryRingWriter::Version);
+		return false;
+	}
+
+	int64 Offset = FMassTelemetryRingWriter::HeaderSize;
+	const int64 NameTableEnd = FMath::Min<int64>(Offset + Header.NameTableUsed, FileBytes.Num());
+	while (Offset + int64(sizeof(uint16)) <= NameTableEnd)
+	{
+		uint16 Length = 0;
+		FMemory::Memcpy(&Length, FileBytes.GetData() + Offset, sizeof(Length));
+		Offset += sizeof(Length);
+		if (Offset + Length > NameTableEnd)
+		{
+			break;
+		}
+		Names.Add(FString(FUTF8ToTCHAR(reinterpret_cast<const ANSICHAR*>(FileBytes.GetData() + Offset), Length)));
+		Offset += Length;
+	}
+
+	const int64 SlotsOffset = int64(FMassTelemetryRingWriter::HeaderSize) + Header.NameTableSize;
+	for (int32 SlotIndex = 0; SlotIndex < Header.SlotCount; ++SlotIndex)
+	{
+		const int64 SlotOffset = SlotsOffset + int64(SlotIndex) * Header.SlotSize;
+		if (SlotOffset + FMassTelemetryRingWriter::SlotHeaderSize > FileBytes.Num())
+		{
+			// the ring hasn't wrapped yet
+			break;
+		}
+
+		FTelemetrySlotHeader SlotHeader;
+		FMemoryReader SlotReader(FileBytes);
+		SlotReader.Seek(SlotOffset);
+		SlotHeader.Serialize(SlotReader);
+		if (SlotHeader.Magic != FMassTelemetryRingWriter::SlotMagic)
+		{
+			continue;
+		}
+		const int64 PayloadOffset = SlotOffset + FMassTelemetryRingWriter::SlotHeaderSize;
+		if (PayloadOffset + SlotHeader.PayloadSize > FileBytes.Num() || SlotHeader.PayloadSize > uint32(Header.SlotSize)
+			|| FCrc::MemCrc32(FileBytes.GetData() + PayloadOffset, SlotHeader.PayloadSize) != SlotHeader.Crc)
+		{
+			++TornSlotCount;
+			continue;
+		}
+
+		FMassTelemetryFrame& Frame = Frames.AddDefaulted_GetRef();
+		Frame.Serialize(SlotReader);
+	}
+
+	Frames.Sort([](const FMassTelemetryFrame& A, const FMassTelemetryFrame& B) { return A.Sequence < B.Sequence; });
+	return true;
+}
+
+const FString& FMassTelemetryRingReader::GetName(const uint32 NameId) const
+{
+	static const FString UnknownName(TEXT("<unknown>"));
+	return Names.IsValidIndex(int32(NameId)) ? Names[int32(NameId)] : UnknownName;
+}
@@ -0,0 +1,59 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+#include "MassHelper/Public/Analysis/MassArchetypeMatchIndex.h"
+#include "MassHelper/Public/Benchmark/MassSyntheticProcessor.h"
+
+#include "MassEntity/Public/MassEntityManager.h"
+#include "MassCommon/Public/MassCommonFragments.h"
+#include "MassLOD/Public/MassLODFragments.h"
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMassArchetypeMatchIndexTest, "MassHelper.Analysis.ArchetypeMatchIndex"
+	, EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FMassArchetypeMatchIndexTest::RunTest(const FString& Parameters)
+{
+	const UScriptStruct* Transform = FTransformFragment::StaticStruct();
+	const UScriptStruct* ViewerInfo = FMassViewerInfoFragment::StaticStruct();
+	const UScriptStruct* OffLOD = FMassOffLODTag::StaticStruct();
+
+	TSharedRef<FMassEntityManager> EntityManager = MakeShareable(new FMassEntityManager());
+	EntityManager->CreateArchetype(TArray<const UScriptStruct*>({ Transform }));
+	const FMassArchetypeHandle Matching = EntityManager->CreateArchetype(TArray<const UScriptStruct*>({ Transform, ViewerInfo }));
+	EntityManager->CreateArchetype(TArray<const UScriptStruct*>({ Transform, ViewerInfo, OffLOD }));
+	EntityManager->CreateArchetype(TArray<const UScriptStruct*>({ ViewerInfo }));
+
+	// reads the transform, writes the viewer info, skips Off LOD entities
+	UMassSyntheticProcessor* Processor = NewObject<UMassSyntheticProcessor>();
+	Processor->Configure(FMassProcessorExecutionOrder(), MakeArrayView(&Transform, 1), MakeArrayView(&ViewerInfo, 1), {}, MakeArrayView(&OffLOD, 1));
+
+	FMassArchetypeMatchIndex MatchIndex;
+	MatchIndex.Build(*EntityManager);
+	TestEqual(TEXT("Every archetype is indexed"), MatchIndex.GetArchetypeCount(), 4);
+
+	TArray<FMassArchetypeHandle> IndexArchetypes;
+	MatchIndex.GetArchetypesMatchingOwnedQueries(*Processor, IndexArchetypes);
+	if (TestEqual(TEXT("Only the archetype with both fragments and without the tag matches"), IndexArchetypes.Num(), 1))
+	{
+		TestTrue(TEXT("The handle is the entity manager's"), IndexArchetypes[0] == Matching);
+	}
+
+	TArray<FMassArchetypeHandle> QueryArchetypes;
+	Processor->GetArchetypesMatchingOwnedQueries(*EntityManager, QueryArchetypes);
+	TestTrue(TEXT("Same archetypes as the processor's own queries")
+		, TSet<FMassArchetypeHandle>(IndexArchetypes).Num() == IndexArchetypes.Num()
+		&& TSet<FMassArchetypeHandle>(IndexArchetypes).Difference(TSet<FMassArchetypeHandle>(QueryArchetypes)).Num() == 0
+		&& IndexArchetypes.Num() == TSet<FMassArchetypeHandle>(QueryArchetypes).Num());
+
+	// like FMassEntityQuery::CacheArchetypes, requirements without any positive requirement match nothing
+	TArray<FMassArchetypeHandle> EmptyArchetypes;
+	MatchIndex.GetArchetypesMatchingRequirements(FMassFragmentRequirements(), EmptyArchetypes);
+	TestEqual(TEXT("Invalid requirements match nothing"), EmptyArchetypes.Num(), 0);
+
+	Processor->MarkAsGarbage();
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,56 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+#include "MassHelper/Public/Processor/MassDependencyJsonWriter.h"
+
+#include "Json/Public/Dom/JsonObject.h"
+#include "Json/Public/Serialization/JsonReader.h"
+#include "Json/Public/Serialization/JsonSerializer.h"
+
+#include "Misc/AutomationTest.h"
+#include "Serialization/MemoryWriter.h"
+#include <limits>
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMassDependencyJsonWriterEscapingTest, "MassHelper.Processor.JsonWriter.Escaping"
+	, EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FMassDependencyJsonWriterEscapingTest::RunTest(const FString& Parameters)
+{
+	const FString Key = TEXT("quote\"backslash\\");
+	const FString Value = TEXT("line\nreturn\rtab\tcontrol\x01non-ascii \u00e9\u4e2d");
+	const FName Name(TEXT("Processor_Name"));
+
+	TArray<uint8> Bytes;
+	FMemoryWriter Archive(Bytes);
+	FMassDependencyJsonWriter Writer(Archive);
+	Writer.BeginObject();
+	Writer.WriteStringField(Key, Value);
+	Writer.WriteKey(TEXT("Numbers"));
+	Writer.BeginArray();
+	Writer.WriteNumber(3.);
+	Writer.WriteNumber(0.25);
+	Writer.WriteNumber(std::numeric_limits<double>::infinity());
+	Writer.EndArray();
+	Writer.WriteNameField(TEXT("First"), Name);
+	Writer.WriteNameField(TEXT("Second"), Name);
+	Writer.EndObject();
+
+	const FUTF8ToTCHAR Converted(reinterpret_cast<const ANSICHAR*>(Bytes.GetData()), Bytes.Num());
+	const FString Json(Converted.Length(), Converted.Get());
+	TestEqual(TEXT("Escaped output")
+		, Json
+		, FString(TEXT("{\"quote\\\"backslash\\\\\":\"line\\nreturn\\rtab\\tcontrol\\u0001non-ascii \u00e9\u4e2d\",\"Numbers\":[3,0.25,null],\"First\":\"Processor_Name\",\"Second\":\"Processor_Name\"}")));
+	TestEqual(TEXT("Names are interned once"), Writer.GetInternedNameCount(), 1);
+
+	// whatever got escaped has to come back unchanged
+	TSharedPtr<FJsonObject> Parsed;
+	if (TestTrue(TEXT("Output parses"), FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(Json), Parsed) && Parsed.IsValid()))
+	{
+		FString ParsedValue;
+		TestTrue(TEXT("Escaped key round trips"), Parsed->TryGetStringField(Key, ParsedValue));
+		TestEqual(TEXT("Escaped value round trips"), ParsedValue, Value);
+	}
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,170 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+#include "MassHelper/Public/Analysis/MassProcessorGraph.h"
+#include "MassHelper/Public/Analysis/MassProcessorScheduleSimulation.h"
+#include "MassHelper/Public/Analysis/MassProcessorConstraintAnalysis.h"
+#include "MassHelper/Public/Benchmark/MassSyntheticProcessor.h"
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace UE::MassHelper::Private
+{
+	int32 AddTestGraphProcessor(FMassProcessorGraph& Graph, const TCHAR* Name, const double CostMs, const bool bRequiresGameThread = false)
+	{
+		// only compared against nullptr by the analyses, any processor object does
+		const int32 NodeIndex = Graph.FindOrAddNode(FName(Name), GetDefault<UMassSyntheticProcessor>());
+		Graph.Nodes[NodeIndex].CostMs = CostMs;
+		Graph.Nodes[NodeIndex].bRequiresGameThread = bRequiresGameThread;
+		return NodeIndex;
+	}
+
+	/** A(2) -> B(3) -> D(1) and A -> C(1, game thread) -> D. */
+	struct FDiamondTestGraph
+	{
+		FDiamondTestGraph()
+		{
+			A = AddTestGraphProcessor(Graph, TEXT("A"), 2.);
+			B = AddTestGraphProcessor(Graph, TEXT("B"), 3.);
+			C = AddTestGraphProcessor(Graph, TEXT("C"), 1., /*bRequiresGameThread=*/true);
+			D = AddTestGraphProcessor(Graph, TEXT("D"), 1.);
+			Graph.AddEdge(A, B, FMassProcessorGraph::EEdgeSource::ExecutionOrder);
+			Graph.AddEdge(A, C, FMassProcessorGraph::EEdgeSource::ExecutionOrder);
+			Graph.AddEdge(B, D, FMassProcessorGraph::EEdgeSource::ExecutionOrder);
+			Graph.AddEdge(C, D, FMassProcessorGraph::EEdgeSource::ExecutionOrder);
+		}
+
+		FMassProcessorGraph Graph;
+		int32 A = INDEX_NONE;
+		int32 B = INDEX_NONE;
+		int32 C = INDEX_NONE;
+		int32 D = INDEX_NONE;
+	};
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMassProcessorGraphTopologicalOrderTest, "MassHelper.Analysis.Graph.TopologicalOrder"
+	, EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FMassProcessorGraphTopologicalOrderTest::RunTest(const FString& Parameters)
+{
+	UE::MassHelper::Private::FDiamondTestGraph Diamond;
+
+	TArray<int32> Order;
+	TestTrue(TEXT("Acyclic graph sorts"), Diamond.Graph.GetTopologicalOrder(Order));
+	TestEqual(TEXT("Every node is ordered"), Order.Num(), Diamond.Graph.Nodes.Num());
+	for (const TPair<TPair<int32, int32>, FMassProcessorGraph::EEdgeSource>& Edge : Diamond.Graph.Edges)
+	{
+		TestTrue(TEXT("Dependencies come first"), Order.IndexOfByKey(Edge.Key.Key) < Order.IndexOfByKey(Edge.Key.Value));
+	}
+
+	Diamond.Graph.AddEdge(Diamond.D, Diamond.A, FMassProcessorGraph::EEdgeSource::OriginalDependency);
+	TestFalse(TEXT("Cycle is detected"), Diamond.Graph.GetTopologicalOrder(Order));
+	TestTrue(TEXT("Cyclic nodes are left out"), Order.Num() < Diamond.Graph.Nodes.Num());
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMassCriticalPathAnalysisTest, "MassHelper.Analysis.Graph.CriticalPath"
+	, EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FMassCriticalPathAnalysisTest::RunTest(const FString& Parameters)
+{
+	UE::MassHelper::Private::FDiamondTestGraph Diamond;
+
+	FMassCriticalPathAnalysis Analysis;
+	TestTrue(TEXT("Analysis succeeds"), Analysis.Analyze(Diamond.Graph));
+	TestEqual(TEXT("Total work"), Analysis.TotalWorkMs, 7.);
+	TestEqual(TEXT("Game thread work"), Analysis.GameThreadWorkMs, 1.);
+	TestEqual(TEXT("Critical path length"), Analysis.CriticalPathMs, 6.);
+	TestEqual(TEXT("Critical path"), Analysis.CriticalPath, TArray<int32>({ Diamond.A, Diamond.B, Diamond.D }));
+	TestEqual(TEXT("Level widths"), Analysis.LevelWidths, TArray<int32>({ 1, 2, 1 }));
+	TestEqual(TEXT("Slack off the critical path"), Analysis.NodeInfos[Diamond.C].GetSlackMs(), 2.);
+	TestEqual(TEXT("No slack on the critical path"), Analysis.NodeInfos[Diamond.B].GetSlackMs(), 0.);
+
+	// with two lanes the game thread lane only takes C, the worker lane the remaining 6ms
+	TestEqual(TEXT("Single lane speedup"), Analysis.GetSpeedupLimit(1), 1.);
+	TestEqual(TEXT("Two lane speedup"), Analysis.GetSpeedupLimit(2), 7. / 6.);
+	TestEqual(TEXT("Speedup bounded by the critical path"), Analysis.GetSpeedupLimit(8), 7. / 6.);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMassProcessorScheduleSimulationTest, "MassHelper.Analysis.Graph.ScheduleSimulation"
+	, EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FMassProcessorScheduleSimulationTest::RunTest(const FString& Parameters)
+{
+	UE::MassHelper::Private::FDiamondTestGraph Diamond;
+
+	FMassProcessorScheduleSimulation::FResult Serial;
+	FMassProcessorScheduleSimulation::Simulate(Diamond.Graph, 1, Serial);
+	TestEqual(TEXT("One core runs everything back to back"), Serial.WallTimeMs, 7.);
+
+	FMassProcessorScheduleSimulation::FResult Parallel;
+	FMassProcessorScheduleSimulation::Simulate(Diamond.Graph, 3, Parallel);
+	TestEqual(TEXT("Three cores reach the critical path"), Parallel.WallTimeMs, 6.);
+	TestTrue(TEXT("Lane 0 is the game thread"), Parallel.Lanes[0].bIsGameThread);
+	TestEqual(TEXT("Game thread processor runs on lane 0"), Parallel.NodeLanes[Diamond.C], 0);
+	TestNotEqual(TEXT("Worker processor stays off lane 0"), Parallel.NodeLanes[Diamond.B], 0);
+	TestTrue(TEXT("Dependents start after their dependencies end"), Parallel.NodeStartMs[Diamond.D] >= Parallel.NodeStartMs[Diamond.B] + 3.);
+
+	// the speedup limit is a bound of what the simulator can achieve on the same lanes
+	FMassCriticalPathAnalysis Analysis;
+	Analysis.Analyze(Diamond.Graph);
+	for (int32 CoreCount = 1; CoreCount <= 4; ++CoreCount)
+	{
+		FMassProcessorScheduleSimulation::FResult Result;
+		FMassProcessorScheduleSimulation::Simulate(Diamond.Graph, CoreCount, Result);
+		TestTrue(FString::Printf(TEXT("%d cores stay within the speedup limit"), CoreCount)
+			, Analysis.TotalWorkMs / Result.WallTimeMs <= Analysis.GetSpeedupLimit(CoreCount) + UE_KINDA_SMALL_NUMBER);
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMassRedundantConstraintTest, "MassHelper.Analysis.Graph.RedundantConstraints"
+	, EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FMassRedundantConstraintTest::RunTest(const FString& Parameters)
+{
+	using UE::MassHelper::Private::AddTestGraphProcessor;
+
+	// C runs after A and B, B after A: C's ExecuteAfter A is implied through B
+	FMassProcessorGraph Graph;
+	const int32 A = AddTestGraphProcessor(Graph, TEXT("A"), 1.);
+	const int32 B = AddTestGraphProcessor(Graph, TEXT("B"), 1.);
+	const int32 C = AddTestGraphProcessor(Graph, TEXT("C"), 1.);
+	Graph.AddEdge(A, B, FMassProcessorGraph::EEdgeSource::OriginalDependency);
+	Graph.AddEdge(B, C, FMassProcessorGraph::EEdgeSource::OriginalDependency);
+	Graph.AddEdge(A, C, FMassProcessorGraph::EEdgeSource::OriginalDependency);
+
+	const FMassExecutionRequirements NoRequirements;
+	const TArray<FName> BExecuteAfter = { FName(TEXT("A")) };
+	const TArray<FName> CExecuteAfter = { FName(TEXT("A")), FName(TEXT("B")) };
+	TArray<FMassDependencyReasonResolver::FNodeDesc> NodeDescs;
+	for (const FMassProcessorGraph::FNode& Node : Graph.Nodes)
+	{
+		FMassDependencyReasonResolver::FNodeDesc& Desc = NodeDescs.AddDefaulted_GetRef();
+		Desc.Name = Node.Name;
+		Desc.bIsGroup = false;
+		Desc.Requirements = &NoRequirements;
+	}
+	NodeDescs[B].ExecuteAfter = BExecuteAfter;
+	NodeDescs[C].ExecuteAfter = CExecuteAfter;
+	TArray<int32> ParentGroups;
+	ParentGroups.Init(INDEX_NONE, Graph.Nodes.Num());
+
+	FMassProcessorConstraintAnalysis Analysis;
+	Analysis.Analyze(Graph, NodeDescs, ParentGroups, 2);
+
+	const TArray<FMassProcessorConstraintAnalysis::FFinding> Redundant = Analysis.Findings.FilterByPredicate([](const FMassProcessorConstraintAnalysis::FFinding& Finding)
+		{
+			return Finding.Kind == FMassProcessorConstraintAnalysis::EFindingKind::Redundant;
+		});
+	if (TestEqual(TEXT("Only the transitive constraint is redundant"), Redundant.Num(), 1))
+	{
+		const FMassProcessorConstraintAnalysis::FConstraint Expected{ C, A, /*bExecuteBefore=*/false };
+		TestTrue(TEXT("C's ExecuteAfter A is reported"), Redundant[0].Constraint == Expected);
+		TestEqual(TEXT("Implied through B"), Redundant[0].ImpliedViaIndex, B);
+	}
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
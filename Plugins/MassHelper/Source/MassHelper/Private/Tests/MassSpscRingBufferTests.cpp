@@ -0,0 +1,81 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+#include "MassHelper/Public/Profiling/MassSpscRingBuffer.h"
+
+#include "Async/Async.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMassSpscRingBufferTest, "MassHelper.Profiling.SpscRingBuffer.SingleThread"
+	, EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FMassSpscRingBufferTest::RunTest(const FString& Parameters)
+{
+	TMassSpscRingBuffer<int32> Ring(5);
+	TestEqual(TEXT("Capacity rounds up to a power of two"), Ring.GetCapacity(), 8u);
+
+	// wrap around the indices a few times, the ring must hand items out in push order and drop when full
+	int32 NextPushed = 0;
+	int32 NextDrained = 0;
+	for (int32 Round = 0; Round < 3; ++Round)
+	{
+		for (uint32 Index = 0; Index < Ring.GetCapacity(); ++Index)
+		{
+			TestTrue(TEXT("Push fits"), Ring.Push(NextPushed++));
+		}
+		TestFalse(TEXT("Push into a full ring is dropped"), Ring.Push(-1));
+
+		const uint32 DrainedCount = Ring.Drain([this, &NextDrained](const int32 Item)
+			{
+				TestEqual(TEXT("Drained in push order"), Item, NextDrained++);
+			});
+		TestEqual(TEXT("Drains everything published"), DrainedCount, Ring.GetCapacity());
+		TestEqual(TEXT("Empty ring drains nothing"), Ring.Drain([](const int32) {}), 0u);
+
+		TestTrue(TEXT("Partial push fits"), Ring.Push(NextPushed++));
+		TestEqual(TEXT("Partial drain"), Ring.Drain([&NextDrained](const int32) { ++NextDrained; }), 1u);
+	}
+	TestEqual(TEXT("Nothing lost"), NextDrained, NextPushed);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMassSpscRingBufferThreadedTest, "MassHelper.Profiling.SpscRingBuffer.TwoThreads"
+	, EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FMassSpscRingBufferThreadedTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 ItemCount = 200000;
+	TMassSpscRingBuffer<int32> Ring(64);
+
+	// the producer retries dropped items, so the consumer has to see every one of them exactly once and in order
+	TFuture<void> Producer = Async(EAsyncExecution::Thread, [&Ring]()
+		{
+			for (int32 Item = 0; Item < ItemCount; ++Item)
+			{
+				while (Ring.Push(Item) == false)
+				{
+					FPlatformProcess::Yield();
+				}
+			}
+		});
+
+	int32 NextExpected = 0;
+	bool bInOrder = true;
+	while (NextExpected < ItemCount)
+	{
+		Ring.Drain([&NextExpected, &bInOrder](const int32 Item)
+			{
+				bInOrder &= Item == NextExpected;
+				++NextExpected;
+			});
+		FPlatformProcess::Yield();
+	}
+	Producer.Wait();
+
+	TestTrue(TEXT("Consumer sees the producer's order"), bInOrder);
+	TestEqual(TEXT("Consumer sees every item"), NextExpected, ItemCount);
+	TestEqual(TEXT("Nothing left behind"), Ring.Drain([](const int32) {}), 0u);
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
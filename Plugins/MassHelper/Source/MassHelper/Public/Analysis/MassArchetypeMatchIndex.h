@@ -0,0 +1,59 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassEntity/Public/MassArchetypeTypes.h"
+
+struct FMassEntityManager;
+struct FMassArchetypeData;
+struct FMassFragmentRequirements;
+class UMassProcessor;
+
+/**
+ * Inverted index from fragment, tag, chunk and shared fragment types to the archetypes holding them, one packed
+ * bitset over all archetypes per type. A query's candidates are the AND of its required types' bitsets minus its
+ * excluded types' bitsets, 64 archetypes per word, so only the candidates get the exact requirement test. Unlike
+ * UMassProcessor::GetArchetypesMatchingOwnedQueries nothing gets cached in the queries, which is what makes matching
+ * hundreds of processors against thousands of archetypes slow.
+ *
+ * The result is the same set as GetArchetypesMatchingOwnedQueries: every owned query's matches in turn, each archetype
+ * once, and nothing for queries whose requirements the engine considers invalid. The index is a snapshot, archetypes
+ * created after Build aren't seen.
+ *
+ * Only the printer's own ExecutesGroupTree pruning matches through it. FMassProcessorDependencySolver::ResolveDependencies
+ * is engine code and keeps matching, pruning and checking archetype overlap through the queries.
+ */
+struct MASSHELPER_API FMassArchetypeMatchIndex
+{
+	/** Non-const since the handles are looked up through FMassEntityManager::CreateArchetype, which finds the existing ones. */
+	void Build(FMassEntityManager& EntityManager);
+
+	void GetArchetypesMatchingOwnedQueries(const UMassProcessor& Processor, TArray<FMassArchetypeHandle>& OutArchetypes) const;
+	void GetArchetypesMatchingRequirements(const FMassFragmentRequirements& Requirements, TArray<FMassArchetypeHandle>& OutArchetypes) const;
+
+	int32 GetArchetypeCount() const { return Archetypes.Num(); }
+	int32 GetTypeCount() const { return TypeBits.Num(); }
+
+protected:
+	enum class ETypeKind : uint8
+	{
+		Fragment,
+		Tag,
+		ChunkFragment,
+		SharedFragment,
+	};
+
+	using FWords = TArray<uint64>;
+
+	void AddTypeBits(const ETypeKind Kind, TConstArrayView<const UStruct*> Types, const int32 ArchetypeIndex);
+	/** Narrows InOutCandidates to the archetypes having all of Types (bRequired) or none of them. Returns false once empty. */
+	bool FilterCandidates(const ETypeKind Kind, TConstArrayView<const UStruct*> Types, const bool bRequired, FWords& InOutCandidates) const;
+	/** Adds the matches not flagged in InOutMatched yet and flags them. */
+	void AddMatchingArchetypes(const FMassFragmentRequirements& Requirements, FWords& InOutMatched, TArray<FMassArchetypeHandle>& OutArchetypes) const;
+
+	TArray<FMassArchetypeHandle> Archetypes;
+	int32 WordCount = 0;
+	TMap<TPair<ETypeKind, const UStruct*>, int32> TypeIndices;
+	TArray<FWords> TypeBits;
+};
@@ -0,0 +1,66 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FMassEntityManager;
+struct FMassArchetypeData;
+
+/**
+ * Chunk occupancy and memory usage of every archetype of an entity manager. Wasted bytes are the unused entity slots
+ * of allocated chunks plus each chunk's tail that is too small to hold another entity.
+ */
+struct MASSHELPER_API FMassArchetypeMemoryReport
+{
+	struct FFragmentInfo
+	{
+		FName Type;
+		int32 BytesPerEntity = 0;
+	};
+
+	struct FSharedFragmentInfo
+	{
+		FName Type;
+		bool bConst = false;
+		/** Number of distinct values among the archetype's non-empty chunks. */
+		int32 Cardinality = 0;
+	};
+
+	struct FArchetypeInfo
+	{
+		uint32 CompositionHash = 0;
+		int32 EntityCount = 0;
+		int32 ChunkCount = 0;
+		int32 NonEmptyChunkCount = 0;
+		int32 EntitiesPerChunk = 0;
+		int32 ChunkAllocSize = 0;
+		int32 BytesPerEntity = 0;
+		TArray<FFragmentInfo> Fragments;
+		TArray<FName> Tags;
+		TArray<FName> ChunkFragments;
+		TArray<FSharedFragmentInfo> SharedFragments;
+		/** Histogram of chunk fill in 10% buckets, the last bucket only holds full chunks. */
+		int32 FillHistogram[11] = {};
+		int64 UnusedSlotBytes = 0;
+		int64 ChunkTailBytes = 0;
+
+		int64 GetAllocatedBytes() const { return int64(ChunkCount) * ChunkAllocSize; }
+		int64 GetWastedBytes() const { return UnusedSlotBytes + ChunkTailBytes; }
+		double GetFillRatio() const { return (ChunkCount && EntitiesPerChunk) ? double(EntityCount) / (double(ChunkCount) * EntitiesPerChunk) : 0.; }
+	};
+
+	/** Sorted by wasted bytes, most wasteful first. */
+	TArray<FArchetypeInfo> Archetypes;
+
+	void Gather(const FMassEntityManager& EntityManager);
+
+	/** Every archetype the entity manager created so far. */
+	static void GetArchetypes(const FMassEntityManager& EntityManager, TArray<TSharedPtr<FMassArchetypeData>>& OutArchetypes);
+
+	/** Fills OutInfo from a single archetype. */
+	static void GatherArchetype(const FMassArchetypeData& ArchetypeData, FArchetypeInfo& OutInfo);
+
+	/** Writes the report in the dump json style, PrintMode "ArchetypeMemory". */
+	void Write(FArchive& OutArchive) const;
+};
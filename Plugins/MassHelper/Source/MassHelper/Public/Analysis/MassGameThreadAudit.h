@@ -0,0 +1,60 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassEntity/Public/MassProcessorDependencySolver.h"
+
+class FMassDependencyJsonWriter;
+struct FMassProcessorGraph;
+
+/**
+ * Audits the processors that require game thread execution on a simulated schedule (see
+ * FMassProcessorScheduleSimulation, lane 0 being the game thread). For every such processor it reports where it sits
+ * in the solved order, how long it waited for the game thread, how many processors became ready only when it
+ * finished, how much worker time went idle while it ran and the wall time moving it off the game thread would save.
+ * Processors are ranked by that saving, then by the idle worker time.
+ */
+struct MASSHELPER_API FMassGameThreadAudit
+{
+	struct FProcessorInfo
+	{
+		int32 NodeIndex = INDEX_NONE;
+		/** Index in the solver's sorted processors, INDEX_NONE if the processor didn't make it into the order. */
+		int32 SolvedOrderIndex = INDEX_NONE;
+		double CostMs = 0.;
+		double ReadyMs = 0.;
+		double StartMs = 0.;
+		/** Processors whose last dependency to finish was this one, they sat ready to run behind it. */
+		int32 WaitingProcessorCount = 0;
+		/** Worker lane time left idle while the processor ran. */
+		double IdleWorkerMs = 0.;
+		/** Cost of every processor transitively depending on this one. */
+		double DownstreamWorkMs = 0.;
+		bool bOnCriticalPath = false;
+		/** Simulated wall time saved when only this processor may run on a worker. */
+		double SimulatedGainMs = 0.;
+
+		double GetGameThreadWaitMs() const { return StartMs - ReadyMs; }
+	};
+
+	/** The graph needs its costs applied. CoreCount includes the game thread, at least two are simulated. */
+	void Analyze(const FMassProcessorGraph& Graph, TConstArrayView<FMassProcessorOrderInfo> SortedProcessors, const int32 InCoreCount);
+
+	/** Writes the audit as a json object value. */
+	void WriteJson(FMassDependencyJsonWriter& Writer, const FMassProcessorGraph& Graph) const;
+
+	/** Game thread processors, ranked. */
+	TArray<FProcessorInfo> Processors;
+	int32 CoreCount = 0;
+	double TotalWorkMs = 0.;
+	double GameThreadWorkMs = 0.;
+	/** Game thread work on the longest dependency chain. */
+	double CriticalPathGameThreadMs = 0.;
+	double SimulatedWallTimeMs = 0.;
+	/** Wall time during which the game thread ran and every worker sat idle. */
+	double GameThreadOnlyMs = 0.;
+	/** Simulated wall time with no processor bound to the game thread, the most moving them could save. */
+	double AllOffGameThreadWallTimeMs = 0.;
+	bool bHasCycle = false;
+};
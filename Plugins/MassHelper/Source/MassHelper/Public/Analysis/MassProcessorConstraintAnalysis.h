@@ -0,0 +1,83 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassHelper/Public/Analysis/MassProcessorDependencyReasons.h"
+
+class FMassDependencyJsonWriter;
+struct FMassProcessorGraph;
+
+/**
+ * Finds declared ExecuteBefore/ExecuteAfter constraints that could be relaxed. Every execution order edge between
+ * two processors is attributed to the declared constraints implying it, directly or through the processors' groups.
+ * Edges without a resource conflict between their processors are relaxable, and a constraint is reported when it is
+ * the only one implying some of them. The gain of relaxing it is measured on the execution order graph with those
+ * edges removed, both as critical path and as simulated wall time. Explicit constraints already implied by other
+ * edges are reported separately, those cost nothing at runtime but hide what the config actually needs.
+ */
+struct MASSHELPER_API FMassProcessorConstraintAnalysis
+{
+	enum class EFindingKind : uint8
+	{
+		/** Processor to processor ordering between processors without any resource overlap. */
+		ExplicitOrderWithoutConflict,
+		/** Ordering declared against or inherited from a group, serializing processors without any resource overlap. */
+		GroupOrderWithoutConflict,
+		/** Explicit ordering already implied by another path of the graph. */
+		Redundant,
+	};
+
+	/** A declared constraint: Owner lists Target in its ExecuteBefore or ExecuteAfter. Indices into the graph nodes. */
+	struct FConstraint
+	{
+		int32 OwnerIndex = INDEX_NONE;
+		int32 TargetIndex = INDEX_NONE;
+		bool bExecuteBefore = false;
+
+		bool operator==(const FConstraint& Other) const
+		{
+			return OwnerIndex == Other.OwnerIndex && TargetIndex == Other.TargetIndex && bExecuteBefore == Other.bExecuteBefore;
+		}
+	};
+
+	struct FFinding
+	{
+		EFindingKind Kind = EFindingKind::Redundant;
+		FConstraint Constraint;
+		/** Execution order edges only this constraint implies and that have no resource conflict, as graph node indices. */
+		TArray<TPair<int32, int32>> RelaxableEdges;
+		/** Implied edges that are needed anyway because of a resource conflict. */
+		int32 ConflictingEdgeCount = 0;
+		/** Implied edges another constraint implies as well. */
+		int32 SharedEdgeCount = 0;
+		/** For redundant constraints, the first node of the other path. */
+		int32 ImpliedViaIndex = INDEX_NONE;
+		double CriticalPathGainMs = 0.;
+		double SimulatedGainMs = 0.;
+		double ParallelismAfter = 0.;
+	};
+
+	static const TCHAR* KindToString(const EFindingKind InKind);
+
+	/**
+	 * NodeDescs and ParentGroups are indexed like Graph.Nodes, ParentGroups holding INDEX_NONE for top level nodes.
+	 * The graph needs its costs applied. CoreCount is what the wall time is simulated on.
+	 */
+	void Analyze(const FMassProcessorGraph& Graph, TConstArrayView<FMassDependencyReasonResolver::FNodeDesc> NodeDescs, TConstArrayView<int32> ParentGroups
+		, const int32 InCoreCount);
+
+	/** Writes the findings as a json object value. */
+	void WriteJson(FMassDependencyJsonWriter& Writer, const FMassProcessorGraph& Graph) const;
+
+	/** Relaxable constraints ranked by simulated gain, then critical path gain, followed by the redundant ones. */
+	TArray<FFinding> Findings;
+	int32 CoreCount = 0;
+	double TotalWorkMs = 0.;
+	double CriticalPathMs = 0.;
+	double SimulatedWallTimeMs = 0.;
+
+protected:
+	void FindRelaxableConstraints(const FMassProcessorGraph& Graph, TConstArrayView<FMassDependencyReasonResolver::FNodeDesc> NodeDescs, TConstArrayView<int32> ParentGroups);
+	void FindRedundantConstraints(const FMassProcessorGraph& Graph, TConstArrayView<FMassDependencyReasonResolver::FNodeDesc> NodeDescs);
+};
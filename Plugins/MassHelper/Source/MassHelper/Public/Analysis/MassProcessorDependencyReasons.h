@@ -0,0 +1,105 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassEntity/Public/MassProcessorDependencySolver.h"
+
+class FMassDependencyJsonWriter;
+struct FMassProcessorGraph;
+
+/** One reason for a dependency edge between two nodes of the solved graph. */
+struct MASSHELPER_API FMassDependencyEdgeReason
+{
+	enum class EKind : uint8
+	{
+		/** The dependent lists the dependency in ExecuteAfter, or the dependency lists the dependent in ExecuteBefore. */
+		ExplicitOrder,
+		/** One of the nodes is a group, i.e. the edge is group membership or ordering declared against a group. */
+		GroupOrder,
+		/** Processor to processor edge inherited from ordering declared on or against the processors' groups. */
+		InheritedGroupOrder,
+		FragmentAccess,
+		ChunkFragmentAccess,
+		SharedFragmentAccess,
+		SubsystemAccess,
+		/** Both processors require the game thread, so they can never run concurrently. */
+		GameThreadExclusive,
+		/** The solver ordered the processors but none of the above explains why. */
+		Unexplained,
+	};
+
+	enum class EAccess : uint8
+	{
+		None,
+		WriteRead,
+		ReadWrite,
+		WriteWrite,
+	};
+
+	EKind Kind = EKind::Unexplained;
+	EAccess Access = EAccess::None;
+	/** Names of the conflicting types, for the *Access kinds. */
+	TArray<FString> Types;
+	/** The ExecuteBefore/ExecuteAfter entry behind the ordering kinds: ConstraintOwner lists ConstraintTarget. */
+	FName ConstraintOwner;
+	FName ConstraintTarget;
+	bool bConstraintExecuteBefore = false;
+
+	static const TCHAR* KindToString(const EKind InKind);
+	static const TCHAR* AccessToString(const EAccess InAccess);
+
+	/** Writes the reason as a json object value. */
+	void WriteJson(FMassDependencyJsonWriter& Writer) const;
+};
+
+/**
+ * Explains edges of a processor dependency graph in terms of the execution requirements of the two nodes: explicit
+ * ordering, fragment/chunk fragment/shared fragment/subsystem access conflicts and game thread exclusivity.
+ * Note that tags are never accessed for reading or writing, so they never cause a conflict on their own.
+ */
+struct MASSHELPER_API FMassDependencyReasonResolver
+{
+	struct FNodeDesc
+	{
+		FName Name;
+		bool bIsGroup = true;
+		bool bRequiresGameThread = false;
+		TConstArrayView<FName> ExecuteBefore;
+		TConstArrayView<FName> ExecuteAfter;
+		const FMassExecutionRequirements* Requirements = nullptr;
+	};
+
+	template<typename T>
+	static FNodeDesc MakeNodeDesc(const T& SolverNode)
+	{
+		FNodeDesc Desc;
+		Desc.Name = SolverNode.Name;
+		Desc.bIsGroup = SolverNode.IsGroup();
+		Desc.bRequiresGameThread = SolverNode.Processor && SolverNode.Processor->DoesRequireGameThreadExecution();
+		Desc.ExecuteBefore = SolverNode.ExecuteBefore;
+		Desc.ExecuteAfter = SolverNode.ExecuteAfter;
+		Desc.Requirements = &SolverNode.Requirements;
+		return Desc;
+	}
+
+	/** Gathers the ordering reasons, i.e. whether the edge was declared explicitly, directly or through groups. */
+	static void GetOrderingReasons(const FNodeDesc& From, const FNodeDesc& To, TArray<FMassDependencyEdgeReason>& OutReasons);
+
+	/**
+	 * Same as above, FromGroups and ToGroups are the groups enclosing the two nodes, innermost first. Edges between
+	 * processors are only reported as InheritedGroupOrder along with the group constraint they were inherited from.
+	 */
+	static void GetOrderingReasons(const FNodeDesc& From, const FNodeDesc& To, TConstArrayView<FNodeDesc> FromGroups
+		, TConstArrayView<FNodeDesc> ToGroups, TArray<FMassDependencyEdgeReason>& OutReasons);
+
+	/** Gathers every resource conflict between the two nodes. Returns true if any was found. */
+	static bool GetResourceReasons(const FNodeDesc& From, const FNodeDesc& To, TArray<FMassDependencyEdgeReason>& OutReasons);
+
+	/**
+	 * Gathers every reason for the edge, falling back to EKind::Unexplained. bIsOrderingEdge tells whether the edge
+	 * is one of the solver nodes' OriginalDependencies, i.e. whether it was declared rather than derived.
+	 */
+	static void GetReasons(const FNodeDesc& From, const FNodeDesc& To, TConstArrayView<FNodeDesc> FromGroups, TConstArrayView<FNodeDesc> ToGroups
+		, const bool bIsOrderingEdge, TArray<FMassDependencyEdgeReason>& OutReasons);
+};
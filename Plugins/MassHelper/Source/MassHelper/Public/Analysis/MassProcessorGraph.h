@@ -0,0 +1,134 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassEntity/Public/MassProcessor.h"
+#include "MassEntity/Public/MassProcessorDependencySolver.h"
+
+class FMassDependencyJsonWriter;
+class FMassProcessorTimingCapture;
+
+/** Per-processor cost in milliseconds, either measured by a timing capture or loaded from a JSON side file. */
+struct MASSHELPER_API FMassProcessorCostTable
+{
+	/** Cost assumed for processors without a measurement. */
+	double DefaultCostMs = 1.;
+	TMap<FName, double> CostsMs;
+
+	bool IsMeasured(const FName NodeName) const { return CostsMs.Contains(NodeName); }
+	double GetCostMs(const FName NodeName) const
+	{
+		const double* CostMs = CostsMs.Find(NodeName);
+		return CostMs ? *CostMs : DefaultCostMs;
+	}
+
+	void AddFromTimingCapture(const FMassProcessorTimingCapture& Capture);
+
+	/**
+	 * Accepts either a flat { "Costs": { "NodeName": Ms, ... }, "DefaultCostMs": Ms } document, or a dependency dump
+	 * produced by a timing capture, in which case every node's Timing.AvgMs is used.
+	 */
+	bool LoadFromJsonFile(const FString& FilePath);
+};
+
+/**
+ * Plain DAG view of a solved processor dependency graph. Group nodes are kept as zero-cost nodes so that orderings
+ * declared against groups stay intact, processors carry their cost and game thread requirement.
+ */
+struct MASSHELPER_API FMassProcessorGraph
+{
+	enum class EEdgeSource : uint8
+	{
+		None = 0,
+		/** Edge comes from the solver nodes' OriginalDependencies (ExecuteBefore/ExecuteAfter/group ordering). */
+		OriginalDependency = 1 << 0,
+		/** Edge comes from the solved FMassProcessorOrderInfo::Dependencies, i.e. what actually runs. */
+		ExecutionOrder = 1 << 1,
+	};
+
+	struct FNode
+	{
+		FName Name;
+		const UMassProcessor* Processor = nullptr;
+		double CostMs = 0.;
+		bool bRequiresGameThread = false;
+		TArray<int32> Dependencies;
+		TArray<int32> Dependents;
+		/** Index of the node in the solver's node array this node was built from. */
+		int32 SourceNodeIndex = INDEX_NONE;
+
+		bool IsProcessor() const { return Processor != nullptr; }
+	};
+
+	template<typename T>
+	void AddSolverNodes(const TArray<T>& SolverNodes)
+	{
+		for (int32 SolverNodeIndex = 0; SolverNodeIndex < SolverNodes.Num(); ++SolverNodeIndex)
+		{
+			const T& SolverNode = SolverNodes[SolverNodeIndex];
+			FNode& Node = Nodes[FindOrAddNode(SolverNode.Name, SolverNode.Processor)];
+			Node.SourceNodeIndex = SolverNodeIndex;
+		}
+		for (const T& SolverNode : SolverNodes)
+		{
+			const int32 NodeIndex = NodeIndexMap.FindChecked(SolverNode.Name);
+			for (const int32 DependencyIndex : SolverNode.OriginalDependencies)
+			{
+				AddEdge(NodeIndexMap.FindChecked(SolverNodes[DependencyIndex].Name), NodeIndex, EEdgeSource::OriginalDependency);
+			}
+		}
+	}
+
+	void AddExecutionOrder(TConstArrayView<FMassProcessorOrderInfo> SortedProcessors);
+	void ApplyCosts(const FMassProcessorCostTable& CostTable);
+
+	int32 FindOrAddNode(const FName Name, const UMassProcessor* Processor);
+	void AddEdge(const int32 FromIndex, const int32 ToIndex, const EEdgeSource Source);
+	EEdgeSource GetEdgeSource(const int32 FromIndex, const int32 ToIndex) const;
+	void RemoveEdge(const int32 FromIndex, const int32 ToIndex);
+
+	/** Kahn's algorithm. Returns false if the graph contains a cycle, OutOrder then only holds the acyclic part. */
+	bool GetTopologicalOrder(TArray<int32>& OutOrder) const;
+
+	int32 GetProcessorCount() const;
+	double GetTotalWorkMs() const;
+	double GetGameThreadWorkMs() const;
+
+	TArray<FNode> Nodes;
+	TMap<FName, int32> NodeIndexMap;
+	TMap<TPair<int32, int32>, EEdgeSource> Edges;
+};
+
+ENUM_CLASS_FLAGS(FMassProcessorGraph::EEdgeSource);
+
+/** Longest dependency chain, per-level width and speedup limits of a processor graph. */
+struct MASSHELPER_API FMassCriticalPathAnalysis
+{
+	struct FNodeInfo
+	{
+		/** Topological level counted in processors, groups don't add a level. INDEX_NONE for groups. */
+		int32 Level = INDEX_NONE;
+		double EarliestStartMs = 0.;
+		double LatestStartMs = 0.;
+		bool bOnCriticalPath = false;
+
+		double GetSlackMs() const { return LatestStartMs - EarliestStartMs; }
+	};
+
+	bool Analyze(const FMassProcessorGraph& Graph);
+
+	/** Upper bound of the speedup over serial execution on WorkerCount lanes, one of them the game thread once there are two. */
+	double GetSpeedupLimit(const int32 WorkerCount) const;
+
+	/** Writes the analysis as a json object value, with speedup limits for 1..MaxWorkerCount workers. */
+	void WriteJson(FMassDependencyJsonWriter& Writer, const FMassProcessorGraph& Graph, const int32 MaxWorkerCount) const;
+
+	TArray<FNodeInfo> NodeInfos;
+	TArray<int32> CriticalPath;
+	TArray<int32> LevelWidths;
+	double TotalWorkMs = 0.;
+	double CriticalPathMs = 0.;
+	double GameThreadWorkMs = 0.;
+	bool bHasCycle = false;
+};
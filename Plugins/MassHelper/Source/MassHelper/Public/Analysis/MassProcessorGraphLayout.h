@@ -0,0 +1,50 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FMassProcessorGraph;
+struct FMassPrintAnnotations;
+
+/**
+ * Layered (Sugiyama-style) layout of a processor graph. Nodes are put on their longest-path layer, the order within
+ * each layer comes from alternating barycenter sweeps, keeping the ordering with the fewest crossings between
+ * neighbouring layers. X grows with the layer, Y spreads every layer around 0.
+ */
+struct MASSHELPER_API FMassProcessorGraphLayout
+{
+	struct FNodeLayout
+	{
+		int32 Layer = 0;
+		int32 Order = 0;
+		double X = 0.;
+		double Y = 0.;
+	};
+
+	void Compute(const FMassProcessorGraph& Graph);
+
+	/** Crossings of edges between neighbouring layers, longer edges are not counted. */
+	int32 CountCrossings(const FMassProcessorGraph& Graph) const;
+
+	/** Adds a "Layout" field to every node and a "Layout" summary to the root. The writers reference Graph and this layout. */
+	void ExportAnnotations(const FMassProcessorGraph& Graph, FMassPrintAnnotations& InOutAnnotations) const;
+
+	/**
+	 * Writes the graph as Graphviz DOT. ParentGroups holds the enclosing group graph node of every graph node, or
+	 * INDEX_NONE, and turns groups into nested clusters.
+	 */
+	static void WriteDot(const FMassProcessorGraph& Graph, TConstArrayView<int32> ParentGroups, FArchive& OutArchive);
+
+	int32 SweepCount = 8;
+	double LayerSpacing = 1.;
+	double NodeSpacing = 1.;
+
+	TArray<FNodeLayout> NodeLayouts;
+	TArray<TArray<int32>> Layers;
+
+private:
+	void AssignLayers(const FMassProcessorGraph& Graph);
+	void SortLayer(const FMassProcessorGraph& Graph, const int32 LayerIndex, const bool bUseDependencies);
+	void UpdateOrders(const int32 LayerIndex);
+};
@@ -0,0 +1,68 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FMassDependencyJsonWriter;
+struct FMassProcessorGraph;
+
+/**
+ * List-scheduling simulation of a processor graph on a number of virtual cores. With more than one core, lane 0 is
+ * the game thread: it is the only lane running game thread processors and it doesn't pick up worker work, like the
+ * game thread doesn't execute AnyThread tasks. Ready processors are started in the order they became ready, ties
+ * broken by the solved order, which is close to what the task graph does with equal priority tasks.
+ */
+struct MASSHELPER_API FMassProcessorScheduleSimulation
+{
+	struct FLaneEntry
+	{
+		int32 NodeIndex = INDEX_NONE;
+		double StartMs = 0.;
+		double EndMs = 0.;
+	};
+
+	struct FLane
+	{
+		bool bIsGameThread = false;
+		TArray<FLaneEntry> Entries;
+		double BusyMs = 0.;
+	};
+
+	struct FResult
+	{
+		int32 CoreCount = 0;
+		double WallTimeMs = 0.;
+		TArray<FLane> Lanes;
+		/** Per graph node, the lane it ran on. INDEX_NONE for groups. */
+		TArray<int32> NodeLanes;
+		/** Per graph node, the simulated start time. */
+		TArray<double> NodeStartMs;
+		bool bHasCycle = false;
+
+		double GetUtilization() const;
+	};
+
+	struct FPrediction
+	{
+		int32 CoreCount = 0;
+		double WallTimeMs = 0.;
+		double Speedup = 1.;
+		double Utilization = 0.;
+	};
+
+	struct FCoreCountSweep
+	{
+		TArray<FPrediction> Predictions;
+		/** Full result of the largest core count. */
+		FResult Timeline;
+	};
+
+	static void Simulate(const FMassProcessorGraph& Graph, const int32 CoreCount, FResult& OutResult);
+
+	/** Simulates 1..MaxCoreCount cores, keeping the predictions of all of them plus the timeline of MaxCoreCount. */
+	static void SimulateCoreCounts(const FMassProcessorGraph& Graph, const int32 MaxCoreCount, FCoreCountSweep& OutSweep);
+
+	/** Writes the sweep as a json object value. */
+	static void WriteJson(FMassDependencyJsonWriter& Writer, const FMassProcessorGraph& Graph, const FCoreCountSweep& Sweep);
+};
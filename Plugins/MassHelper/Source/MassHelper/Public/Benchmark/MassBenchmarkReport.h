@@ -0,0 +1,66 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Results of a benchmark commandlet run: one entry per run (e.g. per entity count), each holding frame, phase and
+ * processor timings. Written as json so that a previous run can be stored as the baseline and compared against.
+ */
+struct MASSHELPER_API FMassBenchmarkReport
+{
+	struct FTimingStats
+	{
+		int32 SampleCount = 0;
+		double AvgMs = 0.;
+		double P95Ms = 0.;
+		double MaxMs = 0.;
+
+		static FTimingStats FromSamples(TArray<double> SamplesMs);
+	};
+
+	struct FRun
+	{
+		/** Key the baseline comparison matches runs by. */
+		FString Name;
+		int32 EntityCount = 0;
+		FTimingStats Frame;
+		TMap<FString, FTimingStats> Phases;
+		TMap<FName, FTimingStats> Processors;
+		/** Benchmark specific numbers, written as is and not compared. */
+		TMap<FString, double> Extra;
+	};
+
+	struct FRegression
+	{
+		FString Run;
+		/** "Frame", "Phase.<Name>" or "Processor.<Name>". */
+		FString Metric;
+		double BaselineMs = 0.;
+		double CurrentMs = 0.;
+	};
+
+	FString Benchmark;
+	TMap<FString, FString> Settings;
+	TArray<FRun> Runs;
+
+	/** Step timing shared by the benchmarks, BeginCycles taken from FPlatformTime::Cycles64. */
+	static double MillisecondsSince(const uint64 BeginCycles)
+	{
+		return FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - BeginCycles);
+	}
+
+	/** Regressed metrics: average time above baseline * (1 + Tolerance) and more than MinDeltaMs slower. */
+	void Compare(const FMassBenchmarkReport& Baseline, const double Tolerance, const double MinDeltaMs, TArray<FRegression>& OutRegressions) const;
+
+	void Write(FArchive& OutArchive, TConstArrayView<FRegression> Regressions = {}) const;
+	bool LoadFromFile(const FString& FileName);
+
+	/**
+	 * Commandlet epilogue: compares against -Baseline=<file> if given (-Tolerance=0.1, -MinDeltaMs=0.05), writes the
+	 * report with its regressions to -Out=<file> or Saved/MassBenchmark/DefaultFileName and returns the exit code,
+	 * non-zero when something regressed.
+	 */
+	int32 SaveAndCompare(const TCHAR* Params, const FString& DefaultFileName) const;
+};
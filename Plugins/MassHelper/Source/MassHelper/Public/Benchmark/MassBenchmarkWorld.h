@@ -0,0 +1,51 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassEntity/Public/MassEntityTypes.h"
+#include "UObject/StrongObjectPtr.h"
+
+class UMassEntityConfigAsset;
+struct FMassEntityManager;
+
+/**
+ * Game world for headless benchmarks (commandlets, -nullrhi). Loads a map or creates an empty world, begins play so
+ * the Mass simulation starts ticking its phases, and spawns entities from entity config assets through the
+ * MassSpawner subsystem the same way AMassSpawner does.
+ */
+class MASSHELPER_API FMassBenchmarkWorld
+{
+public:
+	~FMassBenchmarkWorld();
+
+	/** MapPath may be empty for an empty world. Turns mass.helper.ProfiledPhases on so the world runs profiled phases. */
+	bool Create(const FString& MapPath);
+	void Destroy();
+
+	/** Comma separated entity config asset paths, e.g. "/Game/Mass/Crowd.Crowd,/Game/Mass/Traffic.Traffic". */
+	bool LoadEntityConfigs(const FString& ConfigPaths);
+
+	/** Spawns Count entities split evenly over the loaded configs at random locations within SpawnRadius. */
+	void SpawnEntities(const int32 Count, const float SpawnRadius, TArray<FMassEntityHandle>& OutEntities);
+	void DestroyEntities(TArray<FMassEntityHandle>& InOutEntities);
+
+	/**
+	 * Creates Count entities split over the loaded configs straight through the entity manager's batch API, into the
+	 * templates' archetypes with their shared fragment values. Skips the spawner's initializers and data generation.
+	 */
+	void BatchCreateEntities(const int32 Count, TArray<FMassEntityHandle>& OutEntities);
+	void BatchDestroyEntities(TArray<FMassEntityHandle>& InOutEntities);
+
+	/** Ticks the world once and returns the frame's wall time in milliseconds. */
+	double Tick(const float DeltaSeconds);
+
+	UWorld* GetWorld() const { return World; }
+	FMassEntityManager* GetEntityManager() const;
+	int32 GetEntityConfigCount() const { return EntityConfigs.Num(); }
+
+private:
+	UWorld* World = nullptr;
+	TArray<TStrongObjectPtr<UMassEntityConfigAsset>> EntityConfigs;
+	FRandomStream RandomStream = FRandomStream(0x4D617373);
+};
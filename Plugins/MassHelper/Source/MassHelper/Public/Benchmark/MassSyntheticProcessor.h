@@ -0,0 +1,55 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassEntity/Public/MassProcessor.h"
+#include "MassEntity/Public/MassEntityQuery.h"
+#include "MassSyntheticProcessor.generated.h"
+
+/**
+ * Processor with an execution order and fragment requirements assigned after construction, used to feed the
+ * dependency solver and printer with large generated configurations. Never registers with the processing phases and
+ * never executes anything.
+ */
+UCLASS(Transient)
+class MASSHELPER_API UMassSyntheticProcessor : public UMassProcessor
+{
+	GENERATED_BODY()
+
+public:
+	UMassSyntheticProcessor();
+
+	/** Queries are configured on construction already, so the requirements are added straight to EntityQuery. */
+	void Configure(const FMassProcessorExecutionOrder& InExecutionOrder, TConstArrayView<const UScriptStruct*> ReadOnlyFragments
+		, TConstArrayView<const UScriptStruct*> ReadWriteFragments, TConstArrayView<const UScriptStruct*> RequiredTags, TConstArrayView<const UScriptStruct*> ExcludedTags);
+
+protected:
+	virtual void ConfigureQueries() override {}
+	virtual void Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) override {}
+
+	FMassEntityQuery EntityQuery;
+};
+
+/**
+ * Generates synthetic processor configurations: random nested ExecuteInGroup paths, ExecuteBefore/After edges that
+ * always point along generation order (so they never form a cycle on their own) and random fragment and tag
+ * requirements drawn from every fragment and tag type loaded.
+ */
+struct MASSHELPER_API FMassSyntheticProcessorGenerator
+{
+	int32 Seed = 0;
+	/** Nesting depth of ExecuteInGroup paths is uniform in [0, MaxGroupDepth]. */
+	int32 MaxGroupDepth = 4;
+	/** Distinct group names per nesting level. */
+	int32 GroupFanout = 6;
+	int32 EdgesPerProcessor = 3;
+	int32 FragmentsPerProcessor = 4;
+	int32 TagsPerProcessor = 1;
+
+	/** Creates Count processors in Outer. The first one is registered with the solver under the class name. */
+	void Generate(UObject& Outer, const int32 Count, TArray<UMassProcessor*>& OutProcessors) const;
+
+	/** Name the solver registers the processor at Index of a generated set under. */
+	static FName GetNodeName(TConstArrayView<UMassProcessor*> Processors, const int32 Index);
+};
@@ -0,0 +1,28 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "MassDependencySolverBenchmarkCommandlet.generated.h"
+
+/**
+ * Scaling benchmark of the dependency solver and printer on synthetic processor sets, see
+ * FMassSyntheticProcessorGenerator. For every processor count it times ResolveExecutesGroupTree, ResolveDependencies
+ * and the PrintCommon json output of both, and reports the memory held by the solver nodes:
+ *
+ *   UnrealEditor-Cmd <Project> -run=MassDependencySolverBenchmark -nullrhi -unattended
+ *     [-Counts=250,500,1000,2000,4000,8000] [-Repeat=5] [-Seed=0] [-MaxGroupDepth=4] [-GroupFanout=6]
+ *     [-EdgesPerProcessor=3] [-FragmentsPerProcessor=4] [-TagsPerProcessor=1]
+ *     [-Out=<file>] [-Baseline=<file> -Tolerance=0.1 -MinDeltaMs=0.05]
+ */
+UCLASS()
+class MASSHELPER_API UMassDependencySolverBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UMassDependencySolverBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,30 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "MassSimulationBenchmarkCommandlet.generated.h"
+
+/**
+ * Steady-state Mass simulation benchmark. For every entity count, spawns that many entities from the given entity
+ * configs, ticks the world for a warmup period and then records frame, phase and processor times for a fixed number
+ * of frames. Runs headless:
+ *
+ *   UnrealEditor-Cmd <Project> -run=MassSimulationBenchmark -nullrhi -unattended
+ *     -EntityConfigs=/Game/Mass/Crowd.Crowd,/Game/Mass/Traffic.Traffic [-Map=/Game/Maps/Bench]
+ *     [-Counts=10000,50000,200000] [-Warmup=60] [-Frames=300] [-DeltaTime=0.0333] [-SpawnRadius=20000]
+ *     [-Out=<file>] [-Baseline=<file> -Tolerance=0.1 -MinDeltaMs=0.05]
+ *
+ * Returns non-zero when a timing regressed against the baseline, see FMassBenchmarkReport::SaveAndCompare.
+ */
+UCLASS()
+class MASSHELPER_API UMassSimulationBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UMassSimulationBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
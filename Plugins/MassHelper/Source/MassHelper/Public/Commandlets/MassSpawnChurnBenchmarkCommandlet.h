@@ -0,0 +1,33 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "MassSpawnChurnBenchmarkCommandlet.generated.h"
+
+/**
+ * Spawn/despawn churn benchmark. Keeps a steady population simulating, then for every batch size runs waves that
+ * spawn the batch through the MassSpawner subsystem, let it simulate, and despawn it again. Every wave also creates
+ * and destroys the batch straight through the entity manager's batch API, the floor the spawner path is measured
+ * against. Runs headless:
+ *
+ *   UnrealEditor-Cmd <Project> -run=MassSpawnChurnBenchmark -nullrhi -unattended
+ *     -EntityConfigs=/Game/Mass/Crowd.Crowd [-Map=/Game/Maps/Bench] [-Population=10000]
+ *     [-BatchSizes=1000,5000,10000] [-Waves=10] [-SettleFrames=10] [-Warmup=60] [-DeltaTime=0.0333]
+ *     [-SpawnRadius=20000] [-Out=<file>] [-Baseline=<file> -Tolerance=0.1 -MinDeltaMs=0.05]
+ *
+ * Per batch size the report holds the spawn and despawn call times, the frames after each, the representation
+ * processors' time and the frame time spent outside the Mass phases (actor spawning), as well as entities per
+ * second, new archetypes and chunks per wave and the worst frame spike over the steady population's frame time.
+ */
+UCLASS()
+class MASSHELPER_API UMassSpawnChurnBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UMassSpawnChurnBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
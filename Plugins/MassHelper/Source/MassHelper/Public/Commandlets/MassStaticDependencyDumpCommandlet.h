@@ -0,0 +1,33 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "MassStaticDependencyDumpCommandlet.generated.h"
+
+/**
+ * Static dependency dump of every processing phase without a world: only the UMassEntitySettings phase config and
+ * its processor CDOs are used, the phases are solved one after another and written concurrently by
+ * FMassAllPhasesDependencyPrinter. Meant for pre-submit checks:
+ *
+ *   UnrealEditor-Cmd <Project> -run=MassStaticDependencyDump -nullrhi -unattended
+ *     [-Mode=CriticalPathAnalysis] [-CostFile=<file>] [-Workers=0] [-Out=<file>]
+ *     [-Baseline=<previous dump> -Tolerance=0.05]
+ *
+ * Mode is any json EPrintMode (CompletelyDependency, CriticalPathAnalysis, ScheduleSimulation, ConstraintAnalysis,
+ * GameThreadAudit, ExecutesGroupTree). With a baseline dump the phases are compared: processors that appeared or
+ * disappeared and new ordering dependencies are logged, a dependency cycle, a critical path longer or an average
+ * parallelism lower than the baseline by more than Tolerance fail the run with a non-zero exit code. The parallelism
+ * checks need both dumps written in CriticalPathAnalysis mode.
+ */
+UCLASS()
+class MASSHELPER_API UMassStaticDependencyDumpCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UMassStaticDependencyDumpCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,33 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "MassTelemetryQueryCommandlet.generated.h"
+
+/**
+ * Offline queries over a ring file written by StartTelemetryRing, works on a file that is still being written:
+ *
+ *   UnrealEditor-Cmd <Project> -run=MassTelemetryQuery [-File=<ring>] [-Query=Summary] [-Count=10] [-Out=<csv>]
+ *
+ * Queries:
+ *   Summary                                     frames covered, slowest processors and largest archetypes
+ *   WorstFrames [-Phase=<name>] [-Processor=<name>]
+ *                                               the Count frames with the longest frame, phase or processor time
+ *   ProcessorSeries -Processor=<name> [-Phase=<name>]
+ *                                               per frame time of the processor, by engine frame
+ *   ArchetypeCount -Archetype=<substring>       per frame entity count of the matching archetypes
+ *
+ * Results go to the log, -Out additionally writes the series as CSV.
+ */
+UCLASS()
+class MASSHELPER_API UMassTelemetryQueryCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UMassTelemetryQueryCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -5,8 +5,28 @@
 #include "CoreMinimal.h"
 #include "GameFramework/CheatManager.h"
 #include "MassHelper/Public/Processor/MassProcessorDependencyPrinter.h"
+#include "MassHelper/Public/Analysis/MassProcessorGraph.h"
 #include "MassDumpCheatManager.generated.h"
 
+class FMassProcessorTimingCapture;
+class FMassProcessorTraceCapture;
+class FMassProcessorLiveStats;
+class FMassCommandProfileCapture;
+class FMassLODTickCapture;
+class FMassSignalCapture;
+class FMassTelemetryRingWriter;
+
+/** How UMassDumpCheatManager prints a single phase. */
+struct FMassPhaseDumpOptions
+{
+	EPrintMode PrintMode = EPrintMode::CompletelyDependency;
+	const FMassPrintAnnotations* Annotations = nullptr;
+	const FMassProcessorCostTable* CostTable = nullptr;
+	int32 WorkerCount = 0;
+	/** Solves against the world's EntityManager and dynamic processors and adds every processor's current workload. */
+	bool bRuntime = false;
+};
+
 /**
  * Extension of the CheatManager class that enables custom console commands and debug functions for development use.
  */
@@ -18,6 +38,8 @@ class MASSHELPER_API UMassDumpCheatManager : public UCheatManager
 public:
 	UMassDumpCheatManager();
 
+	virtual void BeginDestroy() override;
+
 	UFUNCTION(exec)
 	void DumpStaticProcessorExecutesGroupTreeByPhaseID(int PhaseID);
 
@@ -27,6 +49,154 @@ public:
 	UFUNCTION(exec)
 	void DumpRuntimeProcessorDependencyByPhaseID(int PhaseID);
 
+	/** Dumps the dependencies of every phase into one document, the solved phases are written concurrently. */
+	UFUNCTION(exec)
+	void DumpAllPhasesProcessorDependency(bool bRuntime = false);
+
+	/** Records processor wall times of the given phase over FrameCount frames and dumps them merged into the dependency graph. */
+	UFUNCTION(exec)
+	void CaptureProcessorTimingByPhaseID(int PhaseID, int FrameCount = 60);
+
+	/**
+	 * Records processor tasks, command flushes and phase boundaries of all phases and writes a Chrome trace-event json
+	 * for Perfetto or chrome://tracing. FrameCount 0 traces until StopProcessorTrace.
+	 */
+	UFUNCTION(exec)
+	void StartProcessorTrace(int FrameCount = 10);
+
+	UFUNCTION(exec)
+	void StopProcessorTrace();
+
+	/**
+	 * Toggles the on screen phase and processor stats: per-phase and command flush times, and the TopCount most
+	 * expensive processors with the entities they match. Costs nothing while hidden.
+	 */
+	UFUNCTION(exec)
+	void ToggleMassStats(int TopCount = 10);
+
+	/**
+	 * Records the deferred commands every processor issues, the cost of every phase's flush and the archetype moves it
+	 * causes over FrameCount frames. Looking up the targeted entities' archetypes around each flush costs extra frame time.
+	 */
+	UFUNCTION(exec)
+	void CaptureDeferredCommands(int FrameCount = 30);
+
+	/**
+	 * Samples entities per LOD, ticked and skipped variable tick entities per LOD aware processor and the estimated
+	 * processor time the variable tick rate saves, once per frame over FrameCount frames.
+	 */
+	UFUNCTION(exec)
+	void CaptureLODEffectiveness(int FrameCount = 300);
+
+	/**
+	 * Records per signal name and frame how often it was raised, how many entities it woke and how many wait in
+	 * delayed signals, along with the time of the signal processors, over FrameCount frames.
+	 */
+	UFUNCTION(exec)
+	void CaptureSignals(int FrameCount = 300);
+
+	/**
+	 * Keeps the last frames of phase, processor and archetype telemetry in a SizeMB ring file under
+	 * Saved/MassTelemetry until StopTelemetryRing. Query it with the MassTelemetryQuery commandlet.
+	 */
+	UFUNCTION(exec)
+	void StartTelemetryRing(int SizeMB = 256);
+
+	UFUNCTION(exec)
+	void StopTelemetryRing();
+
+	/**
+	 * Reports the longest dependency chain, level widths and speedup limits up to WorkerCount workers. Costs come from
+	 * CostFile (relative to ProjectSavedDir) if given, otherwise from the last timing capture of the phase, otherwise
+	 * every processor is assumed to cost the same.
+	 */
+	UFUNCTION(exec)
+	void AnalyzeCriticalPathByPhaseID(int PhaseID, int WorkerCount = 0, const FString& CostFile = TEXT(""));
+
+	/**
+	 * Predicts the phase wall time on 1..MaxCores cores and writes a per-lane timeline of the MaxCores run. Costs are
+	 * resolved like in AnalyzeCriticalPathByPhaseID.
+	 */
+	UFUNCTION(exec)
+	void SimulateScheduleByPhaseID(int PhaseID, int MaxCores = 0, const FString& CostFile = TEXT(""));
+
+	/**
+	 * Writes the phase graph with a layered layout (X/Y per node, read by ProcessorDependencyDraw.py) and as Graphviz
+	 * DOT, render the latter with "dot -Tsvg".
+	 */
+	UFUNCTION(exec)
+	void DumpProcessorGraphLayoutByPhaseID(int PhaseID, bool bRuntime = false);
+
+	/**
+	 * Ranks the ExecuteBefore/ExecuteAfter constraints that order processors without any resource conflict by the
+	 * phase time relaxing them would save, and lists explicit constraints already implied by other edges. Costs are
+	 * resolved like in AnalyzeCriticalPathByPhaseID.
+	 */
+	UFUNCTION(exec)
+	void AnalyzeProcessorConstraintsByPhaseID(int PhaseID, int CoreCount = 0, const FString& CostFile = TEXT(""));
+
+	/**
+	 * Ranks the game thread bound processors of every phase by the simulated phase time moving them to a worker
+	 * would save, with their solved order position, the processors waiting on them and the worker time they leave
+	 * idle. Costs come from CostFile if given, otherwise from the timing captures of all phases.
+	 */
+	UFUNCTION(exec)
+	void AuditGameThreadAffinity(int CoreCount = 0, bool bRuntime = false, const FString& CostFile = TEXT(""));
+
+	/**
+	 * Writes entity count, chunk fill, per-fragment bytes, shared fragment cardinality and wasted chunk bytes of every
+	 * archetype of the world's entity manager.
+	 */
+	UFUNCTION(exec)
+	void DumpArchetypeMemory();
+
 private:
-	void DoPrint(int PhaseID, FString& ToSaveFileName, EPrintMode PrintMode);
+	void DoPrint(int PhaseID, const FString& ToSaveFileName, const FMassPhaseDumpOptions& Options);
+
+	/** Processors the live phase runs that don't come from the phase config. */
+	void GatherDynamicProcessors(class UMassSimulationSubsystem& MassSimulationSubsystem, const EMassProcessingPhase Phase, const FMassProcessingPhaseConfig& PhaseConfig
+		, TArray<UMassProcessor*>& OutDynamicProcessors) const;
+
+	/** Saves Bytes to ProjectSavedDir/ToSaveFileName on the thread pool. */
+	void SaveDumpAsync(TArray<uint8>&& Bytes, const FString& ToSaveFileName);
+
+	/** Resolves the costs the analysis commands should use for the given phase. */
+	void GetPhaseCostTable(int PhaseID, const FString& CostFile, FMassProcessorCostTable& OutCostTable) const;
+
+	/**
+	 * Warns with Consequence when the given phase, or every phase for INDEX_NONE, runs without
+	 * UMassProfiledCompositeProcessor and so reports nothing to FMassProcessorProfiler. Returns whether it warned.
+	 */
+	bool WarnIfNoProfiledPhase(const TCHAR* Consequence, const int PhaseID = INDEX_NONE) const;
+
+	/** Stops the capture in ActiveCapture, starts NewCapture in its place and routes its completion to OnCompleted. */
+	template<typename TCapture>
+	void StartCapture(TSharedPtr<TCapture>& ActiveCapture, const TSharedRef<TCapture>& NewCapture, void (UMassDumpCheatManager::*OnCompleted)(TCapture&));
+
+	/** Saves what Capture writes to ToSaveFileName and lets go of it if it's still in ActiveCapture. */
+	template<typename TCapture>
+	void SaveCapture(TSharedPtr<TCapture>& ActiveCapture, TCapture& Capture, const FString& ToSaveFileName);
+
+	void OnTimingCaptureCompleted(FMassProcessorTimingCapture& Capture);
+	void OnTraceCaptureCompleted(FMassProcessorTraceCapture& Capture);
+	void OnCommandCaptureCompleted(FMassCommandProfileCapture& Capture);
+	void OnLODCaptureCompleted(FMassLODTickCapture& Capture);
+	void OnSignalCaptureCompleted(FMassSignalCapture& Capture);
+
+	TSharedPtr<FMassProcessorTimingCapture> ActiveTimingCapture;
+
+	TSharedPtr<FMassProcessorTraceCapture> ActiveTraceCapture;
+
+	TSharedPtr<FMassProcessorLiveStats> LiveStats;
+
+	TSharedPtr<FMassCommandProfileCapture> ActiveCommandCapture;
+
+	TSharedPtr<FMassLODTickCapture> ActiveLODCapture;
+
+	TSharedPtr<FMassSignalCapture> ActiveSignalCapture;
+
+	TSharedPtr<FMassTelemetryRingWriter> TelemetryRing;
+
+	/** Costs measured by the last timing capture of each phase. */
+	TMap<int32, FMassProcessorCostTable> CapturedCostTables;
 };
@@ -4,6 +4,7 @@
 
 #include "Modules/ModuleInterface.h"
 #include "Modules/ModuleManager.h"
+#include "Engine/World.h"
 
 /** Implements the HairStrands module  */
 class FMassHelper : public IModuleInterface
@@ -14,4 +15,13 @@ public:
 
 	virtual void StartupModule() override;
 	virtual void ShutdownModule() override;
+
+private:
+	void OnPreWorldInitialization(UWorld* World, const UWorld::InitializationValues IVS);
+	void OnPostWorldInitialization(UWorld* World, const UWorld::InitializationValues IVS);
+
+	FDelegateHandle PreWorldInitializationHandle;
+	FDelegateHandle PostWorldInitializationHandle;
+	/** Phases whose PhaseGroupClass is swapped for UMassProfiledCompositeProcessor during the current world initialization. */
+	TArray<int32> SwappedPhases;
 };
@@ -0,0 +1,37 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassHelper/Public/Processor/MassProcessorDependencyPrinter.h"
+
+/**
+ * Prints every processing phase into a single document. Processors are instantiated once on the game thread, one
+ * instance per class no matter how many phases list it. The phases are solved one after another on the game thread,
+ * then written concurrently on the task graph.
+ * A CrossPhase section lists, per processor class, every phase it is configured or registered in.
+ */
+struct MASSHELPER_API FMassAllPhasesDependencyPrinter
+{
+	FMassAllPhasesDependencyPrinter(UObject& InProcessorOuter, TConstArrayView<FMassProcessingPhaseConfig> InPhasesConfig);
+
+	/** Has to be called on the game thread. */
+	void Print(EPrintMode PrintMode, FArchive& OutputArchive);
+
+	bool bIsGameRuntime = false;
+	/** Live entity manager for runtime solves, null for static ones. */
+	TSharedPtr<FMassEntityManager> EntityManager;
+	/** Dynamic processors of all phases, each phase picks the ones whose processing phase matches. */
+	TArray<UMassProcessor*> DynamicProcessors;
+
+	const FMassPrintAnnotations* Annotations = nullptr;
+	const FMassProcessorCostTable* CostTable = nullptr;
+	int32 WorkerCount = 0;
+
+private:
+	void InstantiateProcessors(TArray<TArray<UMassProcessor*>>& OutPhaseInstances);
+	void WriteCrossPhase(FMassDependencyJsonWriter& Writer, const TArray<TArray<UMassProcessor*>>& PhaseInstances) const;
+
+	UObject& ProcessorOuter;
+	TConstArrayView<FMassProcessingPhaseConfig> PhasesConfig;
+};
@@ -0,0 +1,53 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Minimal streaming UTF-8 json writer used by the dependency printer. Values are written straight to the archive,
+ * nothing is kept around except the interned FName table: every name is converted and escaped once, no matter how
+ * many dependency lists it shows up in.
+ */
+class MASSHELPER_API FMassDependencyJsonWriter
+{
+public:
+	explicit FMassDependencyJsonWriter(FArchive& InArchive);
+
+	void BeginObject();
+	void EndObject();
+	void BeginArray();
+	void EndArray();
+
+	void WriteKey(FStringView Key);
+	void WriteString(FStringView Value);
+	void WriteName(const FName Name);
+	void WriteNumber(const double Value);
+	void WriteBool(const bool bValue);
+	void WriteNull();
+
+	void WriteStringField(FStringView Key, FStringView Value) { WriteKey(Key); WriteString(Value); }
+	void WriteNameField(FStringView Key, const FName Name) { WriteKey(Key); WriteName(Name); }
+	void WriteNumberField(FStringView Key, const double Value) { WriteKey(Key); WriteNumber(Value); }
+	void WriteBoolField(FStringView Key, const bool bValue) { WriteKey(Key); WriteBool(bValue); }
+
+	/** Writes an already serialized UTF-8 json value, e.g. a document produced by another writer. */
+	void WriteRawValue(TConstArrayView<uint8> Utf8Json);
+
+	int32 GetInternedNameCount() const { return NameTable.Num(); }
+
+private:
+	void BeginValue();
+	void WriteRaw(const ANSICHAR* Data, const int32 Length);
+	void WriteRaw(const ANSICHAR* Literal) { WriteRaw(Literal, FCStringAnsi::Strlen(Literal)); }
+	static void AppendEscaped(FStringView Value, TArray<ANSICHAR>& OutUtf8);
+
+	FArchive& Archive;
+	/** One entry per open object/array, true until the first value was written into it. */
+	TArray<bool, TInlineAllocator<16>> ScopeIsEmpty;
+	bool bAfterKey = false;
+
+	/** Interned names, already quoted, escaped and UTF-8 encoded. */
+	TMap<FName, TArray<ANSICHAR>> NameTable;
+	TArray<ANSICHAR> Scratch;
+};
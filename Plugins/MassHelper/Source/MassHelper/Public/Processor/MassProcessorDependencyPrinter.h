@@ -4,13 +4,52 @@
 #include "MassEntity/Public/MassProcessingPhaseManager.h"
 #include "MassEntity/Public/MassProcessorDependencySolver.h"
 
-#include "Json/Public/Dom/JsonObject.h"
-#include "Json/Public/Serialization/JsonSerializer.h"
+#include "MassHelper/Public/Processor/MassDependencyJsonWriter.h"
+
+struct FMassProcessorCostTable;
 
 enum EPrintMode
 {
 	ExecutesGroupTree,
 	CompletelyDependency,
+	/** CompletelyDependency plus longest chain, level widths and speedup limits, see FMassCriticalPathAnalysis. */
+	CriticalPathAnalysis,
+	/** CompletelyDependency plus predicted phase wall time on 1..WorkerCount cores, see FMassProcessorScheduleSimulation. */
+	ScheduleSimulation,
+	/** CompletelyDependency plus a layered layout with X/Y per node, see FMassProcessorGraphLayout. */
+	LayeredLayout,
+	/** Graphviz DOT instead of json, groups become clusters. */
+	GraphvizDot,
+	/** CompletelyDependency plus ranked relaxable and redundant ordering constraints, see FMassProcessorConstraintAnalysis. */
+	ConstraintAnalysis,
+	/** CompletelyDependency plus the ranked game thread bound processors and what they cost the phase, see FMassGameThreadAudit. */
+	GameThreadAudit,
+};
+
+/**
+ * Extra data streamed into the printed JSON, e.g. captured timings. Node writers run inside every printed node object
+ * and add fields for the node name they're given, root writers add fields to the document object.
+ */
+struct MASSHELPER_API FMassPrintAnnotations
+{
+	using FNodeWriter = TFunction<void(FMassDependencyJsonWriter& Writer, const FName NodeName)>;
+	using FRootWriter = TFunction<void(FMassDependencyJsonWriter& Writer)>;
+
+	/** Base annotations are written ahead of these ones and have to outlive them. */
+	explicit FMassPrintAnnotations(const FMassPrintAnnotations* InBase = nullptr)
+		: Base(InBase)
+	{
+	}
+
+	void AddNodeWriter(FNodeWriter&& Writer) { NodeWriters.Add(MoveTemp(Writer)); }
+	void AddRootWriter(FRootWriter&& Writer) { RootWriters.Add(MoveTemp(Writer)); }
+
+	void WriteNodeFields(FMassDependencyJsonWriter& Writer, const FName NodeName) const;
+	void WriteRootFields(FMassDependencyJsonWriter& Writer) const;
+
+	const FMassPrintAnnotations* Base = nullptr;
+	TArray<FNodeWriter> NodeWriters;
+	TArray<FRootWriter> RootWriters;
 };
 
 struct MASSHELPER_API FMassPhaseProcessorDependencyPrinter : public FMassPhaseProcessorConfigurationHelper
@@ -25,15 +64,43 @@ public:
 
 	}
 
-	void Print(EPrintMode PrintMode, FString& OutputString, TArrayView<UMassProcessor*> DynamicProcessors, const TSharedPtr<FMassEntityManager>& EntityManager,
+	/** Solves and writes the phase, streaming the UTF-8 json document straight into OutputArchive. */
+	void Print(EPrintMode PrintMode, FArchive& OutputArchive, TArrayView<UMassProcessor*> DynamicProcessors, const TSharedPtr<FMassEntityManager>& EntityManager,
 		FMassProcessorDependencySolver::FResult* OutOptionalResult);
 
-protected:
-	virtual void PrintExecutesGroupTree(FString& OutputString, TArrayView<UMassProcessor*> DynamicProcessors, const TSharedPtr<FMassEntityManager>& EntityManager,
+	void Print(EPrintMode PrintMode, FString& OutputString, TArrayView<UMassProcessor*> DynamicProcessors, const TSharedPtr<FMassEntityManager>& EntityManager,
 		FMassProcessorDependencySolver::FResult* OutOptionalResult);
 
-	virtual void PrintCompletelyDependency(FString& OutputString, TArrayView<UMassProcessor*> DynamicProcessors, const TSharedPtr<FMassEntityManager>& EntityManager,
+	/**
+	 * Solves the phase the way PrintMode needs it. Processors get instantiated unless ProcessorInstances is set and
+	 * their queries cache archetypes, so this belongs on the game thread.
+	 */
+	void Solve(EPrintMode PrintMode, struct FMassSolvedProcessorPhase& OutSolved, TArrayView<UMassProcessor*> DynamicProcessors, const TSharedPtr<FMassEntityManager>& EntityManager,
 		FMassProcessorDependencySolver::FResult* OutOptionalResult);
+
+	/** Writes a solved phase. Only reads the solve result, processors and entity manager, so phases can be written concurrently. */
+	virtual void Write(EPrintMode PrintMode, struct FMassSolvedProcessorPhase& Solved, FArchive& OutputArchive) const;
+
+	/** Optional data merged into the printed nodes and document root. */
+	const FMassPrintAnnotations* Annotations = nullptr;
+
+	/** Processor costs used by the analysis modes. Every processor costs FMassProcessorCostTable::DefaultCostMs if not set. */
+	const FMassProcessorCostTable* CostTable = nullptr;
+
+	/** Max worker count the analysis modes report for. 0 means the task graph's worker count plus the game thread. */
+	int32 WorkerCount = 0;
+
+	/** Already instantiated phase processors, used instead of instantiating PhaseConfig.ProcessorCDOs. */
+	TConstArrayView<UMassProcessor*> ProcessorInstances;
+
+protected:
+	void CreateTmpPipeline(FMassRuntimePipeline& OutPipeline, TArrayView<UMassProcessor*> DynamicProcessors);
+	void ResolveDependencies(struct FMassProcessorDependencySolverPrinterImpl& Solver, FMassRuntimePipeline& TmpPipeline, TArray<FMassProcessorOrderInfo>& OutSortedProcessors,
+		const TSharedPtr<FMassEntityManager>& EntityManager, FMassProcessorDependencySolver::FResult* OutOptionalResult);
+	int32 GetEffectiveWorkerCount() const;
+	/** Annotations plus the per-processor workload when solved against a live EntityManager. */
+	const FMassPrintAnnotations* GetPrintAnnotations(const struct FMassProcessorDependencySolverPrinterImpl& Solver, const TSharedPtr<FMassEntityManager>& EntityManager,
+		FMassPrintAnnotations& OutStorage) const;
 };
 
 struct MASSHELPER_API FMassProcessorDependencySolverPrinterImpl : public FMassProcessorDependencySolver
@@ -47,91 +114,108 @@ public:
 
 	void ResolveExecutesGroupTree(TSharedPtr<FMassEntityManager> EntityManager, FMassProcessorDependencySolver::FResult* InOutOptionalResult);
 
-	void PrintExecutesGroupTree(FString& OutputString);
-	void PrintCompletelyDependency(FString& OutputString);
+	void PrintExecutesGroupTree(FArchive& OutputArchive, const FMassPrintAnnotations* Annotations = nullptr);
+	/** SortedProcessors, if given, adds the solved execution order edges and a DependencyReasons list to every node. */
+	void PrintCompletelyDependency(FArchive& OutputArchive, const FMassPrintAnnotations* Annotations = nullptr, TConstArrayView<FMassProcessorOrderInfo> SortedProcessors = {});
+	void PrintCriticalPathAnalysis(FArchive& OutputArchive, TConstArrayView<FMassProcessorOrderInfo> SortedProcessors, const FMassProcessorCostTable& CostTable,
+		const int32 WorkerCount, const FMassPrintAnnotations* Annotations = nullptr);
+	void PrintScheduleSimulation(FArchive& OutputArchive, TConstArrayView<FMassProcessorOrderInfo> SortedProcessors, const FMassProcessorCostTable& CostTable,
+		const int32 MaxCoreCount, const FMassPrintAnnotations* Annotations = nullptr);
+
+	void PrintLayeredLayout(FArchive& OutputArchive, TConstArrayView<FMassProcessorOrderInfo> SortedProcessors, const FMassPrintAnnotations* Annotations = nullptr);
+	void PrintGraphvizDot(FArchive& OutputArchive, TConstArrayView<FMassProcessorOrderInfo> SortedProcessors);
+	void PrintConstraintAnalysis(FArchive& OutputArchive, TConstArrayView<FMassProcessorOrderInfo> SortedProcessors, const FMassProcessorCostTable& CostTable,
+		const int32 CoreCount, const FMassPrintAnnotations* Annotations = nullptr);
+	void PrintGameThreadAudit(FArchive& OutputArchive, TConstArrayView<FMassProcessorOrderInfo> SortedProcessors, const FMassProcessorCostTable& CostTable,
+		const int32 CoreCount, const FMassPrintAnnotations* Annotations = nullptr);
+
+	/**
+	 * Adds a "Workload" field with the matched archetypes, chunks and entities of every processor. Needs a solve with an
+	 * EntityManager. The counts are taken right away, the writers only hold on to them.
+	 */
+	void AddWorkloadAnnotations(FMassPrintAnnotations& InOutAnnotations) const;
+
+	/** Heap memory held by the solver and group tree nodes, including their name maps. */
+	SIZE_T GetAllocatedSize() const;
 
     template <typename T>
-	void PrintCommon(FString Mode, TArray<T>& Nodes, FString& OutString)
+	void PrintCommon(FString Mode, TArray<T>& Nodes, FArchive& OutArchive, const FMassPrintAnnotations* Annotations = nullptr)
 	{
-        using UE::MassHelper::Private::NameViewToString;
-
-        TSharedPtr<FJsonObject> RootJson = MakeShareable(new FJsonObject);
-        TArray<TSharedPtr<FJsonValue>> NodesArray;
+        FMassDependencyJsonWriter Writer(OutArchive);
+        Writer.BeginObject();
+        Writer.WriteStringField(TEXT("PrintMode"), Mode);
 
+        Writer.WriteKey(TEXT("Nodes"));
+        Writer.BeginArray();
         for (int i = 0; i < Nodes.Num(); ++i)
         {
             T& Node = Nodes[i];
 
-            FString NodeName = Node.Name.ToString();
-            // Create a JSON object for this node
-            TSharedPtr<FJsonObject> NodeJson = MakeShareable(new FJsonObject);
-            // Add node name
-            NodeJson->SetStringField(TEXT("NodeName"), NodeName);
-            NodeJson->SetStringField(TEXT("Color"), Node.IsGroup() ? ("blue") : ("red"));
+            Writer.BeginObject();
+            Writer.WriteNameField(TEXT("NodeName"), Node.Name);
+            Writer.WriteStringField(TEXT("Color"), Node.IsGroup() ? TEXT("blue") : TEXT("red"));
 
             /*------------------------------------------------------------------------------------------------*/
 
-            TArray<FName> OriginalDependencies;
-            for (int ParentIndex = 0; ParentIndex < Node.OriginalDependencies.Num(); ++ParentIndex)
+            Writer.WriteKey(TEXT("OriginalDependencies"));
+            Writer.BeginArray();
+            for (const int32 ParentIndex : Node.OriginalDependencies)
             {
-                auto& ParentNode = Nodes[Node.OriginalDependencies[ParentIndex]];
-                OriginalDependencies.Add(ParentNode.Name);
+                Writer.WriteName(Nodes[ParentIndex].Name);
             }
-            TArray<TSharedPtr<FJsonValue>> OriginalDependenciesJsonArray;
-            for (const FName& ParentNode : OriginalDependencies)
-            {
-                OriginalDependenciesJsonArray.Add(MakeShareable(new FJsonValueString(ParentNode.ToString())));
-            }
-            NodeJson->SetArrayField(TEXT("OriginalDependencies"), OriginalDependenciesJsonArray);
+            Writer.EndArray();
 
-            TArray<FName> SubNodeIndices;
-            for (int SubNodeIndex = 0; SubNodeIndex < Node.SubNodeIndices.Num(); ++SubNodeIndex)
+            Writer.WriteKey(TEXT("SubNodeIndices"));
+            Writer.BeginArray();
+            for (const int32 SubNodeIndex : Node.SubNodeIndices)
             {
-                auto& SubNode = Nodes[Node.SubNodeIndices[SubNodeIndex]];
-                SubNodeIndices.Add(SubNode.Name);
+                Writer.WriteName(Nodes[SubNodeIndex].Name);
             }
-            TArray<TSharedPtr<FJsonValue>> SubNodeIndicesJsonArray;
-            for (const FName& SubNode : SubNodeIndices)
-            {
-                SubNodeIndicesJsonArray.Add(MakeShareable(new FJsonValueString(SubNode.ToString())));
-            }
-            NodeJson->SetArrayField(TEXT("SubNodeIndices"), SubNodeIndicesJsonArray);
+            Writer.EndArray();
 
             /*------------------------------------------------------------------------------------------------*/
 
-            TArray<FName>& ExecuteBeforeNodes = Node.ExecuteBefore;
-            // Convert ExecuteBeforeNodes and ExecuteAfterNodes to JSON arrays
-            TArray<TSharedPtr<FJsonValue>> ExecuteBeforeJsonArray;
-            for (const FName& BeforeNode : ExecuteBeforeNodes)
+            Writer.WriteKey(TEXT("ExecuteBeforeNodes"));
+            Writer.BeginArray();
+            for (const FName& BeforeNode : Node.ExecuteBefore)
             {
-                ExecuteBeforeJsonArray.Add(MakeShareable(new FJsonValueString(BeforeNode.ToString())));
+                Writer.WriteName(BeforeNode);
             }
-            NodeJson->SetArrayField(TEXT("ExecuteBeforeNodes"), ExecuteBeforeJsonArray);
-
+            Writer.EndArray();
 
-            TArray<FName>& ExecuteAfterNodes = Node.ExecuteAfter;
-            TArray<TSharedPtr<FJsonValue>> ExecuteAfterJsonArray;
-            for (const FName& AfterNode : ExecuteAfterNodes)
+            Writer.WriteKey(TEXT("ExecuteAfterNodes"));
+            Writer.BeginArray();
+            for (const FName& AfterNode : Node.ExecuteAfter)
             {
-                ExecuteAfterJsonArray.Add(MakeShareable(new FJsonValueString(AfterNode.ToString())));
+                Writer.WriteName(AfterNode);
             }
-            NodeJson->SetArrayField(TEXT("ExecuteAfterNodes"), ExecuteAfterJsonArray);
+            Writer.EndArray();
 
             /*------------------------------------------------------------------------------------------------*/
 
-            // Add this node's JSON object to the array of nodes
-            NodesArray.Add(MakeShareable(new FJsonValueObject(NodeJson)));
-        }
+            if (Annotations)
+            {
+                Annotations->WriteNodeFields(Writer, Node.Name);
+            }
 
-        // Add the array of nodes to the root JSON object
-        RootJson->SetStringField(TEXT("PrintMode"), *Mode);
-        RootJson->SetArrayField(TEXT("Nodes"), NodesArray);
+            Writer.EndObject();
+        }
+        Writer.EndArray();
 
-        // Convert the root JSON object to a string
-        TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&OutString);
-        FJsonSerializer::Serialize(RootJson.ToSharedRef(), Writer);
+        if (Annotations)
+        {
+            Annotations->WriteRootFields(Writer);
+        }
+        Writer.EndObject();
 	}
 
+protected:
+	void BuildProcessorGraph(struct FMassProcessorGraph& OutGraph, TConstArrayView<FMassProcessorOrderInfo> SortedProcessors) const;
+	/** The writers reference Graph and this solver. */
+	void AddDependencyReasonAnnotations(const struct FMassProcessorGraph& Graph, FMassPrintAnnotations& InOutAnnotations) const;
+	/** Per graph node, the index of the group node containing it, INDEX_NONE at the top level. */
+	void GetParentGroups(const struct FMassProcessorGraph& Graph, TArray<int32>& OutParentGroups) const;
+
 #pragma region PrintExecutesGroupTree
 protected:
 	struct FForPrintExecutesGroupTreeNode
@@ -160,3 +244,13 @@ protected:
 #pragma endregion
 
 };
+
+/** What FMassPhaseProcessorDependencyPrinter::Solve hands to Write. Holds pointers into itself, keep it in place once solved. */
+struct FMassSolvedProcessorPhase
+{
+	FMassRuntimePipeline Pipeline;
+	TOptional<FMassProcessorDependencySolverPrinterImpl> Solver;
+	TArray<FMassProcessorOrderInfo> SortedProcessors;
+	FMassPrintAnnotations RuntimeAnnotations;
+	const FMassPrintAnnotations* PrintAnnotations = nullptr;
+};
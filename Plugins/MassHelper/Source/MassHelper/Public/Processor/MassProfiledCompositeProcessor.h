@@ -0,0 +1,65 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassEntity/Public/MassEntityTypes.h"
+#include "MassEntity/Public/MassProcessor.h"
+#include "MassProfiledCompositeProcessor.generated.h"
+
+struct FMassArchetypeData;
+
+/**
+ * Phase-level composite processor that reports every child processor execution to FMassProcessorProfiler. With
+ * mass.helper.ProfiledPhases set, the MassHelper module installs it as the PhaseGroupClass of every phase still using
+ * the default UMassCompositeProcessor in the worlds initialized afterwards. Leaf processors run in tasks equivalent to
+ * FMassProcessorTask, nested composites through their own DispatchProcessorTasks and aren't reported as a whole. While
+ * no profiler listener is registered it behaves exactly like its parent.
+ */
+UCLASS()
+class MASSHELPER_API UMassProfiledCompositeProcessor : public UMassCompositeProcessor
+{
+	GENERATED_BODY()
+
+public:
+	virtual FGraphEventRef DispatchProcessorTasks(const TSharedPtr<FMassEntityManager>& EntityManager, FMassExecutionContext& ExecutionContext, const FGraphEventArray& Prerequisites = FGraphEventArray()) override;
+
+	/** Finds the composite processor the phase manager created for the given phase, if any. */
+	static UMassCompositeProcessor* FindPhaseProcessor(UObject& PhaseOwner, const EMassProcessingPhase Phase);
+
+	/**
+	 * Warns with Consequence when the given phase, or every phase for INDEX_NONE, runs without a profiled composite
+	 * processor and so reports nothing to FMassProcessorProfiler. Returns whether it warned.
+	 */
+	static bool WarnIfNoProfiledPhase(UObject& PhaseOwner, const TCHAR* Consequence, const int32 PhaseID = INDEX_NONE);
+
+protected:
+	virtual void Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) override;
+
+	void RefreshProfilerNodeNames();
+
+	/** Runs a leaf processor the way FMassProcessorTask does, timed right around its execution. */
+	void ExecuteProcessorTask(UMassProcessor& Processor, const TSharedPtr<FMassEntityManager>& EntityManager, FMassExecutionContext& ExecutionContext
+		, const bool bAttributeCommands, const bool bCountEntities);
+	/** Remembers the entities a processor's commands target until the phase's flush, called from the processor tasks. */
+	void AddPendingTargetEntities(const FName NodeName, TConstArrayView<FMassEntityHandle> Entities);
+
+	/** Measures the phase's own command flush by the simulation subsystem's phase finished event, which follows it. */
+	void BindPhaseFinished();
+	/** Called once this processor's work is done, the phase flushes its deferred commands next. */
+	void BeginPhaseFlush(FMassEntityManager& EntityManager);
+	void OnProcessingPhaseFinished(const float DeltaSeconds);
+
+	/** Maps child processors to the node names the dependency printer uses, so captured data can be merged into the dumps. */
+	TMap<const UMassProcessor*, FName> ProfilerNodeNames;
+
+	FDelegateHandle PhaseFinishedHandle;
+	/** Non zero from BeginPhaseFlush to the phase finishing. Both run in sequence on the phase's completion path. */
+	uint64 FlushBeginCycles = 0;
+	/** Per processor, the entities its commands targeted since the phase's last flush. Only while command attribution is requested. */
+	FCriticalSection TargetEntitiesCS;
+	TMap<FName, TArray<FMassEntityHandle>> PendingTargetEntities;
+	/** Archetype of every pending target entity before the phase's flush. */
+	TWeakPtr<FMassEntityManager> FlushEntityManager;
+	TMap<FMassEntityHandle, const FMassArchetypeData*> ArchetypesBeforeFlush;
+};
@@ -0,0 +1,87 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassHelper/Public/Profiling/MassProcessorProfiler.h"
+
+/**
+ * Attributes deferred commands to the processors issuing them over a number of frames: the commands each processor
+ * pushes, the cost of every phase's flush and the entities it moves between archetypes. Moves are found entity by
+ * entity, comparing the archetype of every entity a processor's commands targeted before and after the flush, and
+ * credited to the processors that targeted the entity. Entities only touched by lambda commands aren't seen, and an
+ * entity ending up where it started within one flush didn't move.
+ */
+class MASSHELPER_API FMassCommandProfileCapture : public IMassProcessorProfilerListener, public TSharedFromThis<FMassCommandProfileCapture>
+{
+public:
+	explicit FMassCommandProfileCapture(const int32 InFrameCount);
+
+	void Start();
+	void Stop();
+
+	bool IsCompleted() const { return bCompleted; }
+
+	/** Writes the per-processor, per-phase and per-transition report, PrintMode "CommandProfile". */
+	void Write(FArchive& OutArchive) const;
+
+	/** Called on the game thread once FrameCount frames have been recorded. */
+	TFunction<void(FMassCommandProfileCapture&)> OnCompleted;
+
+	//~ IMassProcessorProfilerListener interface
+	virtual void OnPhaseBegin(const EMassProcessingPhase Phase, const uint64 Cycles) override;
+	virtual void OnCommandsFlushed(const EMassProcessingPhase Phase, const uint32 ThreadId, const uint64 BeginCycles, const uint64 EndCycles) override;
+	virtual void OnProcessorCommandsIssued(const FMassProcessorCommandsRecord& Record) override;
+	virtual void OnPhaseTransitions(const FMassPhaseTransitionsRecord& Record) override;
+
+protected:
+	using FTransitionKey = TPair<const FMassArchetypeData*, const FMassArchetypeData*>;
+
+	struct FCommandStats
+	{
+		EMassCommandOperationType OperationType = EMassCommandOperationType::None;
+		int32 BatchCount = 0;
+		int64 OperationCount = 0;
+	};
+
+	struct FProcessorStats
+	{
+		FName NodeName;
+		EMassProcessingPhase Phase = EMassProcessingPhase::MAX;
+		/** Executions that issued any command. */
+		int32 IssueCount = 0;
+		/** Keyed by command name, or by operation type in builds without Mass debug names. */
+		TMap<FName, FCommandStats> Commands;
+	};
+
+	struct FTransitionStats
+	{
+		int64 Count = 0;
+		/** Processors whose commands targeted the moved entities, with how many of them. An entity several processors targeted counts for each. */
+		TMap<FName, int64> Issuers;
+	};
+
+	struct FPhaseStats
+	{
+		int32 FlushCount = 0;
+		double FlushMs = 0.;
+		double MaxFlushMs = 0.;
+		/** Of the entities attributed commands targeted, counted once per flush however many processors targeted them. */
+		int64 MovedEntities = 0;
+		int64 CreatedEntities = 0;
+		int64 DestroyedEntities = 0;
+		TMap<FTransitionKey, FTransitionStats> Transitions;
+	};
+
+	const int32 FrameCount;
+	uint64 StartFrame = 0;
+	int32 CapturedFrames = 0;
+
+	mutable FCriticalSection StatsCS;
+	TMap<TPair<FName, EMassProcessingPhase>, FProcessorStats> Processors;
+	TMap<EMassProcessingPhase, FPhaseStats> Phases;
+	/** Keeps the archetypes seen in transitions alive until the report is written. */
+	TMap<const FMassArchetypeData*, TSharedPtr<FMassArchetypeData>> Archetypes;
+	bool bStarted = false;
+	bool bCompleted = false;
+};
@@ -0,0 +1,111 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassHelper/Public/Profiling/MassProcessorProfiler.h"
+#include "MassEntity/Public/MassEntityQuery.h"
+#include "MassLOD/Public/MassLODTypes.h"
+
+class UWorld;
+
+/**
+ * Samples MassLOD state at the end of every frame: entities per LOD tag, and entities in variable tick chunks that
+ * ticked or were skipped this frame, per simulation LOD. For every processor reading the variable tick chunk fragment
+ * that ran in the frame, it also counts the entities ticked and skipped in the archetypes that execution matched.
+ * The time saved is estimated from each processor's measured cost per ticked entity, assuming processor cost grows
+ * linearly with the entities it ticks.
+ */
+class MASSHELPER_API FMassLODTickCapture : public IMassProcessorProfilerListener, public TSharedFromThis<FMassLODTickCapture>
+{
+public:
+	FMassLODTickCapture(UWorld& InWorld, const int32 InFrameCount);
+	virtual ~FMassLODTickCapture();
+
+	void Start();
+	void Stop();
+
+	bool IsCompleted() const { return bCompleted; }
+
+	/** Writes the per-frame time series and per-processor totals, PrintMode "LODTick". */
+	void Write(FArchive& OutArchive) const;
+
+	/** Called on the game thread once FrameCount frames have been sampled. */
+	TFunction<void(FMassLODTickCapture&)> OnCompleted;
+
+	//~ IMassProcessorProfilerListener interface
+	virtual void OnProcessorExecuted(const FMassProcessorExecutionRecord& Record) override;
+
+protected:
+	/** Last slot counts entities without LOD tag, or chunks without a valid LOD. */
+	static constexpr int32 LODBucketCount = int32(EMassLOD::Max) + 1;
+
+	struct FTickCounts
+	{
+		int64 Ticked = 0;
+		int64 Skipped = 0;
+	};
+
+	struct FProcessorSample
+	{
+		int32 ProcessorIndex = INDEX_NONE;
+		FTickCounts Entities;
+		double Ms = 0.;
+		double SavedMs = 0.;
+	};
+
+	struct FFrameSample
+	{
+		uint64 Frame = 0;
+		double FrameMs = 0.;
+		double ProcessorMs = 0.;
+		double LODAwareProcessorMs = 0.;
+		double SavedMs = 0.;
+		int32 TaggedEntities[LODBucketCount] = {};
+		FTickCounts VariableTickEntities[LODBucketCount];
+		TArray<FProcessorSample> Processors;
+	};
+
+	struct FProcessorInfo
+	{
+		TWeakObjectPtr<UMassProcessor> Processor;
+		FName NodeName;
+		EMassProcessingPhase Phase = EMassProcessingPhase::MAX;
+		/** Totals over the capture, the cost per ticked entity estimates the skipped work. */
+		FTickCounts Entities;
+		double Ms = 0.;
+		double SavedMs = 0.;
+		int32 ExecutedFrames = 0;
+		/** Archetypes and entity counts matched by the last execution. Pointers are only compared, never dereferenced. */
+		TArray<TPair<const FMassArchetypeData*, int32>> MatchedArchetypes;
+
+		double GetMsPerEntity() const { return Entities.Ticked > 0 ? Ms / Entities.Ticked : 0.; }
+	};
+
+	void OnEndFrame();
+	void SampleFrame();
+	void RefreshLODAwareProcessors();
+
+	TWeakObjectPtr<UWorld> World;
+	const int32 FrameCount;
+	FDelegateHandle EndFrameHandle;
+	FMassEntityQuery VariableTickQuery;
+
+	/** LOD aware processors of all phases, FProcessorSample::ProcessorIndex points in here. */
+	TArray<FProcessorInfo> ProcessorInfos;
+	/** Every phase child seen so far, INDEX_NONE for the ones that aren't LOD aware. Only compared, never dereferenced. */
+	TMap<const UMassProcessor*, int32> ProcessorIndices;
+	TArray<FFrameSample> Frames;
+
+	struct FPendingTiming
+	{
+		FName NodeName;
+		double Ms = 0.;
+		TArray<TPair<const FMassArchetypeData*, int32>> MatchedArchetypes;
+	};
+
+	/** Wall time and latest matches per processor since the last sample, filled from whichever thread ran the processor. */
+	FCriticalSection PendingCS;
+	TMap<const UMassProcessor*, FPendingTiming> PendingTimings;
+	bool bCompleted = false;
+};
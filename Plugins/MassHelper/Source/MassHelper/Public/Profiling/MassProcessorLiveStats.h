@@ -0,0 +1,117 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassHelper/Public/Profiling/MassProcessorProfiler.h"
+#include "MassHelper/Public/Profiling/MassSpscRingBuffer.h"
+
+class UCanvas;
+class APlayerController;
+
+/**
+ * On screen stats of the running phases: per-phase time, command flush time and the most expensive processors with
+ * the entities their queries matched as they ran, averaged over half a second. Every thread reporting events gets its own
+ * lock-free ring which the game thread drains when drawing, so executing processors never wait on the overlay.
+ */
+class MASSHELPER_API FMassProcessorLiveStats : public IMassProcessorProfilerListener, public TSharedFromThis<FMassProcessorLiveStats>
+{
+public:
+	FMassProcessorLiveStats(UWorld& InWorld, const int32 InTopCount);
+	virtual ~FMassProcessorLiveStats();
+
+	void Start();
+	void Stop();
+
+	bool IsRunning() const { return DrawHandle.IsValid(); }
+
+	//~ IMassProcessorProfilerListener interface
+	virtual void OnPhaseBegin(const EMassProcessingPhase Phase, const uint64 Cycles) override;
+	virtual void OnPhaseEnd(const EMassProcessingPhase Phase, const uint64 Cycles) override;
+	virtual void OnProcessorExecuted(const FMassProcessorExecutionRecord& Record) override;
+	virtual void OnCommandsFlushed(const EMassProcessingPhase Phase, const uint32 ThreadId, const uint64 BeginCycles, const uint64 EndCycles) override;
+
+protected:
+	enum class EEventKind : uint8
+	{
+		Phase,
+		Processor,
+		CommandFlush,
+	};
+
+	struct FEvent
+	{
+		FName NodeName;
+		uint64 BeginCycles = 0;
+		uint64 EndCycles = 0;
+		int32 EntityCount = 0;
+		EMassProcessingPhase Phase = EMassProcessingPhase::MAX;
+		EEventKind Kind = EEventKind::Processor;
+	};
+
+	struct FThreadRing
+	{
+		explicit FThreadRing(const uint32 InThreadId) : ThreadId(InThreadId), Events(RingCapacity) {}
+
+		const uint32 ThreadId;
+		TMassSpscRingBuffer<FEvent> Events;
+	};
+
+	struct FProcessorStats
+	{
+		FName NodeName;
+		EMassProcessingPhase Phase = EMassProcessingPhase::MAX;
+		double TotalMs = 0.;
+		int32 ExecutionCount = 0;
+		/** Summed over the window's executions, then averaged per execution when it closes. */
+		int64 EntityCount = 0;
+	};
+
+	struct FPhaseStats
+	{
+		double TotalMs = 0.;
+		double MaxMs = 0.;
+		double FlushMs = 0.;
+	};
+
+	/** What gets drawn, per frame averages of the last completed window. */
+	struct FDisplay
+	{
+		FPhaseStats Phases[int(EMassProcessingPhase::MAX)];
+		TArray<FProcessorStats> TopProcessors;
+		int32 ActiveProcessorCount = 0;
+		int32 FrameCount = 0;
+		double MeasuredSeconds = 0.;
+	};
+
+	/** Returns the calling thread's ring, registering one on first use. Null once MaxThreadRings is used up. */
+	FThreadRing* GetThreadRing();
+	void PushEvent(const FEvent& Event);
+
+	void DrainEvents();
+	void CloseWindow(const int32 FrameCount);
+	void Draw(UCanvas* Canvas, APlayerController* PlayerController);
+
+	static constexpr int32 MaxThreadRings = 128;
+	static constexpr uint32 RingCapacity = 2048;
+	static constexpr double WindowSeconds = 0.5;
+
+	TWeakObjectPtr<UWorld> World;
+	const int32 TopCount;
+	FDelegateHandle DrawHandle;
+
+	// written by the reporting threads
+	const uint32 InstanceId;
+	std::atomic<FThreadRing*> ThreadRings[MaxThreadRings] = {};
+	std::atomic<int32> ThreadRingCount = 0;
+	std::atomic<uint64> PhaseBeginCycles[int(EMassProcessingPhase::MAX)] = {};
+	std::atomic<uint32> DroppedEventCount = 0;
+
+	// game thread only
+	FPhaseStats WindowPhases[int(EMassProcessingPhase::MAX)];
+	TMap<TPair<FName, EMassProcessingPhase>, FProcessorStats> WindowProcessors;
+	uint64 WindowStartFrame = 0;
+	double WindowStartSeconds = 0.;
+	uint64 LastDrainFrame = 0;
+	FDisplay Display;
+};
@@ -0,0 +1,155 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassEntity/Public/MassProcessingTypes.h"
+#include "MassEntity/Public/MassCommands.h"
+#include "MassEntity/Public/MassEntityTypes.h"
+
+class UMassProcessor;
+struct FMassArchetypeData;
+
+/**
+ * A single processor execution observed by UMassProfiledCompositeProcessor. The cycles are taken right around the
+ * processor's Execute, on the thread that ran it.
+ */
+struct FMassProcessorExecutionRecord
+{
+	/** Same name the dependency solver uses for the processor's node (class name, or instance name for extra instances). */
+	FName NodeName;
+	const UMassProcessor* Processor = nullptr;
+	EMassProcessingPhase Phase = EMassProcessingPhase::MAX;
+	/** Thread the processor ran on. */
+	uint32 ThreadId = 0;
+	uint64 BeginCycles = 0;
+	uint64 EndCycles = 0;
+	/**
+	 * Archetypes the processor's queries matched as it started, with their entity counts at that point. Only filled
+	 * while entity counting is requested, see FMassProcessorProfiler::AddEntityCounting. Chunk filters the processor
+	 * applies while iterating, e.g. variable tick rates, aren't reflected.
+	 */
+	TArray<TPair<const FMassArchetypeData*, int32>> MatchedArchetypes;
+
+	double GetDurationMs() const { return FPlatformTime::ToMilliseconds64(EndCycles - BeginCycles); }
+	int32 GetMatchedEntityCount() const;
+};
+
+/**
+ * Deferred commands one processor issued during a single execution. Only reported while command attribution is
+ * requested, see FMassProcessorProfiler::AddCommandAttribution.
+ */
+struct FMassProcessorCommandsRecord
+{
+	struct FCommandBatch
+	{
+		/** Command type name, NAME_None in builds without Mass debug names. */
+		FName Name;
+		EMassCommandOperationType OperationType = EMassCommandOperationType::None;
+		/** Entities or operations the batch covers, 0 in builds without Mass debug names. */
+		int32 OperationCount = 0;
+	};
+
+	FName NodeName;
+	const UMassProcessor* Processor = nullptr;
+	EMassProcessingPhase Phase = EMassProcessingPhase::MAX;
+	uint32 ThreadId = 0;
+	TArray<FCommandBatch> Commands;
+	/**
+	 * Entities the issued commands target, as far as the commands batch entity handles. Creation commands and the
+	 * ones wrapping a lambda don't expose theirs.
+	 */
+	TArray<FMassEntityHandle> TargetEntities;
+};
+
+/**
+ * Archetype moves a phase's flush made with the entities its processors' commands targeted, compared entity by entity
+ * before and after the flush. Only reported while command attribution is requested.
+ */
+struct FMassPhaseTransitionsRecord
+{
+	struct FTransition
+	{
+		/** Archetype before and after the flush, null where the entity didn't exist yet or anymore. */
+		TSharedPtr<FMassArchetypeData> From;
+		TSharedPtr<FMassArchetypeData> To;
+		/** Distinct entities that made the move. */
+		int32 EntityCount = 0;
+		/** Node names of the processors whose commands targeted those entities, with how many of them each targeted. */
+		TMap<FName, int32> Issuers;
+	};
+
+	EMassProcessingPhase Phase = EMassProcessingPhase::MAX;
+	TArray<FTransition> Transitions;
+};
+
+/**
+ * Receives execution events from the profiled phase processors. Processor events arrive on whichever thread
+ * executed the processor, so implementations need to be thread safe.
+ */
+class IMassProcessorProfilerListener
+{
+public:
+	virtual ~IMassProcessorProfilerListener() = default;
+
+	virtual void OnPhaseBegin(const EMassProcessingPhase Phase, const uint64 Cycles) {}
+	virtual void OnPhaseEnd(const EMassProcessingPhase Phase, const uint64 Cycles) {}
+	virtual void OnProcessorExecuted(const FMassProcessorExecutionRecord& Record) {}
+	/** The phase's own flush of its deferred commands, measured from its processors completing to the phase finishing. */
+	virtual void OnCommandsFlushed(const EMassProcessingPhase Phase, const uint32 ThreadId, const uint64 BeginCycles, const uint64 EndCycles) {}
+	/** A processor issued deferred commands, only while command attribution is requested. */
+	virtual void OnProcessorCommandsIssued(const FMassProcessorCommandsRecord& Record) {}
+	/** Where the phase's flush moved the entities its processors' commands targeted, only while command attribution is requested. */
+	virtual void OnPhaseTransitions(const FMassPhaseTransitionsRecord& Record) {}
+};
+
+/**
+ * Central hub the profiled phase processors report to. As long as no listener is registered IsActive() returns
+ * false and the phase processors take the regular, uninstrumented execution path.
+ */
+class MASSHELPER_API FMassProcessorProfiler
+{
+public:
+	static FMassProcessorProfiler& Get();
+
+	bool IsActive() const { return bActive.load(std::memory_order_relaxed); }
+
+	void AddListener(const TSharedRef<IMassProcessorProfilerListener>& Listener);
+	void RemoveListener(const TSharedRef<IMassProcessorProfilerListener>& Listener);
+
+	/**
+	 * While requested, the profiled phases report the deferred commands every processor issues and where each phase
+	 * flush moved the entities those commands targeted. The flush itself is left to the phase, but looking up every
+	 * targeted entity's archetype around it costs extra frame time, only meant for short captures.
+	 */
+	void AddCommandAttribution() { CommandAttributionCount.fetch_add(1, std::memory_order_relaxed); }
+	void RemoveCommandAttribution() { CommandAttributionCount.fetch_sub(1, std::memory_order_relaxed); }
+	bool IsAttributingCommands() const { return IsActive() && CommandAttributionCount.load(std::memory_order_relaxed) > 0; }
+
+	/**
+	 * While requested, the profiled phases fill FMassProcessorExecutionRecord::MatchedArchetypes. The matching runs
+	 * on each processor's own execution path, right before it, so listeners never touch the processors' queries.
+	 */
+	void AddEntityCounting() { EntityCountingCount.fetch_add(1, std::memory_order_relaxed); }
+	void RemoveEntityCounting() { EntityCountingCount.fetch_sub(1, std::memory_order_relaxed); }
+	bool IsCountingEntities() const { return IsActive() && EntityCountingCount.load(std::memory_order_relaxed) > 0; }
+
+	void BroadcastPhaseBegin(const EMassProcessingPhase Phase);
+	void BroadcastPhaseEnd(const EMassProcessingPhase Phase);
+	void BroadcastProcessorExecuted(const FMassProcessorExecutionRecord& Record);
+	void BroadcastCommandsFlushed(const EMassProcessingPhase Phase, const uint64 BeginCycles, const uint64 EndCycles);
+	void BroadcastProcessorCommandsIssued(const FMassProcessorCommandsRecord& Record);
+	void BroadcastPhaseTransitions(const FMassPhaseTransitionsRecord& Record);
+
+private:
+	/** Broadcasts happen per processor execution, the snapshot of the usual one or two listeners stays off the heap. */
+	using FListenerArray = TArray<TSharedRef<IMassProcessorProfilerListener>, TInlineAllocator<4>>;
+
+	void GetListenersSnapshot(FListenerArray& OutListeners) const;
+
+	mutable FRWLock ListenersLock;
+	FListenerArray Listeners;
+	std::atomic<bool> bActive = false;
+	std::atomic<int32> CommandAttributionCount = 0;
+	std::atomic<int32> EntityCountingCount = 0;
+};
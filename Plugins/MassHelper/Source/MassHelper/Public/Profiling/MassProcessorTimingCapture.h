@@ -0,0 +1,74 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassHelper/Public/Profiling/MassProcessorProfiler.h"
+
+struct FMassPrintAnnotations;
+
+/**
+ * Records wall time of every processor of a single phase over a fixed number of frames. Registers itself with
+ * FMassProcessorProfiler on Start() and unregisters once the requested amount of frames has been captured, at which
+ * point OnCompleted is called on the game thread.
+ */
+class MASSHELPER_API FMassProcessorTimingCapture : public IMassProcessorProfilerListener, public TSharedFromThis<FMassProcessorTimingCapture>
+{
+public:
+	struct FProcessorStats
+	{
+		int32 SampleCount = 0;
+		double MinMs = 0.;
+		double AvgMs = 0.;
+		double P95Ms = 0.;
+		double MaxMs = 0.;
+		/** Thread name -> number of executions observed on that thread. */
+		TMap<FString, int32> Threads;
+	};
+
+	FMassProcessorTimingCapture(const EMassProcessingPhase InPhase, const int32 InFrameCount);
+
+	void Start();
+	void Stop();
+
+	bool IsCompleted() const { return bCompleted; }
+	EMassProcessingPhase GetPhase() const { return Phase; }
+	int32 GetCapturedFrameCount() const { return CapturedFrames; }
+
+	/** Aggregated per-processor statistics, keyed by dependency node name. Call once the capture has completed. */
+	void ComputeStats(TMap<FName, FProcessorStats>& OutStats) const;
+
+	/** Average wall time per frame of the whole phase. */
+	double GetAveragePhaseMs() const;
+
+	/** Wall time of the whole phase, one sample per captured frame. */
+	void GetPhaseSamples(TArray<double>& OutSamplesMs) const;
+
+	/** Adds a "Timing" object to every captured node and a "PhaseTiming" object to the document root. The stats are computed right away. */
+	void ExportAnnotations(FMassPrintAnnotations& OutAnnotations) const;
+
+	TFunction<void(FMassProcessorTimingCapture&)> OnCompleted;
+
+	//~ IMassProcessorProfilerListener interface
+	virtual void OnPhaseBegin(const EMassProcessingPhase InPhase, const uint64 Cycles) override;
+	virtual void OnPhaseEnd(const EMassProcessingPhase InPhase, const uint64 Cycles) override;
+	virtual void OnProcessorExecuted(const FMassProcessorExecutionRecord& Record) override;
+
+protected:
+	struct FSample
+	{
+		double DurationMs = 0.;
+		uint32 ThreadId = 0;
+	};
+
+	const EMassProcessingPhase Phase;
+	const int32 FrameCount;
+
+	mutable FCriticalSection SamplesCS;
+	TMap<FName, TArray<FSample>> Samples;
+	TArray<double> PhaseSamplesMs;
+	uint64 PhaseBeginCycles = 0;
+	int32 CapturedFrames = 0;
+	bool bInPhase = false;
+	bool bCompleted = false;
+};
@@ -0,0 +1,66 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassHelper/Public/Profiling/MassProcessorProfiler.h"
+
+/**
+ * Records every phase boundary, processor execution and command flush of all phases over a number of frames and
+ * writes them as Chrome trace-event json, which opens in Perfetto (ui.perfetto.dev) or chrome://tracing. Processor
+ * events carry the dependency dump node names, one track per thread; phases get a track of their own.
+ */
+class MASSHELPER_API FMassProcessorTraceCapture : public IMassProcessorProfilerListener, public TSharedFromThis<FMassProcessorTraceCapture>
+{
+public:
+	/** FrameCount 0 records until Stop() is called. */
+	explicit FMassProcessorTraceCapture(const int32 InFrameCount);
+
+	void Start();
+	void Stop();
+
+	bool IsCompleted() const { return bCompleted; }
+	int32 GetEventCount() const;
+
+	/** Writes the recorded events as a Chrome trace-event json document. */
+	void Write(FArchive& OutArchive) const;
+
+	/** Called on the game thread once FrameCount frames have been recorded. */
+	TFunction<void(FMassProcessorTraceCapture&)> OnCompleted;
+
+	//~ IMassProcessorProfilerListener interface
+	virtual void OnPhaseBegin(const EMassProcessingPhase Phase, const uint64 Cycles) override;
+	virtual void OnPhaseEnd(const EMassProcessingPhase Phase, const uint64 Cycles) override;
+	virtual void OnProcessorExecuted(const FMassProcessorExecutionRecord& Record) override;
+	virtual void OnCommandsFlushed(const EMassProcessingPhase Phase, const uint32 ThreadId, const uint64 BeginCycles, const uint64 EndCycles) override;
+
+protected:
+	enum class EEventKind : uint8
+	{
+		Phase,
+		Processor,
+		CommandFlush,
+	};
+
+	struct FTraceEvent
+	{
+		FName Name;
+		EEventKind Kind = EEventKind::Processor;
+		EMassProcessingPhase Phase = EMassProcessingPhase::MAX;
+		uint32 ThreadId = 0;
+		uint64 BeginCycles = 0;
+		uint64 EndCycles = 0;
+		uint64 Frame = 0;
+	};
+
+	void AddEvent(FTraceEvent&& Event);
+
+	const int32 FrameCount;
+	uint64 StartFrame = 0;
+	uint64 StartCycles = 0;
+
+	mutable FCriticalSection EventsCS;
+	TArray<FTraceEvent> Events;
+	uint64 PhaseBeginCycles[int(EMassProcessingPhase::MAX)] = {};
+	bool bCompleted = false;
+};
@@ -0,0 +1,85 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassHelper/Public/Profiling/MassProcessorProfiler.h"
+#include "MassEntity/Public/MassEntityTypes.h"
+#include <atomic>
+
+class UWorld;
+class UMassSignalSubsystem;
+
+/**
+ * Records MassSignals traffic per frame: for every signal name how often it was raised, how many entities it woke and
+ * how many entities wait in delayed signals, next to the wall time of the signal processors subscribed to it.
+ * Signals are observed through the subsystem's per-name delegates, names registered later get picked up every frame.
+ */
+class MASSHELPER_API FMassSignalCapture : public IMassProcessorProfilerListener, public TSharedFromThis<FMassSignalCapture>
+{
+public:
+	FMassSignalCapture(UWorld& InWorld, const int32 InFrameCount);
+	virtual ~FMassSignalCapture();
+
+	void Start();
+	void Stop();
+
+	bool IsCompleted() const { return bCompleted; }
+
+	/** Writes per-signal and per-processor totals and the per-frame time series, PrintMode "Signals". */
+	void Write(FArchive& OutArchive) const;
+
+	/** Called on the game thread once FrameCount frames have been recorded. */
+	TFunction<void(FMassSignalCapture&)> OnCompleted;
+
+	//~ IMassProcessorProfilerListener interface
+	virtual void OnProcessorExecuted(const FMassProcessorExecutionRecord& Record) override;
+
+protected:
+	struct FSignalSample
+	{
+		int32 RaisedCount = 0;
+		int32 EntityCount = 0;
+		/** Entities waiting in delayed signals at the end of the frame. */
+		int32 DelayedEntityCount = 0;
+		/** Wall time of the signal processors subscribed to the signal, processors subscribed to several count for each. */
+		double ProcessorMs = 0.;
+	};
+
+	struct FFrameSample
+	{
+		uint64 Frame = 0;
+		double FrameMs = 0.;
+		double SignalProcessorMs = 0.;
+		TMap<FName, FSignalSample> Signals;
+		TMap<FName, double> SignalProcessorsMs;
+	};
+
+	/** Counted by whichever thread raises the signal, command flushes can run off the game thread. */
+	struct FPendingSignal
+	{
+		std::atomic<int32> RaisedCount = 0;
+		std::atomic<int32> EntityCount = 0;
+	};
+
+	void OnSignal(FName SignalName, TConstArrayView<FMassEntityHandle> Entities, FPendingSignal* Pending);
+	void OnEndFrame();
+	void SubscribeToNewSignals(UMassSignalSubsystem& SignalSubsystem);
+	void UnsubscribeAll();
+
+	TWeakObjectPtr<UWorld> World;
+	TWeakObjectPtr<UMassSignalSubsystem> SignalSubsystemWeak;
+	const int32 FrameCount;
+	FDelegateHandle EndFrameHandle;
+	TMap<FName, FDelegateHandle> SignalHandles;
+	/** Allocated once per subscribed signal, the delegates point at them. */
+	TMap<FName, TUniquePtr<FPendingSignal>> PendingSignals;
+	TArray<FFrameSample> Frames;
+
+	/** Processors run anywhere. */
+	FCriticalSection PendingCS;
+	TMap<FName, double> PendingSignalProcessorsMs;
+	/** The signals every signal processor seen so far is subscribed to. */
+	TMap<FName, TArray<FName>> ProcessorSignals;
+	bool bCompleted = false;
+};
@@ -0,0 +1,64 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+
+/**
+ * Fixed capacity single producer, single consumer ring. Neither side ever blocks: Push drops the item when the ring
+ * is full and Drain only hands out what the producer had published when it started.
+ */
+template<typename T>
+class TMassSpscRingBuffer
+{
+public:
+	/** Capacity gets rounded up to a power of two. */
+	explicit TMassSpscRingBuffer(const uint32 InCapacity)
+		: Capacity(FMath::RoundUpToPowerOfTwo(FMath::Max(InCapacity, 2u)))
+		, Mask(Capacity - 1)
+	{
+		Items.SetNum(Capacity);
+	}
+
+	TMassSpscRingBuffer(const TMassSpscRingBuffer&) = delete;
+	TMassSpscRingBuffer& operator=(const TMassSpscRingBuffer&) = delete;
+
+	/** Producer side. Returns false if the ring is full, the item is dropped then. */
+	bool Push(const T& Item)
+	{
+		const uint32 Head = HeadIndex.load(std::memory_order_relaxed);
+		if (Head - TailIndex.load(std::memory_order_acquire) >= Capacity)
+		{
+			return false;
+		}
+		Items[Head & Mask] = Item;
+		HeadIndex.store(Head + 1, std::memory_order_release);
+		return true;
+	}
+
+	/** Consumer side. Calls Func for every published item in push order, returns the number of items drained. */
+	template<typename FuncType>
+	uint32 Drain(FuncType&& Func)
+	{
+		const uint32 Tail = TailIndex.load(std::memory_order_relaxed);
+		const uint32 Head = HeadIndex.load(std::memory_order_acquire);
+		for (uint32 Index = Tail; Index != Head; ++Index)
+		{
+			Func(Items[Index & Mask]);
+		}
+		TailIndex.store(Head, std::memory_order_release);
+		return Head - Tail;
+	}
+
+	uint32 GetCapacity() const { return Capacity; }
+
+private:
+	const uint32 Capacity;
+	const uint32 Mask;
+	TArray<T> Items;
+
+	// each index is only written by one side, keep them on separate cache lines
+	alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<uint32> HeadIndex = 0;
+	alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<uint32> TailIndex = 0;
+};
@@ -0,0 +1,129 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassHelper/Public/Profiling/MassProcessorProfiler.h"
+
+class IFileHandle;
+class UWorld;
+
+/**
+ * One frame of Mass telemetry as stored in a ring file slot. Processor and archetype names are ids into the file's
+ * name table. When a frame does not fit its slot the cheapest processors and smallest archetypes are left out.
+ */
+struct MASSHELPER_API FMassTelemetryFrame
+{
+	struct FPhase
+	{
+		uint8 Phase = 0;
+		float Ms = 0.f;
+		float FlushMs = 0.f;
+		uint16 FlushCount = 0;
+	};
+
+	struct FProcessor
+	{
+		uint32 NameId = 0;
+		uint8 Phase = 0;
+		float Ms = 0.f;
+	};
+
+	struct FArchetype
+	{
+		uint32 NameId = 0;
+		int32 EntityCount = 0;
+	};
+
+	uint64 Sequence = 0;
+	uint64 EngineFrame = 0;
+	double TimeSeconds = 0.;
+	float FrameMs = 0.f;
+	int32 EntityCount = 0;
+	bool bTruncated = false;
+	TArray<FPhase> Phases;
+	TArray<FProcessor> Processors;
+	TArray<FArchetype> Archetypes;
+
+	void Serialize(FArchive& Ar);
+};
+
+/**
+ * Writes a FMassTelemetryFrame per frame into a fixed size ring file, overwriting the oldest frames once full:
+ *
+ *   [header][name table][slot 0]...[slot N-1]
+ *
+ * Every slot carries its sequence number and a CRC, so a reader can order the frames and drop a slot torn by a crash.
+ * Slots are written in place through a file handle at the end of every frame and flushed every FlushIntervalFrames
+ * frames and on Stop. Memory mapped writing is not part of the platform file layer, and the OS cache makes the write
+ * a copy anyway.
+ */
+class MASSHELPER_API FMassTelemetryRingWriter : public IMassProcessorProfilerListener, public TSharedFromThis<FMassTelemetryRingWriter>
+{
+public:
+	static constexpr uint32 Magic = 0x4D54524E; // 'MTRN'
+	static constexpr uint32 SlotMagic = 0x4D54534C; // 'MTSL'
+	static constexpr uint32 Version = 1;
+	static constexpr int32 HeaderSize = 256;
+	static constexpr int32 SlotHeaderSize = 24;
+	static constexpr uint64 FlushIntervalFrames = 60;
+	/** Names that no longer fit the name table. */
+	static constexpr uint32 InvalidNameId = MAX_uint32;
+
+	FMassTelemetryRingWriter(UWorld& InWorld, const FString& InFilePath, const int64 InFileSizeBytes, const int32 InSlotSizeBytes = 16 * 1024
+		, const int32 InNameTableSizeBytes = 1024 * 1024);
+	virtual ~FMassTelemetryRingWriter();
+
+	bool Start();
+	void Stop();
+
+	bool IsRunning() const { return FileHandle.IsValid(); }
+	const FString& GetFilePath() const { return FilePath; }
+	int32 GetSlotCount() const { return SlotCount; }
+
+	static FString GetDefaultFilePath();
+
+	//~ IMassProcessorProfilerListener interface
+	virtual void OnPhaseBegin(const EMassProcessingPhase Phase, const uint64 Cycles) override;
+	virtual void OnPhaseEnd(const EMassProcessingPhase Phase, const uint64 Cycles) override;
+	virtual void OnProcessorExecuted(const FMassProcessorExecutionRecord& Record) override;
+	virtual void OnCommandsFlushed(const EMassProcessingPhase Phase, const uint32 ThreadId, const uint64 BeginCycles, const uint64 EndCycles) override;
+
+protected:
+	void OnEndFrame();
+	uint32 GetNameId(const FString& Name);
+	void WriteHeader();
+
+	TWeakObjectPtr<UWorld> World;
+	const FString FilePath;
+	const int32 SlotSize;
+	const int32 NameTableSize;
+	int32 SlotCount = 0;
+	TUniquePtr<IFileHandle> FileHandle;
+	FDelegateHandle EndFrameHandle;
+	uint64 NextSequence = 1;
+
+	TMap<FString, uint32> NameIds;
+	int32 NameTableUsed = 0;
+	/** Archetype names by archetype, building them means exporting the whole composition. */
+	TMap<const void*, uint32> ArchetypeNameIds;
+
+	/** Filled by the profiled phases from any thread, taken at the end of the frame. */
+	FCriticalSection PendingCS;
+	FMassTelemetryFrame::FPhase PendingPhases[int(EMassProcessingPhase::MAX)];
+	uint64 PhaseBeginCycles[int(EMassProcessingPhase::MAX)] = {};
+	TMap<TPair<FName, EMassProcessingPhase>, float> PendingProcessorsMs;
+	TArray<uint8> SlotBytes;
+};
+
+/** Loads a ring file written by FMassTelemetryRingWriter, frames ordered oldest first. */
+struct MASSHELPER_API FMassTelemetryRingReader
+{
+	TArray<FString> Names;
+	TArray<FMassTelemetryFrame> Frames;
+	int32 TornSlotCount = 0;
+
+	bool Load(const FString& FilePath);
+
+	const FString& GetName(const uint32 NameId) const;
+};
@@ -96,6 +96,20 @@ def DrawG(json_file):
     with open(json_file, 'r') as file:
         data = json.load(file)
 
+    file_name_no_extension = os.path.splitext(os.path.basename(json_file))[0]
+    if data['PrintMode'] == 'AllPhases':
+        # 每个阶段单独绘制
+        for phase in data['Phases']:
+            # 没有处理器的阶段没有可绘制的内容
+            if not phase['Dependency']:
+                continue
+            DrawData(phase['Dependency'], "{0}_{1}".format(file_name_no_extension, phase['Phase']))
+    elif 'Nodes' in data:
+        DrawData(data, file_name_no_extension)
+
+
+def DrawData(data, file_name_no_extension):
+
     # 修改排序函数，现在它考虑了颜色、层级和字典序
     # def node_sort_key(item):
     #     node, color = item
@@ -126,6 +140,11 @@ def DrawG(json_file):
     elif data['PrintMode'] == 'CompletelyDependency':
         BuildProcessorCompleteDependenciesDig(G, actual_edge_colors, data, node_in_degree_map, node_name_map)
 
+    # C++ 已经计算好分层布局时直接使用, 不再运行 spring_layout
+    if 'Layout' in data:
+        DrawLayered(G, data, node_name_map, actual_edge_colors, file_name_no_extension)
+        return
+
     # 设置图形大小
     plt.figure(figsize=(350, 350))
 
@@ -155,8 +174,57 @@ def DrawG(json_file):
     # 显示图形
     # plt.show()
 
-    file_name_no_extension = os.path.splitext(os.path.basename(json_file))[0]
     plt.savefig("./data/{0}.jpg".format(file_name_no_extension))
+    plt.close()
+
+    if 'ScheduleSimulation' in data:
+        DrawSchedule(data['ScheduleSimulation'], file_name_no_extension)
+
+
+# 使用 C++ 分层布局的 X/Y 坐标绘制
+def DrawLayered(G, data, node_name_map, actual_edge_colors, file_name_no_extension):
+    layout = data['Layout']
+    pos = {}
+    for node_key in G.nodes():
+        if node_key in node_name_map and 'Layout' in node_name_map[node_key]:
+            node_layout = node_name_map[node_key]['Layout']
+            pos[node_key] = (node_layout['X'], -node_layout['Y'])
+        else:
+            pos[node_key] = (-1, 0)
+
+    width = max(8, layout['LayerCount'] * 3)
+    height = max(6, layout['MaxLayerWidth'] * 0.6)
+    plt.figure(figsize=(width, height))
+    node_colors = [G.nodes[node_key]['color'] for node_key in G.nodes()]
+    labels = {node_key: G.nodes[node_key]['nickname'] for node_key in G.nodes()}
+    nx.draw(G, pos, with_labels=True, labels=labels, node_color=node_colors, edge_color=actual_edge_colors, node_size=300,
+            arrows=True, arrowstyle='->', arrowsize=8, font_size=6, alpha=0.8)
+    plt.savefig("./data/{0}.jpg".format(file_name_no_extension), dpi=100, bbox_inches='tight')
+    plt.close()
+
+
+# 绘制调度模拟的甘特图
+def DrawSchedule(schedule, file_name_no_extension):
+    timeline = schedule['Timeline']
+    lanes = timeline['Lanes']
+
+    plt.figure(figsize=(40, max(4, len(lanes))))
+    ax = plt.gca()
+    for lane in lanes:
+        lane_index = lane['Lane']
+        color = 'orange' if lane['GameThread'] else 'steelblue'
+        for entry in lane['Entries']:
+            duration = entry['EndMs'] - entry['StartMs']
+            ax.broken_barh([(entry['StartMs'], duration)], (lane_index - 0.4, 0.8), facecolors=color, edgecolor='black')
+            ax.text(entry['StartMs'] + duration / 2, lane_index, GetNickName(entry['NodeName']), ha='center', va='center',
+                    fontsize=6, rotation=90)
+
+    ax.set_yticks([lane['Lane'] for lane in lanes])
+    ax.set_yticklabels(['GameThread' if lane['GameThread'] else 'Worker {0}'.format(lane['Lane']) for lane in lanes])
+    ax.set_xlabel('ms')
+    ax.set_title('{0} cores, {1:.3f} ms'.format(timeline['Cores'], timeline['WallTimeMs']))
+    plt.savefig("./data/{0}_Schedule.jpg".format(file_name_no_extension))
+    plt.close()
 
 
 def BuildExecutesGroupTreeDig(G, actual_edge_colors, data, node_in_degree_map, node_name_map):